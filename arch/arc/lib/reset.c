@@ -13,7 +13,7 @@ __weak void reset_cpu(ulong addr)
 	__builtin_arc_brk();
 }
 
-int do_reset(cmd_tbl_t *cmdtp, int flag, int argc, char *const argv[])
+int arch_do_reset(cmd_tbl_t *cmdtp, int flag, int argc, char *const argv[])
 {
 	printf("Resetting the board...\n");
 
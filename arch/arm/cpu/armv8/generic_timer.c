@@ -7,6 +7,7 @@
 #include <common.h>
 #include <command.h>
 #include <time.h>
+#include <trace.h>
 #include <asm/system.h>
 
 DECLARE_GLOBAL_DATA_PTR;
@@ -95,6 +96,28 @@ uint64_t get_ticks(void)
 	return ticks;
 }
 
+#ifdef CONFIG_TRACE_TIMESTAMP_COUNTER
+/*
+ * Timestamps for function tracing: read the virtual counter directly, since
+ * this is called on every function entry and exit and must not itself be
+ * instrumented.
+ */
+uint64_t notrace trace_get_timestamp(void)
+{
+	unsigned long cntvct;
+
+	isb();
+	asm volatile("mrs %0, cntvct_el0" : "=r" (cntvct));
+
+	return cntvct;
+}
+
+ulong notrace trace_get_timestamp_rate(void)
+{
+	return get_tbclk();
+}
+#endif
+
 unsigned long usec2ticks(unsigned long usec)
 {
 	ulong ticks;
@@ -19,7 +19,7 @@
 
 DECLARE_GLOBAL_DATA_PTR;
 
-int do_reset(cmd_tbl_t *cmdtp, int flag, int argc, char * const argv[])
+int arch_do_reset(cmd_tbl_t *cmdtp, int flag, int argc, char * const argv[])
 {
 	ccm_t *ccm = (ccm_t *) MMAP_CCM;
 
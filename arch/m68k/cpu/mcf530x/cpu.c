@@ -10,7 +10,7 @@
 #include <asm/io.h>
 
 #ifdef CONFIG_M5307
-int do_reset(cmd_tbl_t *cmdtp, int flag, int argc, char * const argv[])
+int arch_do_reset(cmd_tbl_t *cmdtp, int flag, int argc, char * const argv[])
 {
 	sim_t *sim = (sim_t *)(MMAP_SIM);
 
@@ -108,6 +108,25 @@ long sandbox_i2c_rtc_get_set_base_time(struct udevice *dev, long base_time);
 
 int sandbox_usb_keyb_add_string(struct udevice *dev, const char *str);
 
+/**
+ * sandbox_serial_set_tx_space() - Limit the output a sandbox UART takes
+ *
+ * This makes the UART report that it is busy once it has been given the
+ * given number of characters, so that buffered output can be tested.
+ *
+ * @dev:	Serial device
+ * @space:	Number of characters to take, or -1 for no limit
+ */
+void sandbox_serial_set_tx_space(struct udevice *dev, int space);
+
+/**
+ * sandbox_serial_get_tx_count() - Get the number of characters written
+ *
+ * @dev:	Serial device
+ * @return number of characters written to the UART since it was probed
+ */
+ulong sandbox_serial_get_tx_count(struct udevice *dev);
+
 /**
  * sandbox_osd_get_mem() - get the internal memory of a sandbox OSD
  *
@@ -139,6 +158,15 @@ int sandbox_pwm_get_config(struct udevice *dev, uint channel, uint *period_nsp,
  */
 void sandbox_sf_set_block_protect(struct udevice *dev, int bp_mask);
 
+/**
+ * sandbox_spinand_data() - Get the data held by the emulated SPI NAND
+ *
+ * @page: Page number
+ * @col: Column within the main area of the page
+ * @return the byte at that position
+ */
+u8 sandbox_spinand_data(uint page, uint col);
+
 /**
  * sandbox_get_codec_params() - Read back codec parameters
  *
@@ -15,6 +15,7 @@
 #include <errno.h>
 #include <fdt_support.h>
 #include <image.h>
+#include <serial.h>
 #include <u-boot/zlib.h>
 #include <asm/bootparam.h>
 #include <asm/cpu.h>
@@ -39,6 +40,7 @@ void bootm_announce_and_cleanup(void)
 #if CONFIG_IS_ENABLED(BOOTSTAGE_REPORT)
 	bootstage_report();
 #endif
+	serial_flush();
 
 	/*
 	 * Call remove function of all devices with a removal flag set.
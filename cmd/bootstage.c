@@ -4,6 +4,10 @@
  */
 
 #include <common.h>
+#include <command.h>
+#include <env.h>
+#include <mapmem.h>
+#include <linux/sizes.h>
 
 static int do_bootstage_report(cmd_tbl_t *cmdtp, int flag, int argc,
 			       char * const argv[])
@@ -57,10 +61,41 @@ static int do_bootstage_stash(cmd_tbl_t *cmdtp, int flag, int argc,
 	return 0;
 }
 
+#ifdef CONFIG_BOOTSTAGE_TRACE
+static int do_bootstage_trace(cmd_tbl_t *cmdtp, int flag, int argc,
+			      char * const argv[])
+{
+	ulong addr, size = SZ_64K;
+	char *buf;
+	int ret;
+
+	if (argc < 2)
+		return CMD_RET_USAGE;
+	addr = simple_strtoul(argv[1], NULL, 16);
+	if (argc > 2)
+		size = simple_strtoul(argv[2], NULL, 16);
+
+	buf = map_sysmem(addr, size);
+	ret = bootstage_trace_export(buf, size);
+	unmap_sysmem(buf);
+	if (ret < 0) {
+		printf("Trace does not fit in %#lx bytes\n", size);
+		return CMD_RET_FAILURE;
+	}
+	printf("Wrote %d bytes of trace to %#lx\n", ret, addr);
+	env_set_hex("filesize", ret);
+
+	return 0;
+}
+#endif
+
 static cmd_tbl_t cmd_bootstage_sub[] = {
 	U_BOOT_CMD_MKENT(report, 2, 1, do_bootstage_report, "", ""),
 	U_BOOT_CMD_MKENT(stash, 4, 0, do_bootstage_stash, "", ""),
 	U_BOOT_CMD_MKENT(unstash, 4, 0, do_bootstage_stash, "", ""),
+#ifdef CONFIG_BOOTSTAGE_TRACE
+	U_BOOT_CMD_MKENT(trace, 3, 0, do_bootstage_trace, "", ""),
+#endif
 };
 
 /*
@@ -91,4 +126,8 @@ U_BOOT_CMD(bootstage, 4, 1, do_boostage,
 	"report                      - Print a report\n"
 	"stash [<start> [<size>]]    - Stash data into memory\n"
 	"unstash [<start> [<size>]]  - Unstash data from memory"
+#ifdef CONFIG_BOOTSTAGE_TRACE
+	"\ntrace <addr> [<size>]       - Write a Chrome trace (JSON) to memory,\n"
+	"                              setting 'filesize'"
+#endif
 );
@@ -0,0 +1,57 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Show the time spent running each command
+ */
+
+#include <common.h>
+#include <command.h>
+#include <cli_hush.h>
+#include <div64.h>
+
+static int do_cmdstat(cmd_tbl_t *cmdtp, int flag, int argc,
+		      char *const argv[])
+{
+	cmd_tbl_t *start = ll_entry_start(cmd_tbl_t, cmd);
+	const int len = ll_entry_count(cmd_tbl_t, cmd);
+	const struct cmd_stats *stats;
+	int i;
+
+	if (argc > 1) {
+		if (strcmp(argv[1], "reset"))
+			return CMD_RET_USAGE;
+		cmd_reset_stats();
+		return 0;
+	}
+
+	printf("%-16s %8s %12s %10s %10s\n", "Command", "Calls", "Total us",
+	       "Avg us", "Max us");
+	for (i = 0; i < len; i++) {
+		stats = cmd_get_stats(start + i);
+		if (!stats || !stats->calls)
+			continue;
+		printf("%-16s %8lu %12llu %10llu %10lu\n", start[i].name,
+		       stats->calls, stats->total_us,
+		       lldiv(stats->total_us, stats->calls), stats->max_us);
+	}
+
+#ifdef CONFIG_HUSH_PARSE_CACHE
+	{
+		ulong hits, misses;
+		int count;
+
+		hush_cache_get_stats(&hits, &misses, &count);
+		printf("\nParsed scripts: %lu run from cache, %lu parsed, %d cached\n",
+		       hits, misses, count);
+	}
+#endif
+
+	return 0;
+}
+
+U_BOOT_CMD(cmdstat, 2, 0, do_cmdstat,
+	   "show time spent running each command",
+	   "\n"
+	   "    - show calls and time taken; times include nested commands\n"
+	   "cmdstat reset\n"
+	   "    - reset the counters"
+);
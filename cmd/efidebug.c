@@ -360,6 +360,33 @@ static int do_efi_show_handles(cmd_tbl_t *cmdtp, int flag,
 	return CMD_RET_SUCCESS;
 }
 
+/**
+ * do_efi_show_events() - show UEFI event loop statistics
+ *
+ * @cmdtp:	Command table
+ * @flag:	Command flag
+ * @argc:	Number of arguments
+ * @argv:	Argument array
+ * Return:	CMD_RET_SUCCESS on success, CMD_RET_RET_FAILURE on failure
+ *
+ * Implement efidebug "events" sub-command.
+ * Show the number of events and how often the event loop ran.
+ */
+static int do_efi_show_events(cmd_tbl_t *cmdtp, int flag,
+			      int argc, char * const argv[])
+{
+	struct efi_event_stats stats;
+
+	efi_get_event_stats(&stats);
+	printf("Event loop iterations: %llu\n", stats.loops);
+	printf("Events:                %u\n", stats.events);
+	printf("Timer events:          %u (%u armed)\n", stats.timers,
+	       stats.timers_armed);
+	printf("Queued notifications:  %u\n", stats.queued);
+
+	return CMD_RET_SUCCESS;
+}
+
 /**
  * do_efi_show_images() - show UEFI images
  *
@@ -1097,6 +1124,8 @@ static cmd_tbl_t cmd_efidebug_sub[] = {
 			 "", ""),
 	U_BOOT_CMD_MKENT(dh, CONFIG_SYS_MAXARGS, 1, do_efi_show_handles,
 			 "", ""),
+	U_BOOT_CMD_MKENT(events, CONFIG_SYS_MAXARGS, 1, do_efi_show_events,
+			 "", ""),
 	U_BOOT_CMD_MKENT(images, CONFIG_SYS_MAXARGS, 1, do_efi_show_images,
 			 "", ""),
 	U_BOOT_CMD_MKENT(memmap, CONFIG_SYS_MAXARGS, 1, do_efi_show_memmap,
@@ -1167,6 +1196,8 @@ static char efidebug_help_text[] =
 	"  - show UEFI drivers\n"
 	"efidebug dh\n"
 	"  - show UEFI handles\n"
+	"efidebug events\n"
+	"  - show UEFI event loop statistics\n"
 	"efidebug images\n"
 	"  - show loaded images\n"
 	"efidebug memmap\n"
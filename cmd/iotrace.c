@@ -5,54 +5,61 @@
 
 #include <common.h>
 #include <command.h>
+#include <console.h>
 #include <iotrace.h>
 
 static void do_print_stats(void)
 {
 	ulong start, size, needed_size, offset, count;
+	const struct iotrace_region *region;
+	uint mode = iotrace_get_mode();
+	int i, region_count;
 
 	printf("iotrace is %sabled\n", iotrace_get_enabled() ? "en" : "dis");
+	printf("Mode:   %s%s\n",
+	       mode & IOTRACE_MODE_COMPACT ? "compact" : "full",
+	       mode & IOTRACE_MODE_RING ? ", ring" : "");
 	iotrace_get_buffer(&start, &size, &needed_size, &offset, &count);
 	printf("Start:  %08lx\n", start);
 	printf("Actual Size:   %08lx\n", size);
 	printf("Needed Size:   %08lx\n", needed_size);
-	iotrace_get_region(&start, &size);
-	printf("Region: %08lx\n", start);
-	printf("Size:   %08lx\n", size);
+	region_count = iotrace_get_regions(&region);
+	for (i = 0; i < region_count; i++) {
+		printf("Region: %08lx\n", region[i].start);
+		printf("Size:   %08lx\n", region[i].size);
+	}
 	printf("Offset: %08lx\n", offset);
 	printf("Output: %08lx\n", start + offset);
 	printf("Count:  %08lx\n", count);
+	if (mode & IOTRACE_MODE_RING)
+		printf("Overwritten: %08lx\n", iotrace_get_overwritten());
 	printf("CRC32:  %08lx\n", (ulong)iotrace_get_checksum());
 }
 
+static int print_record(struct iotrace_record *rec, ulong caller, void *priv)
+{
+	printf("%08llu: 0x%08lx %s 0x%08llx", rec->timestamp, rec->value,
+	       rec->flags & IOT_WRITE ? "-->" : "<--",
+	       (unsigned long long)rec->addr);
+	if (caller)
+		printf("  %08lx", caller);
+	putc('\n');
+
+	return ctrlc() ? -EINTR : 0;
+}
+
 static void do_print_trace(void)
 {
 	ulong start, size, needed_size, offset, count;
 
-	struct iotrace_record *cur_record;
-
 	iotrace_get_buffer(&start, &size, &needed_size, &offset, &count);
 
 	if (!start || !size || !count)
 		return;
 
-	printf("Timestamp  Value          Address\n");
-
-	cur_record = (struct iotrace_record *)start;
-	for (int i = 0; i < count; i++) {
-		if (cur_record->flags & IOT_WRITE)
-			printf("%08llu: 0x%08lx --> 0x%08llx\n",
-			       cur_record->timestamp,
-					cur_record->value,
-					(unsigned long long)cur_record->addr);
-		else
-			printf("%08llu: 0x%08lx <-- 0x%08llx\n",
-			       cur_record->timestamp,
-					cur_record->value,
-					(unsigned long long)cur_record->addr);
-
-		cur_record++;
-	}
+	printf("Timestamp  Value          Address%s\n",
+	       iotrace_get_mode() & IOTRACE_MODE_COMPACT ? "     Caller" : "");
+	iotrace_walk(print_record, NULL);
 }
 
 static int do_set_buffer(int argc, char * const argv[])
@@ -73,16 +80,38 @@ static int do_set_buffer(int argc, char * const argv[])
 
 static int do_set_region(int argc, char * const argv[])
 {
-	ulong addr = 0, size = 0;
+	ulong addr, size;
 
-	if (argc == 2) {
+	if (argc & 1)
+		return CMD_RET_USAGE;
+
+	iotrace_reset_region();
+	for (; argc; argc -= 2) {
 		addr = simple_strtoul(*argv++, NULL, 16);
 		size = simple_strtoul(*argv++, NULL, 16);
-	} else if (argc != 0) {
-		return CMD_RET_USAGE;
+		if (iotrace_add_region(addr, size)) {
+			printf("Cannot add region %08lx\n", addr);
+			return CMD_RET_FAILURE;
+		}
+	}
+
+	return 0;
+}
+
+static int do_set_mode(int argc, char * const argv[])
+{
+	uint mode = 0;
+
+	for (; argc; argc--, argv++) {
+		if (!strcmp(*argv, "compact"))
+			mode |= IOTRACE_MODE_COMPACT;
+		else if (!strcmp(*argv, "ring"))
+			mode |= IOTRACE_MODE_RING;
+		else if (strcmp(*argv, "full"))
+			return CMD_RET_USAGE;
 	}
 
-	iotrace_set_region(addr, size);
+	iotrace_set_mode(mode);
 
 	return 0;
 }
@@ -98,6 +127,8 @@ int do_iotrace(cmd_tbl_t *cmdtp, int flag, int argc, char * const argv[])
 		return do_set_buffer(argc - 2, argv + 2);
 	case 'l':
 		return do_set_region(argc - 2, argv + 2);
+	case 'm':
+		return do_set_mode(argc - 2, argv + 2);
 	case 'p':
 		iotrace_set_enabled(0);
 		break;
@@ -118,11 +149,12 @@ int do_iotrace(cmd_tbl_t *cmdtp, int flag, int argc, char * const argv[])
 }
 
 U_BOOT_CMD(
-	iotrace,	4,	1,	do_iotrace,
+	iotrace, 2 + 2 * IOTRACE_MAX_REGIONS, 1, do_iotrace,
 	"iotrace utility commands",
 	"stats                        - display iotrace stats\n"
 	"iotrace buffer <address> <size>      - set iotrace buffer\n"
-	"iotrace limit <address> <size>       - set iotrace region limit\n"
+	"iotrace limit [<address> <size>...]  - set iotrace region limits\n"
+	"iotrace mode [full|compact] [ring]   - set format, reset buffer\n"
 	"iotrace pause                        - pause tracing\n"
 	"iotrace resume                       - resume tracing\n"
 	"iotrace dump                         - dump iotrace buffer"
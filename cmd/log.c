@@ -94,6 +94,16 @@ static int do_log_rec(cmd_tbl_t *cmdtp, int flag, int argc, char * const argv[])
 	return 0;
 }
 
+#if CONFIG_IS_ENABLED(LOG_BINARY)
+static int do_log_dump(cmd_tbl_t *cmdtp, int flag, int argc,
+		       char * const argv[])
+{
+	log_binary_dump();
+
+	return 0;
+}
+#endif
+
 static cmd_tbl_t log_sub[] = {
 	U_BOOT_CMD_MKENT(level, CONFIG_SYS_MAXARGS, 1, do_log_level, "", ""),
 #ifdef CONFIG_LOG_TEST
@@ -101,6 +111,9 @@ static cmd_tbl_t log_sub[] = {
 #endif
 	U_BOOT_CMD_MKENT(format, CONFIG_SYS_MAXARGS, 1, do_log_format, "", ""),
 	U_BOOT_CMD_MKENT(rec, CONFIG_SYS_MAXARGS, 1, do_log_rec, "", ""),
+#if CONFIG_IS_ENABLED(LOG_BINARY)
+	U_BOOT_CMD_MKENT(dump, 1, 1, do_log_dump, "", ""),
+#endif
 };
 
 static int do_log(cmd_tbl_t *cmdtp, int flag, int argc, char * const argv[])
@@ -133,6 +146,9 @@ static char log_help_text[] =
 	"\tor 'default', equivalent to 'fm', or 'all' for all\n"
 	"log rec <category> <level> <file> <line> <func> <message> - "
 		"output a log record"
+#if CONFIG_IS_ENABLED(LOG_BINARY)
+	"\nlog dump - show records in the binary log"
+#endif
 	;
 #endif
 
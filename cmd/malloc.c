@@ -0,0 +1,52 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Commands for inspecting the malloc() heap
+ */
+
+#include <common.h>
+#include <command.h>
+#include <malloc.h>
+
+static int do_malloc_info(cmd_tbl_t *cmdtp, int flag, int argc,
+			  char *const argv[])
+{
+	const struct malloc_class_stats *stats;
+	struct malloc_heap_info info;
+	int count, i;
+
+	malloc_get_heap_info(&info);
+	printf("heap size    %#lx\n", info.total);
+	printf("heap used    %#lx (peak %#lx)\n", info.brk, info.brk_peak);
+	printf("in use       %#lx\n", info.inuse);
+	printf("free         %#lx in %lu chunks, largest %#lx\n", info.free,
+	       info.free_chunks, info.largest_free);
+	if (info.free)
+		printf("fragmented   %lu%%\n",
+		       100 - (ulong)((u64)info.largest_free * 100 / info.free));
+	printf("cached       %#lx\n", info.cached);
+
+	count = malloc_get_class_stats(&stats);
+	if (!count)
+		return 0;
+	printf("\n%6s  %10s  %10s  %10s  %8s\n", "size", "allocs", "hits",
+	       "frees", "cached");
+	for (i = 0; i < count; i++) {
+		const struct malloc_class_stats *st = &stats[i];
+
+		if (!st->allocs && !st->frees)
+			continue;
+		printf("%6d  %10lu  %10lu  %10lu  %8lu\n", i << 3, st->allocs,
+		       st->hits, st->frees, st->cached);
+	}
+
+	return 0;
+}
+
+#ifdef CONFIG_SYS_LONGHELP
+static char malloc_help_text[] =
+	"info - show heap usage, fragmentation and size-class counters\n";
+#endif
+
+U_BOOT_CMD_WITH_SUBCMDS(malloc, "malloc() heap information",
+			malloc_help_text,
+	U_BOOT_SUBCMD_MKENT(info, 1, 1, do_malloc_info));
@@ -16,6 +16,8 @@
 #include <cli.h>
 #include <command.h>
 #include <console.h>
+#include <cpu_func.h>
+#include <div64.h>
 #include <flash.h>
 #include <hash.h>
 #include <mapmem.h>
@@ -860,6 +862,211 @@ static ulong mem_test_quick(vu_long *buf, ulong start_addr, ulong end_addr,
 	return errs;
 }
 
+#ifdef CONFIG_SYS_FAST_MEMTEST
+#define MTEST_FAST_LINE		64	/* bytes written / checked per burst */
+#define MTEST_FAST_WORDS	(MTEST_FAST_LINE / sizeof(ulong))
+#define MTEST_FAST_BLOCK	0x10000	/* bytes between ctrl-c checks */
+#define MTEST_FAST_MAX_REPORT	16	/* errors shown per iteration */
+
+enum {
+	MTEST_FAST_NONE,
+	MTEST_FAST_ZERO,
+	MTEST_FAST_ADDR,
+	MTEST_FAST_INV_ADDR,
+	MTEST_FAST_RANDOM,
+};
+
+/*
+ * Each sweep checks the pattern left by the one before and writes the next,
+ * so memory is only read and written once per pattern. Going down for the
+ * inverted pass gives the moving-inversions order.
+ */
+static const struct {
+	int check;
+	int fill;
+	bool down;
+} mtest_fast_sweeps[] = {
+	{ MTEST_FAST_ZERO,	MTEST_FAST_ADDR,	false },
+	{ MTEST_FAST_ADDR,	MTEST_FAST_INV_ADDR,	false },
+	{ MTEST_FAST_INV_ADDR,	MTEST_FAST_RANDOM,	true },
+	{ MTEST_FAST_RANDOM,	MTEST_FAST_NONE,	false },
+};
+
+/*
+ * Work out the pattern for one line. The random pattern is a hash of the
+ * seed and address rather than a running PRNG, so that it can be produced
+ * again in any order.
+ */
+static void mtest_fast_line(ulong *line, int kind, ulong addr, ulong seed)
+{
+	ulong x;
+	int i;
+
+	for (i = 0; i < MTEST_FAST_WORDS; i++, addr += sizeof(ulong)) {
+		switch (kind) {
+		case MTEST_FAST_ZERO:
+			line[i] = 0;
+			break;
+		case MTEST_FAST_ADDR:
+			line[i] = addr;
+			break;
+		case MTEST_FAST_INV_ADDR:
+			line[i] = ~addr;
+			break;
+		case MTEST_FAST_RANDOM:
+			x = (addr ^ seed) * 0x9e3779b1;
+			x ^= x >> 15;
+			x *= 0x85ebca6b;
+			x ^= x >> 13;
+			line[i] = x;
+			break;
+		}
+	}
+}
+
+/* Write a line, bypassing the cache where the CPU allows it */
+static void mtest_fast_store(ulong *dst, const ulong *src)
+{
+	int i;
+
+#if defined(CONFIG_ARM64)
+	for (i = 0; i < MTEST_FAST_WORDS; i += 2)
+		asm volatile("stnp %0, %1, [%2]" : : "r" (src[i]),
+			     "r" (src[i + 1]), "r" (dst + i) : "memory");
+#elif defined(CONFIG_X86)
+	for (i = 0; i < MTEST_FAST_WORDS; i++)
+		asm volatile("movnti %1, %0" : "=m" (dst[i]) : "r" (src[i]));
+#else
+	for (i = 0; i < MTEST_FAST_WORDS; i++)
+		dst[i] = src[i];
+#endif
+}
+
+/* Make sure that non-temporal stores are visible to the following reads */
+static void mtest_fast_fence(void)
+{
+#if defined(CONFIG_X86)
+	asm volatile("sfence" : : : "memory");
+#else
+	barrier();
+#endif
+}
+
+/* Clear the buffer, using DC ZVA to zero whole blocks where possible */
+static void mtest_fast_zero(void *buf, ulong size)
+{
+#ifdef CONFIG_ARM64
+	ulong dczid, bs, head;
+
+	/* DC ZVA faults on device memory, which is all we have uncached */
+	asm volatile("mrs %0, dczid_el0" : "=r" (dczid));
+	if (!(dczid & 0x10) && dcache_status()) {
+		bs = 4UL << (dczid & 0xf);
+		head = min(size, -(ulong)buf & (bs - 1));
+		memset(buf, '\0', head);
+		buf += head;
+		size -= head;
+		for (; size >= bs; buf += bs, size -= bs)
+			asm volatile("dc zva, %0" : : "r" (buf) : "memory");
+		asm volatile("dsb ish" : : : "memory");
+	}
+#endif
+	memset(buf, '\0', size);
+}
+
+/*
+ * Run one sweep over the buffer, checking each line against @check and then
+ * writing @fill. Returns the number of errors, or -1 if interrupted.
+ */
+static ulong mtest_fast_sweep(ulong *buf, ulong start_addr, ulong lines,
+			      int check, int fill, bool down, ulong seed,
+			      ulong *reported)
+{
+	ulong expect[MTEST_FAST_WORDS], val[MTEST_FAST_WORDS];
+	ulong errs = 0;
+	ulong i, n, addr, diff;
+	ulong *line;
+	int j;
+
+	for (i = 0; i < lines; i++) {
+		if (!(i % (MTEST_FAST_BLOCK / MTEST_FAST_LINE))) {
+			WATCHDOG_RESET();
+			if (ctrlc())
+				return -1;
+		}
+		n = down ? lines - 1 - i : i;
+		line = buf + n * MTEST_FAST_WORDS;
+		addr = start_addr + n * MTEST_FAST_LINE;
+
+		if (check != MTEST_FAST_NONE) {
+			mtest_fast_line(expect, check, addr, seed);
+			for (j = 0, diff = 0; j < MTEST_FAST_WORDS; j++) {
+				val[j] = line[j];
+				diff |= val[j] ^ expect[j];
+			}
+			for (j = 0; diff && j < MTEST_FAST_WORDS; j++) {
+				if (val[j] == expect[j])
+					continue;
+				errs++;
+				if (++*reported > MTEST_FAST_MAX_REPORT)
+					continue;
+				printf("\nMem error @ 0x%08lX: "
+				       "found %08lX, expected %08lX\n",
+				       addr + j * sizeof(ulong), val[j],
+				       expect[j]);
+			}
+		}
+		if (fill != MTEST_FAST_NONE) {
+			mtest_fast_line(expect, fill, addr, seed);
+			mtest_fast_store(line, expect);
+		}
+	}
+	mtest_fast_fence();
+
+	return errs;
+}
+
+/*
+ * Test memory a cache line at a time with the address, inverted address
+ * and random patterns, showing the rate at which memory was tested
+ */
+static ulong mem_test_fast(vu_long *vbuf, ulong start_addr, ulong end_addr,
+			   ulong seed)
+{
+	ulong *buf = (ulong *)vbuf;
+	ulong lines, size, errs = 0, reported = 0;
+	ulong start, us, ret;
+	int i;
+
+	lines = (end_addr - start_addr) / MTEST_FAST_LINE;
+	size = lines * MTEST_FAST_LINE;
+	printf("\rSeed %08lX  Testing...", seed);
+
+	start = timer_get_us();
+	mtest_fast_zero(buf, size);
+	for (i = 0; i < ARRAY_SIZE(mtest_fast_sweeps); i++) {
+		ret = mtest_fast_sweep(buf, start_addr, lines,
+				       mtest_fast_sweeps[i].check,
+				       mtest_fast_sweeps[i].fill,
+				       mtest_fast_sweeps[i].down, seed,
+				       &reported);
+		if (ret == -1UL)
+			return ret;
+		errs += ret;
+	}
+	us = max(timer_get_us() - start, 1UL);
+
+	if (reported > MTEST_FAST_MAX_REPORT)
+		printf("\n(%lu more errors not shown)\n",
+		       reported - MTEST_FAST_MAX_REPORT);
+	/* One write to clear, then three read/write and one read sweep */
+	printf("\rSeed %08lX  %llu MB/s   ", seed,
+	       lldiv((u64)size * 8, us));
+
+	return errs;
+}
+#endif /* CONFIG_SYS_FAST_MEMTEST */
+
 /*
  * Perform a memory test. A more complete alternative test can be
  * configured using CONFIG_SYS_ALT_MEMTEST. The complete test loops until
@@ -880,10 +1087,19 @@ static int do_mem_mtest(cmd_tbl_t *cmdtp, int flag, int argc,
 #else
 	const int alt_test = 0;
 #endif
+	bool fast = false;
 
 	start = CONFIG_SYS_MEMTEST_START;
 	end = CONFIG_SYS_MEMTEST_END;
 
+#ifdef CONFIG_SYS_FAST_MEMTEST
+	if (argc > 1 && !strcmp(argv[1], "-f")) {
+		fast = true;
+		argc--;
+		argv++;
+	}
+#endif
+
 	if (argc > 1)
 		if (strict_strtoul(argv[1], 16, &start) < 0)
 			return CMD_RET_USAGE;
@@ -921,7 +1137,12 @@ static int do_mem_mtest(cmd_tbl_t *cmdtp, int flag, int argc,
 
 		printf("Iteration: %6d\r", iteration + 1);
 		debug("\n");
-		if (alt_test) {
+		if (fast) {
+#ifdef CONFIG_SYS_FAST_MEMTEST
+			errs = mem_test_fast(buf, start, end,
+					     pattern + iteration);
+#endif
+		} else if (alt_test) {
 			errs = mem_test_alt(buf, start, end, dummy);
 		} else {
 			errs = mem_test_quick(buf, start, end, pattern,
@@ -958,6 +1179,230 @@ static int do_mem_mtest(cmd_tbl_t *cmdtp, int flag, int argc,
 }
 #endif	/* CONFIG_CMD_MEMTEST */
 
+#ifdef CONFIG_CMD_MEMBENCH
+#define MEMBENCH_NTIMES		10		/* runs of each STREAM kernel */
+#define MEMBENCH_CHASE_COUNT	(1 << 20)	/* loads per latency test */
+#define MEMBENCH_STRIDE		64		/* distance between loads */
+#define MEMBENCH_MIN_SET	4096		/* smallest working set */
+
+enum {
+	MEMBENCH_COPY,
+	MEMBENCH_SCALE,
+	MEMBENCH_ADD,
+	MEMBENCH_TRIAD,
+
+	MEMBENCH_COUNT,
+};
+
+static const char *const membench_name[MEMBENCH_COUNT] = {
+	"Copy", "Scale", "Add", "Triad",
+};
+
+/* Number of words read or written per element by each kernel */
+static const int membench_words[MEMBENCH_COUNT] = { 2, 2, 3, 3 };
+
+/*
+ * The STREAM kernels, using integers rather than doubles since U-Boot does
+ * not use the FPU
+ */
+static void mem_bench_kernel(int kernel, u64 *a, u64 *b, u64 *c, ulong n)
+{
+	const u64 scalar = 3;
+	ulong i;
+
+	switch (kernel) {
+	case MEMBENCH_COPY:
+		for (i = 0; i < n; i++)
+			c[i] = a[i];
+		break;
+	case MEMBENCH_SCALE:
+		for (i = 0; i < n; i++)
+			b[i] = scalar * c[i];
+		break;
+	case MEMBENCH_ADD:
+		for (i = 0; i < n; i++)
+			c[i] = a[i] + b[i];
+		break;
+	case MEMBENCH_TRIAD:
+		for (i = 0; i < n; i++)
+			a[i] = b[i] + scalar * c[i];
+		break;
+	}
+}
+
+/*
+ * Measure bandwidth with the STREAM kernels, using three arrays which fill
+ * the buffer. Each kernel is run MEMBENCH_NTIMES times and the best and
+ * average rates are shown.
+ */
+static int mem_bench_stream(void *buf, ulong size)
+{
+	ulong n = size / 3 / sizeof(u64);
+	u64 *a = buf, *b = a + n, *c = b + n;
+	ulong i, us, best, total;
+	int kernel, run;
+	u64 bytes;
+
+	if (n < MEMBENCH_MIN_SET / sizeof(u64)) {
+		printf("Buffer too small\n");
+		return -EINVAL;
+	}
+	for (i = 0; i < n; i++) {
+		a[i] = 1;
+		b[i] = 2;
+		c[i] = 0;
+	}
+
+	printf("%lu bytes per array\n", n * (ulong)sizeof(u64));
+	printf("%-8s %12s %12s\n", "Function", "Best MB/s", "Avg MB/s");
+	for (kernel = 0; kernel < MEMBENCH_COUNT; kernel++) {
+		best = ULONG_MAX;
+		total = 0;
+		for (run = 0; run < MEMBENCH_NTIMES; run++) {
+			ulong start;
+
+			if (ctrlc())
+				return -EINTR;
+			WATCHDOG_RESET();
+			start = timer_get_us();
+			mem_bench_kernel(kernel, a, b, c, n);
+			us = max(timer_get_us() - start, 1UL);
+			best = min(best, us);
+			total += us;
+		}
+		bytes = (u64)membench_words[kernel] * sizeof(u64) * n;
+		printf("%-8s %12llu %12llu\n", membench_name[kernel],
+		       lldiv(bytes, best), lldiv(bytes * MEMBENCH_NTIMES, total));
+	}
+
+	return 0;
+}
+
+/*
+ * Measure latency by following a chain of pointers through working sets
+ * of increasing size. The chain visits each MEMBENCH_STRIDE-byte line of
+ * the working set once, in random order, so that prefetching does not help
+ * and the steps between cache levels and DRAM show up.
+ */
+static int mem_bench_latency(void *buf, ulong size)
+{
+	ulong set, lines, i, j, tmp, us;
+	u32 seed = 0x2545f491;
+	void *volatile sink;
+	void **ptr;
+
+	if (size < MEMBENCH_MIN_SET) {
+		printf("Buffer too small\n");
+		return -EINVAL;
+	}
+	printf("%12s %12s\n", "Set (bytes)", "ns/access");
+	for (set = MEMBENCH_MIN_SET; set && set <= size; set <<= 1) {
+		ulong start;
+
+		if (ctrlc())
+			return -EINTR;
+		WATCHDOG_RESET();
+
+		/* Build a single random cycle (Sattolo's algorithm) */
+		lines = set / MEMBENCH_STRIDE;
+		for (i = 0; i < lines; i++)
+			*(ulong *)(buf + i * MEMBENCH_STRIDE) = i;
+		for (i = lines - 1; i > 0; i--) {
+			seed ^= seed << 13;
+			seed ^= seed >> 17;
+			seed ^= seed << 5;
+			j = seed % i;
+			tmp = *(ulong *)(buf + i * MEMBENCH_STRIDE);
+			*(ulong *)(buf + i * MEMBENCH_STRIDE) =
+				*(ulong *)(buf + j * MEMBENCH_STRIDE);
+			*(ulong *)(buf + j * MEMBENCH_STRIDE) = tmp;
+		}
+		for (i = 0; i < lines; i++) {
+			ptr = buf + i * MEMBENCH_STRIDE;
+			*ptr = buf + *(ulong *)ptr * MEMBENCH_STRIDE;
+		}
+
+		ptr = buf;
+		start = timer_get_us();
+		for (i = 0; i < MEMBENCH_CHASE_COUNT; i += 8) {
+			ptr = *ptr;
+			ptr = *ptr;
+			ptr = *ptr;
+			ptr = *ptr;
+			ptr = *ptr;
+			ptr = *ptr;
+			ptr = *ptr;
+			ptr = *ptr;
+		}
+		us = timer_get_us() - start;
+		sink = ptr;
+
+		/* Show to 0.1ns */
+		tmp = lldiv((u64)us * 10000, MEMBENCH_CHASE_COUNT);
+		printf("%12lu %10lu.%lu\n", set, tmp / 10, tmp % 10);
+	}
+	(void)sink;
+
+	return 0;
+}
+
+/*
+ * Measure memory bandwidth and latency, e.g. to check the DRAM controller
+ * settings on a new board
+ */
+static int do_mem_bench(cmd_tbl_t *cmdtp, int flag, int argc,
+			char * const argv[])
+{
+	bool uncached = false;
+	ulong addr, size;
+	const char *test;
+	void *buf;
+	int ret;
+
+	if (argc > 1 && !strcmp(argv[1], "-u")) {
+		uncached = true;
+		argc--;
+		argv++;
+	}
+	if (argc != 4)
+		return CMD_RET_USAGE;
+	test = argv[1];
+	if (strict_strtoul(argv[2], 16, &addr) < 0 ||
+	    strict_strtoul(argv[3], 16, &size) < 0)
+		return CMD_RET_USAGE;
+	if (strcmp(test, "stream") && strcmp(test, "latency"))
+		return CMD_RET_USAGE;
+
+#ifdef CONFIG_CMD_CACHE
+	if (uncached && dcache_status()) {
+		flush_dcache_all();
+		dcache_disable();
+	} else {
+		uncached = false;
+	}
+#else
+	if (uncached) {
+		printf("Cannot disable the data cache\n");
+		return CMD_RET_FAILURE;
+	}
+#endif
+
+	buf = map_sysmem(addr, size);
+	if (!strcmp(test, "stream"))
+		ret = mem_bench_stream(buf, size);
+	else
+		ret = mem_bench_latency(buf, size);
+	unmap_sysmem(buf);
+
+#ifdef CONFIG_CMD_CACHE
+	if (uncached)
+		dcache_enable();
+#endif
+
+	return ret ? CMD_RET_FAILURE : 0;
+}
+#endif	/* CONFIG_CMD_MEMBENCH */
+
 /* Modify memory.
  *
  * Syntax:
@@ -1264,12 +1709,30 @@ U_BOOT_CMD(
 
 #ifdef CONFIG_CMD_MEMTEST
 U_BOOT_CMD(
-	mtest,	5,	1,	do_mem_mtest,
+	mtest,	6,	1,	do_mem_mtest,
 	"simple RAM read/write test",
+#ifdef CONFIG_SYS_FAST_MEMTEST
+	"[-f] [start [end [pattern [iterations]]]]\n"
+	"-f runs a faster test a cache line at a time, using 'pattern'\n"
+	"   as the seed for the random data"
+#else
 	"[start [end [pattern [iterations]]]]"
+#endif
 );
 #endif	/* CONFIG_CMD_MEMTEST */
 
+#ifdef CONFIG_CMD_MEMBENCH
+U_BOOT_CMD(
+	membench,	5,	1,	do_mem_bench,
+	"memory bandwidth and latency benchmark",
+	"[-u] stream addr size\n"
+	"    - measure bandwidth (MB/s) with STREAM copy/scale/add/triad\n"
+	"membench [-u] latency addr size\n"
+	"    - measure load latency for working sets up to 'size'\n"
+	"-u runs the test with the data cache disabled"
+);
+#endif	/* CONFIG_CMD_MEMBENCH */
+
 #ifdef CONFIG_CMD_MX_CYCLIC
 U_BOOT_CMD(
 	mdc,	4,	1,	do_mem_mdc,
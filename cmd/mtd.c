@@ -16,6 +16,10 @@
 #include <mtd.h>
 #include <dm/devres.h>
 #include <linux/err.h>
+#include <linux/math64.h>
+#ifdef CONFIG_MTD_SPI_NAND
+#include <linux/mtd/spinand.h>
+#endif
 
 #include <linux/ctype.h>
 
@@ -484,6 +488,128 @@ out_put_mtd:
 	return CMD_RET_SUCCESS;
 }
 
+/*
+ * Read the given area a block at a time, skipping bad blocks. The number
+ * of bytes actually read is returned in *readp.
+ */
+static int mtd_bench_read(struct mtd_info *mtd, u64 off, u64 len, u8 *buf,
+			  ulong *us, u64 *readp)
+{
+	ulong start = timer_get_us();
+	u64 end = off + len;
+	size_t retlen;
+	u64 size;
+	int ret;
+
+	*readp = 0;
+	while (off < end) {
+		/* Read up to the end of the block */
+		size = mtd->erasesize - mtd_mod_by_eb(off, mtd);
+		size = min(size, end - off);
+
+		/* Skip the block if it is bad */
+		if (mtd_block_isbad(mtd, off)) {
+			off += size;
+			continue;
+		}
+
+		ret = mtd_read(mtd, off, size, &retlen, buf);
+		if (ret && ret != -EUCLEAN) {
+			printf("Failure while reading at offset 0x%llx\n", off);
+			return ret;
+		}
+
+		off += size;
+		*readp += size;
+	}
+	*us = timer_get_us() - start;
+
+	return 0;
+}
+
+static void mtd_bench_report(const char *name, u64 len, ulong us)
+{
+	u64 rate = len * 1000000;
+
+	/* In KiB/s; the divisor overflows 32 bits for runs over about 4s */
+	rate = div64_u64(rate, (u64)max(us, 1UL) * 1024);
+	printf("%-12s %10llu bytes %10lu us %6llu.%02llu MB/s\n", name, len,
+	       us, rate / 1024, (rate % 1024) * 100 / 1024);
+}
+
+static int do_mtd_bench(cmd_tbl_t *cmdtp, int flag, int argc,
+			char * const argv[])
+{
+#ifdef CONFIG_MTD_SPI_NAND
+	static const char * const mode_names[SPINAND_READ_MODES] = {
+		"page", "cache-seq", "continuous",
+	};
+	int mode, old_mode;
+#endif
+	struct mtd_info *mtd;
+	u64 off, len, done;
+	ulong us;
+	u8 *buf;
+	int ret = 0;
+
+	if (argc < 2)
+		return CMD_RET_USAGE;
+
+	mtd = get_mtd_by_name(argv[1]);
+	if (IS_ERR_OR_NULL(mtd))
+		return CMD_RET_FAILURE;
+
+	off = argc > 2 ? simple_strtoull(argv[2], NULL, 16) : 0;
+	len = argc > 3 ? simple_strtoull(argv[3], NULL, 16) : mtd->size - off;
+	if (!mtd_is_aligned_with_min_io_size(mtd, off) ||
+	    !mtd_is_aligned_with_min_io_size(mtd, len) || off >= mtd->size ||
+	    len > mtd->size - off) {
+		printf("Offset and size must be within the device and aligned with a page (0x%x)\n",
+		       mtd->writesize);
+		ret = -EINVAL;
+		goto out_put_mtd;
+	}
+
+	buf = malloc(mtd->erasesize);
+	if (!buf) {
+		ret = -ENOMEM;
+		goto out_put_mtd;
+	}
+
+	printf("Reading %lld byte(s) at offset 0x%08llx\n", len, off);
+
+#ifdef CONFIG_MTD_SPI_NAND
+	/* Compare the read modes of SPI NANDs */
+	old_mode = spinand_mtd_set_read_mode(mtd, SPINAND_READ_PAGE);
+	if (old_mode >= 0) {
+		for (mode = 0; mode < SPINAND_READ_MODES; mode++) {
+			if (spinand_mtd_set_read_mode(mtd, mode) < 0)
+				continue;
+
+			ret = mtd_bench_read(mtd, off, len, buf, &us, &done);
+			if (ret)
+				break;
+			mtd_bench_report(mode_names[mode], done, us);
+		}
+		spinand_mtd_set_read_mode(mtd, old_mode);
+		goto out_free;
+	}
+#endif
+
+	ret = mtd_bench_read(mtd, off, len, buf, &us, &done);
+	if (!ret)
+		mtd_bench_report("read", done, us);
+
+#ifdef CONFIG_MTD_SPI_NAND
+out_free:
+#endif
+	free(buf);
+out_put_mtd:
+	put_mtd_device(mtd);
+
+	return ret ? CMD_RET_FAILURE : CMD_RET_SUCCESS;
+}
+
 #ifdef CONFIG_AUTO_COMPLETE
 static int mtd_name_complete(int argc, char * const argv[], char last_char,
 			     int maxv, char *cmdv[])
@@ -532,6 +658,7 @@ static char mtd_help_text[] =
 	"\n"
 	"Specific functions:\n"
 	"mtd bad                               <name>\n"
+	"mtd bench                             <name>        [<off> [<size>]]\n"
 	"\n"
 	"With:\n"
 	"\t<name>: NAND partition/chip name\n"
@@ -543,7 +670,9 @@ static char mtd_help_text[] =
 	"\t\t* must be a multiple of a block for erase\n"
 	"\t\t* must be a multiple of a page otherwise (special case: default is a page with dump)\n"
 	"\n"
-	"The .dontskipff option forces writing empty pages, don't use it if unsure.\n";
+	"The .dontskipff option forces writing empty pages, don't use it if unsure.\n"
+	"The bench command measures the read throughput, for SPI NANDs of each\n"
+	"read mode the chip supports.\n";
 #endif
 
 U_BOOT_CMD_WITH_SUBCMDS(mtd, "MTD utils", mtd_help_text,
@@ -557,4 +686,6 @@ U_BOOT_CMD_WITH_SUBCMDS(mtd, "MTD utils", mtd_help_text,
 		U_BOOT_SUBCMD_MKENT_COMPLETE(erase, 4, 0, do_mtd_erase,
 					     mtd_name_complete),
 		U_BOOT_SUBCMD_MKENT_COMPLETE(bad, 2, 1, do_mtd_bad,
+					     mtd_name_complete),
+		U_BOOT_SUBCMD_MKENT_COMPLETE(bench, 4, 0, do_mtd_bench,
 					     mtd_name_complete));
@@ -1182,6 +1182,7 @@ sep_err:
  */
 static int print_env_info(void)
 {
+	struct hsearch_stat stat;
 	const char *value;
 
 	/* print environment validity value */
@@ -1209,6 +1210,17 @@ static int print_env_info(void)
 	value = gd->flags & GD_FLG_ENV_DEFAULT ? "true" : "false";
 	printf("env_use_default = %s\n", value);
 
+	/* print hash table usage and average / longest probe sequence */
+	hstat_r(&env_htab, &stat);
+	printf("env_entries = %u/%u\n", stat.filled, stat.size);
+	if (stat.old_size)
+		printf("env_resizing_from = %u\n", stat.old_size);
+	if (stat.filled)
+		printf("env_probe_avg = %lu.%02lu\n",
+		       stat.probe_total / stat.filled,
+		       stat.probe_total * 100 / stat.filled % 100);
+	printf("env_probe_max = %u\n", stat.probe_max);
+
 	return CMD_RET_SUCCESS;
 }
 
@@ -14,6 +14,7 @@
 #include <spi_flash.h>
 #include <jffs2/jffs2.h>
 #include <linux/mtd/mtd.h>
+#include <linux/sizes.h>
 
 #include <asm/io.h>
 #include <dm/device-internal.h>
@@ -22,6 +23,9 @@
 
 static struct spi_flash *flash;
 
+/* Largest run of changed sectors which 'sf update' erases at once */
+#define SF_UPDATE_MAX_RUN	SZ_1M
+
 /*
  * This function computes the length argument for the erase command.
  * The length on which the command is to operate can be given in two forms:
@@ -154,47 +158,41 @@ static int do_spi_flash_probe(int argc, char * const argv[])
 }
 
 /**
- * Write a block of data to SPI flash, first checking if it is different from
- * what is already there.
+ * Erase and write a run of consecutive sectors which need to change.
  *
- * If the data being written is the same, then *skipped is incremented by len.
+ * The run is erased with a single call, so that the flash driver can use
+ * erase blocks larger than a sector.
  *
  * @param flash		flash context pointer
  * @param offset	flash offset to write
- * @param len		number of bytes to write
+ * @param len		number of bytes to write; only the last sector of the
+ *			run may be partial
  * @param buf		buffer to write from
- * @param cmp_buf	read buffer to use to compare data
- * @param skipped	Count of skipped data (incremented by this function)
+ * @param cmp_buf	buffer holding the current contents of the last sector
  * @return NULL if OK, else a string containing the stage which failed
  */
-static const char *spi_flash_update_block(struct spi_flash *flash, u32 offset,
-		size_t len, const char *buf, char *cmp_buf, size_t *skipped)
+static const char *spi_flash_update_run(struct spi_flash *flash, u32 offset,
+		size_t len, const char *buf, char *cmp_buf)
 {
-	char *ptr = (char *)buf;
+	size_t tail = len % flash->sector_size;
+	size_t full = len - tail;
 
 	debug("offset=%#x, sector_size=%#x, len=%#zx\n",
 	      offset, flash->sector_size, len);
-	/* Read the entire sector so to allow for rewriting */
-	if (spi_flash_read(flash, offset, flash->sector_size, cmp_buf))
-		return "read";
-	/* Compare only what is meaningful (len) */
-	if (memcmp(cmp_buf, buf, len) == 0) {
-		debug("Skip region %x size %zx: no change\n",
-		      offset, len);
-		*skipped += len;
+	if (!len)
 		return NULL;
-	}
-	/* Erase the entire sector */
-	if (spi_flash_erase(flash, offset, flash->sector_size))
+	/* Erase the entire sectors */
+	if (spi_flash_erase(flash, offset, roundup(len, flash->sector_size)))
 		return "erase";
-	/* If it's a partial sector, copy the data into the temp-buffer */
-	if (len != flash->sector_size) {
-		memcpy(cmp_buf, buf, len);
-		ptr = cmp_buf;
-	}
-	/* Write one complete sector */
-	if (spi_flash_write(flash, offset, flash->sector_size, ptr))
+	if (full && spi_flash_write(flash, offset, full, buf))
 		return "write";
+	/* If the last sector is partial, keep the rest of its contents */
+	if (tail) {
+		memcpy(cmp_buf, buf + full, tail);
+		if (spi_flash_write(flash, offset + full, flash->sector_size,
+				    cmp_buf))
+			return "write";
+	}
 
 	return NULL;
 }
@@ -217,6 +215,9 @@ static int spi_flash_update(struct spi_flash *flash, u32 offset,
 	const char *end = buf + len;
 	size_t todo;		/* number of bytes to do in this pass */
 	size_t skipped = 0;	/* statistics */
+	const char *run_buf = NULL;
+	size_t run = 0;		/* changed bytes not yet written */
+	u32 run_offset = 0;
 	const ulong start_time = get_timer(0);
 	size_t scale = 1;
 	const char *start_buf = buf;
@@ -237,8 +238,29 @@ static int spi_flash_update(struct spi_flash *flash, u32 offset,
 							 start_time));
 				last_update = get_timer(0);
 			}
-			err_oper = spi_flash_update_block(flash, offset, todo,
-					buf, cmp_buf, &skipped);
+			/* Read the entire sector so to allow for rewriting */
+			if (spi_flash_read(flash, offset, flash->sector_size,
+					   cmp_buf)) {
+				err_oper = "read";
+				break;
+			}
+			/* Compare only what is meaningful (todo) */
+			if (memcmp(cmp_buf, buf, todo)) {
+				if (!run) {
+					run_buf = buf;
+					run_offset = offset;
+				}
+				run += todo;
+				if (run < SF_UPDATE_MAX_RUN && buf + todo < end)
+					continue;
+			} else {
+				debug("Skip region %x size %zx: no change\n",
+				      offset, todo);
+				skipped += todo;
+			}
+			err_oper = spi_flash_update_run(flash, run_offset, run,
+							run_buf, cmp_buf);
+			run = 0;
 		}
 	} else {
 		err_oper = "malloc";
@@ -319,6 +341,7 @@ static int do_spi_flash_read_write(int argc, char * const argv[])
 
 static int do_spi_flash_erase(int argc, char * const argv[])
 {
+	struct spi_nor_erase_stats stats;
 	int ret;
 	int dev = 0;
 	loff_t offset, len, maxsize;
@@ -342,9 +365,18 @@ static int do_spi_flash_erase(int argc, char * const argv[])
 		return 1;
 	}
 
+	stats = flash->erase_stats;
 	ret = spi_flash_erase(flash, offset, size);
 	printf("SF: %zu bytes @ %#x Erased: %s\n", (size_t)size, (u32)offset,
 	       ret ? "ERROR" : "OK");
+	/* Only the SPI NOR core keeps statistics, not e.g. dataflash */
+	stats.ops = flash->erase_stats.ops - stats.ops;
+	stats.skipped_ops = flash->erase_stats.skipped_ops - stats.skipped_ops;
+	if (!ret && (stats.ops || stats.skipped_ops))
+		printf("SF: %u erase commands, %u skipped (%llu bytes blank) in %lu ms\n",
+		       stats.ops, stats.skipped_ops,
+		       flash->erase_stats.skipped - stats.skipped,
+		       flash->erase_stats.time - stats.time);
 
 	return ret == 0 ? 0 : 1;
 }
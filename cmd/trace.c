@@ -76,6 +76,40 @@ static int create_call_list(int argc, char * const argv[])
 	return 0;
 }
 
+static int do_trace_filter(int argc, char * const argv[])
+{
+	ulong start, end;
+	int allow;
+	int ret;
+
+	if (argc < 2) {
+		trace_print_filter();
+		return 0;
+	}
+	if (!strcmp(argv[1], "clear")) {
+		trace_clear_filter();
+		return 0;
+	}
+	if (argc != 4)
+		return CMD_RET_USAGE;
+	if (!strcmp(argv[1], "allow"))
+		allow = 1;
+	else if (!strcmp(argv[1], "deny"))
+		allow = 0;
+	else
+		return CMD_RET_USAGE;
+
+	start = simple_strtoul(argv[2], NULL, 16);
+	end = simple_strtoul(argv[3], NULL, 16);
+	ret = trace_add_filter(start, end, allow);
+	if (ret) {
+		printf("Cannot add filter (err=%d)\n", ret);
+		return CMD_RET_FAILURE;
+	}
+
+	return 0;
+}
+
 int do_trace(cmd_tbl_t *cmdtp, int flag, int argc, char * const argv[])
 {
 	const char *cmd = argc < 2 ? NULL : argv[1];
@@ -94,6 +128,8 @@ int do_trace(cmd_tbl_t *cmdtp, int flag, int argc, char * const argv[])
 		trace_set_enabled(1);
 		break;
 	case 'f':
+		if (!strcmp(cmd, "filter"))
+			return do_trace_filter(argc - 1, argv + 1);
 		if (create_func_list(argc, argv))
 			return cmd_usage(cmdtp);
 		break;
@@ -108,12 +144,15 @@ int do_trace(cmd_tbl_t *cmdtp, int flag, int argc, char * const argv[])
 }
 
 U_BOOT_CMD(
-	trace,	4,	1,	do_trace,
+	trace,	5,	1,	do_trace,
 	"trace utility commands",
 	"stats                        - display tracing statistics\n"
 	"trace pause                        - pause tracing\n"
 	"trace resume                       - resume tracing\n"
 	"trace funclist [<addr> <size>]     - dump function list into buffer\n"
 	"trace calls  [<addr> <size>]       "
-		"- dump function call trace into buffer"
+		"- dump function call trace into buffer\n"
+	"trace filter [allow|deny <start> <end>]\n"
+	"                                   - show / add to call trace filter\n"
+	"trace filter clear                 - trace calls to all functions"
 );
@@ -0,0 +1,48 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Video console information
+ */
+
+#include <common.h>
+#include <command.h>
+#include <dm.h>
+#include <video.h>
+#include <video_console.h>
+
+static int do_vidconsole_info(cmd_tbl_t *cmdtp, int flag, int argc,
+			      char *const argv[])
+{
+	struct vidconsole_cache_stats stats;
+	struct vidconsole_priv *priv;
+	struct udevice *dev;
+	ulong total;
+
+	for (uclass_first_device(UCLASS_VIDEO_CONSOLE, &dev);
+	     dev;
+	     uclass_next_device(&dev)) {
+		priv = dev_get_uclass_priv(dev);
+		printf("%s: %d x %d characters\n", dev->name, priv->cols,
+		       priv->rows);
+		if (vidconsole_get_cache_stats(dev, &stats))
+			continue;
+		total = stats.hits + stats.misses;
+		printf("   glyph cache %u/%u entries, %lu bytes\n",
+		       stats.entries, stats.max_entries, stats.bytes);
+		printf("   %lu hits, %lu misses", stats.hits, stats.misses);
+		if (total)
+			printf(", hit rate %lu%%",
+			       (ulong)((u64)stats.hits * 100 / total));
+		printf("\n");
+	}
+
+	return 0;
+}
+
+#ifdef CONFIG_SYS_LONGHELP
+static char vidconsole_help_text[] =
+	"info - show video consoles and their glyph cache hit rate\n";
+#endif
+
+U_BOOT_CMD_WITH_SUBCMDS(vidconsole, "video console information",
+			vidconsole_help_text,
+	U_BOOT_SUBCMD_MKENT(info, 1, 1, do_vidconsole_info));
@@ -13,6 +13,7 @@
 #include <linux/libfdt.h>
 #include <malloc.h>
 #include <mapmem.h>
+#include <serial.h>
 #include <vxworks.h>
 #include <tee/optee.h>
 
@@ -609,7 +610,10 @@ int boot_selected_os(int argc, char * const argv[], int state,
 {
 	arch_preboot_os();
 	board_preboot_os();
+	/* Don't leave output queued for the OS to overwrite */
+	serial_flush();
 	boot_fn(state, argc, argv, images);
+	serial_resume_buffer();
 
 	/* Stand-alone may return when 'autostart' is 'no' */
 	if (images->os.type == IH_TYPE_STANDALONE ||
@@ -31,15 +31,27 @@ struct bootstage_record {
 	enum bootstage_id id;
 };
 
+/* One bootstage_start() / bootstage_accum() interval */
+struct bootstage_interval {
+	uint32_t start_us;
+	uint32_t duration_us;
+	enum bootstage_id id;
+};
+
 struct bootstage_data {
 	uint rec_count;
 	uint next_id;
 	struct bootstage_record record[RECORD_COUNT];
+#if CONFIG_IS_ENABLED(BOOTSTAGE_TRACE)
+	uint interval_count;
+	struct bootstage_interval interval[RECORD_COUNT];
+#endif
 };
 
 enum {
 	BOOTSTAGE_VERSION	= 0,
 	BOOTSTAGE_MAGIC		= 0xb00757a3,
+	BOOTSTAGE_INTERVAL_MAGIC = 0xb0075a11,
 	BOOTSTAGE_DIGITS	= 9,
 };
 
@@ -51,6 +63,15 @@ struct bootstage_hdr {
 	u32 next_id;		/* Next ID to use for bootstage */
 };
 
+/*
+ * Optionally follows the name strings in the stash, 4-byte aligned, with the
+ * intervals after it. Readers which do not know about it just ignore it.
+ */
+struct bootstage_interval_hdr {
+	u32 magic;		/* BOOTSTAGE_INTERVAL_MAGIC */
+	u32 count;		/* Number of intervals */
+};
+
 int bootstage_relocate(void)
 {
 	struct bootstage_data *data = gd->bootstage;
@@ -211,6 +232,16 @@ uint32_t bootstage_accum(enum bootstage_id id)
 		return 0;
 	duration = (uint32_t)timer_get_boot_us() - rec->start_us;
 	rec->time_us += duration;
+#if CONFIG_IS_ENABLED(BOOTSTAGE_TRACE)
+	if (data->interval_count < RECORD_COUNT) {
+		struct bootstage_interval *iv;
+
+		iv = &data->interval[data->interval_count++];
+		iv->start_us = rec->start_us;
+		iv->duration_us = duration;
+		iv->id = id;
+	}
+#endif
 
 	return duration;
 }
@@ -419,6 +450,26 @@ int bootstage_stash(void *base, int size)
 		return -ENOSPC;
 	}
 
+#if CONFIG_IS_ENABLED(BOOTSTAGE_TRACE)
+	/* Write the intervals, leaving them out if they do not fit */
+	if (data->interval_count) {
+		struct bootstage_interval_hdr ihdr;
+		char *iptr;
+
+		ihdr.magic = BOOTSTAGE_INTERVAL_MAGIC;
+		ihdr.count = data->interval_count;
+		iptr = (char *)base + ALIGN(ptr - (char *)base, 4);
+		append_data(&iptr, end, &ihdr, sizeof(ihdr));
+		append_data(&iptr, end, data->interval,
+			    ihdr.count * sizeof(*data->interval));
+		if (iptr <= end)
+			ptr = iptr;
+		else
+			debug("%s: Not enough space for bootstage intervals\n",
+			      __func__);
+	}
+#endif
+
 	/* Update total data size */
 	hdr->size = ptr - (char *)base;
 	debug("Stashed %d records\n", hdr->count);
@@ -491,6 +542,26 @@ int bootstage_unstash(const void *base, int size)
 		ptr += strlen(ptr) + 1;
 	}
 
+#if CONFIG_IS_ENABLED(BOOTSTAGE_TRACE)
+	/* Read the intervals, if any */
+	ptr = (char *)base + ALIGN(ptr - (char *)base, 4);
+	if (ptr + sizeof(struct bootstage_interval_hdr) <=
+	    (char *)base + hdr->size) {
+		const struct bootstage_interval_hdr *ihdr = (void *)ptr;
+		uint count = ihdr->count;
+
+		ptr += sizeof(*ihdr);
+		if (ihdr->magic == BOOTSTAGE_INTERVAL_MAGIC &&
+		    ptr + count * sizeof(*data->interval) <=
+		    (char *)base + hdr->size) {
+			count = min(count, RECORD_COUNT - data->interval_count);
+			memcpy(data->interval + data->interval_count, ptr,
+			       count * sizeof(*data->interval));
+			data->interval_count += count;
+		}
+	}
+#endif
+
 	/* Mark the records as read */
 	data->rec_count += hdr->count;
 	data->next_id = hdr->next_id;
@@ -499,6 +570,109 @@ int bootstage_unstash(const void *base, int size)
 	return 0;
 }
 
+#if CONFIG_IS_ENABLED(BOOTSTAGE_TRACE)
+/**
+ * Append a formatted string to a memory buffer, see append_data()
+ *
+ * @param ptrp	Pointer to buffer, updated by this function
+ * @param end	Pointer to end of buffer
+ * @param fmt	printf() format string
+ */
+static void append_printf(char **ptrp, char *end, const char *fmt, ...)
+{
+	char str[80];
+	va_list args;
+	int len;
+
+	va_start(args, fmt);
+	len = vscnprintf(str, sizeof(str), fmt, args);
+	va_end(args);
+	append_data(ptrp, end, str, len);
+}
+
+/**
+ * Append a trace event to a memory buffer, see append_data()
+ *
+ * @param ptrp	Pointer to buffer, updated by this function
+ * @param end	Pointer to end of buffer
+ * @param rec	Boot stage record the event belongs to
+ * @param tid	Trace thread to put the event on
+ * @param start_us	Start time of the event
+ * @param duration_us	Duration of the event
+ */
+static void append_event(char **ptrp, char *end,
+			 const struct bootstage_record *rec, int tid,
+			 uint32_t start_us, uint32_t duration_us)
+{
+	const char *name;
+	char buf[20];
+
+	append_printf(ptrp, end, ",\n{\"name\":\"");
+	for (name = get_record_name(buf, sizeof(buf), rec); *name; name++) {
+		if (*name == '"' || *name == '\\')
+			append_data(ptrp, end, "\\", 1);
+		append_data(ptrp, end, name, 1);
+	}
+	append_printf(ptrp, end,
+		      "\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%u,\"dur\":%u",
+		      tid, start_us, duration_us);
+	append_printf(ptrp, end, ",\"args\":{\"id\":%d%s}}", rec->id,
+		      rec->flags & BOOTSTAGEF_ERROR ? ",\"error\":true" : "");
+}
+
+int bootstage_trace_export(char *buf, int size)
+{
+	struct bootstage_data *data = gd->bootstage;
+	struct bootstage_record *rec;
+	char *ptr = buf, *end = buf + size;
+	uint32_t prev = 0;
+	int i;
+
+	append_printf(&ptr, end, "{\"traceEvents\":[\n");
+	append_printf(&ptr, end, "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,");
+	append_printf(&ptr, end, "\"args\":{\"name\":\"U-Boot\"}}");
+	for (i = 1; i <= 2; i++) {
+		append_printf(&ptr, end,
+			      ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,",
+			      i);
+		append_printf(&ptr, end, "\"args\":{\"name\":\"%s\"}}",
+			      i == 1 ? "stages" : "accumulated");
+	}
+
+	/*
+	 * Each mark ends a stage which started at the previous mark, as in
+	 * bootstage_report()
+	 */
+	qsort(data->record, data->rec_count, sizeof(*rec), h_compare_record);
+	for (i = 0, rec = data->record; i < data->rec_count; i++, rec++) {
+		if (rec->start_us ||
+		    (rec->id != BOOTSTAGE_ID_AWAKE && !rec->time_us))
+			continue;
+		append_event(&ptr, end, rec, 1, prev, rec->time_us - prev);
+		prev = rec->time_us;
+	}
+
+	/* Each bootstage_start() / bootstage_accum() pair */
+	for (i = 0; i < data->interval_count; i++) {
+		const struct bootstage_interval *iv = &data->interval[i];
+
+		rec = find_id(data, iv->id);
+		if (rec)
+			append_event(&ptr, end, rec, 2, iv->start_us,
+				     iv->duration_us);
+	}
+	append_printf(&ptr, end, "\n],\"displayTimeUnit\":\"ms\"}\n");
+
+	/* Check for buffer overflow */
+	if (ptr > end) {
+		debug("%s: Not enough space for bootstage trace\n", __func__);
+		return -ENOSPC;
+	}
+
+	return ptr - buf;
+}
+#endif
+
 int bootstage_get_size(void)
 {
 	struct bootstage_data *data = gd->bootstage;
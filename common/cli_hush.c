@@ -335,6 +335,9 @@ struct in_str {
 	int promptmode;
 #ifndef __U_BOOT__
 	FILE *file;
+#endif
+#ifdef CONFIG_HUSH_PARSE_CACHE
+	struct hush_cache_entry *cache;	/* entry to add parsed lists to */
 #endif
 	int (*get) (struct in_str *);
 	int (*peek) (struct in_str *);
@@ -1161,6 +1164,9 @@ static void setup_file_in_str(struct in_str *i)
 	i->promptmode=1;
 #ifndef __U_BOOT__
 	i->file = f;
+#endif
+#ifdef CONFIG_HUSH_PARSE_CACHE
+	i->cache = NULL;
 #endif
 	i->p = NULL;
 }
@@ -1171,6 +1177,9 @@ static void setup_string_in_str(struct in_str *i, const char *s)
 	i->get = static_get;
 	i->__promptme=1;
 	i->promptmode=1;
+#ifdef CONFIG_HUSH_PARSE_CACHE
+	i->cache = NULL;
+#endif
 	i->p = s;
 }
 
@@ -1540,6 +1549,7 @@ static int run_pipe_real(struct pipe *pi)
 	int pipefds[2];				/* pipefds[0] is for reading */
 	struct child_prog *child;
 	struct built_in_command *x;
+	int sp;
 	char *p;
 # if __GNUC__
 	/* Avoid longjmp clobbering */
@@ -1552,6 +1562,7 @@ static int run_pipe_real(struct pipe *pi)
 	int nextin;
 	int flag = do_repeat ? CMD_FLAG_REPEAT : 0;
 	struct child_prog *child;
+	int sp;
 	char *p;
 # if __GNUC__
 	/* Avoid longjmp clobbering */
@@ -1619,6 +1630,8 @@ static int run_pipe_real(struct pipe *pi)
 			}
 			return EXIT_SUCCESS;   /* don't worry about errors in set_local_var() yet */
 		}
+		/* Count substitutions here: the tree may be run again */
+		sp = child->sp;
 		for (i = 0; is_assignment(child->argv[i]); i++) {
 			p = insert_var_value(child->argv[i]);
 #ifndef __U_BOOT__
@@ -1627,11 +1640,11 @@ static int run_pipe_real(struct pipe *pi)
 			set_local_var(p, 0);
 #endif
 			if (p != child->argv[i]) {
-				child->sp--;
+				sp--;
 				free(p);
 			}
 		}
-		if (child->sp) {
+		if (sp) {
 			char * str = NULL;
 
 			str = make_string(child->argv + i,
@@ -1764,6 +1777,7 @@ static int run_list_real(struct pipe *pi)
 	char *save_name = NULL;
 	char **list = NULL;
 	char **save_list = NULL;
+	struct pipe *for_pipe = NULL;
 	struct pipe *rpipe;
 	int flag_rep = 0;
 #ifndef __U_BOOT__
@@ -1803,7 +1817,8 @@ static int run_list_real(struct pipe *pi)
 				/* check Ctrl-C */
 				ctrlc();
 				if ((had_ctrlc())) {
-					return 1;
+					rcode = 1;
+					goto out;
 				}
 #endif
 				flag_restore = 0;
@@ -1832,6 +1847,7 @@ static int run_list_real(struct pipe *pi)
 				list = make_list_in(pi->next->progs->argv,
 					pi->progs->argv[0]);
 				save_list = list;
+				for_pipe = pi;
 				save_name = pi->progs->argv[0];
 				pi->progs->argv[0] = NULL;
 				flag_rep = 1;
@@ -1839,6 +1855,7 @@ static int run_list_real(struct pipe *pi)
 			if (!(*list)) {
 				free(pi->progs->argv[0]);
 				free(save_list);
+				save_list = NULL;
 				list = NULL;
 				flag_rep = 0;
 				pi->progs->argv[0] = save_name;
@@ -1903,7 +1920,8 @@ static int run_list_real(struct pipe *pi)
 #else
 		if (rcode < -1) {
 			last_return_code = -rcode - 2;
-			return -2;	/* exit */
+			rcode = -2;	/* exit */
+			goto out;
 		}
 		last_return_code=(rcode == 0) ? 0 : 1;
 #endif
@@ -1923,6 +1941,15 @@ static int run_list_real(struct pipe *pi)
 		checkjobs(NULL);
 #endif
 	}
+out:
+	/* Leave a "for" loop as it was, so that the list can be run again */
+	if (save_list) {
+		while (*list)
+			free(*list++);
+		free(for_pipe->progs->argv[0]);
+		for_pipe->progs->argv[0] = save_name;
+		free(save_list);
+	}
 	return rcode;
 }
 
@@ -3180,6 +3207,169 @@ static void update_ifs_map(void)
 	mapset(ifs, 2);            /* also flow through if quoted */
 }
 
+#ifdef CONFIG_HUSH_PARSE_CACHE
+/*
+ * Cache of parsed scripts
+ *
+ * Parsing does not depend on variables (they are substituted when each
+ * command is run), so the lists built for a script can be kept and run
+ * again next time the same text is run, e.g. from 'run' in a loop. Entries
+ * are found by a hash of the text and the parse flags, and the least
+ * recently used one is dropped when the cache is full.
+ */
+struct hush_cache_entry {
+	char *text;		/* script text, NULL if the entry is unused */
+	u32 hash;		/* hash of the text */
+	int flag;		/* flags it was parsed with */
+	struct pipe **lists;	/* lists to run in turn */
+	int count;		/* number of lists */
+	int busy;		/* running (or still being parsed) */
+	int failed;		/* parse not complete, do not keep */
+	ulong used;		/* time of last use, for LRU */
+};
+
+static struct hush_cache_entry hush_cache[CONFIG_HUSH_PARSE_CACHE_SIZE];
+static ulong hush_cache_clock;
+static ulong hush_cache_hits, hush_cache_misses;
+
+static u32 hush_cache_hash(const char *s)
+{
+	u32 hash = 2166136261U;		/* FNV-1a */
+
+	while (*s) {
+		hash ^= (uchar)*s++;
+		hash *= 16777619;
+	}
+
+	return hash;
+}
+
+static void hush_cache_free(struct hush_cache_entry *entry)
+{
+	int i;
+
+	for (i = 0; i < entry->count; i++)
+		free_pipe_list(entry->lists[i], 0);
+	free(entry->lists);
+	free(entry->text);
+	memset(entry, '\0', sizeof(*entry));
+}
+
+/*
+ * Find the entry for a script. If there is none, returns an entry to add the
+ * lists to as they are parsed, or NULL if the script cannot be cached. Use
+ * entry->text to tell which.
+ */
+static struct hush_cache_entry *hush_cache_find(const char *s, int flag)
+{
+	struct hush_cache_entry *entry, *victim = NULL;
+	u32 hash;
+
+	/* Parsing depends on IFS, so only cache with the default */
+	if (env_get("IFS"))
+		return NULL;
+
+	hash = hush_cache_hash(s);
+	for (entry = hush_cache; entry < hush_cache + ARRAY_SIZE(hush_cache);
+	     entry++) {
+		if (entry->text && entry->hash == hash && entry->flag == flag &&
+		    !strcmp(entry->text, s)) {
+			/* A script which runs itself is parsed again */
+			if (entry->busy)
+				return NULL;
+			entry->used = ++hush_cache_clock;
+			hush_cache_hits++;
+			return entry;
+		}
+		if (!entry->busy && (!victim || entry->used < victim->used))
+			victim = entry;
+	}
+	hush_cache_misses++;
+	if (victim) {
+		hush_cache_free(victim);
+		victim->hash = hash;
+		victim->flag = flag;
+		victim->busy = 1;
+	}
+
+	return victim;
+}
+
+/* Keep a parsed list in the entry and run it */
+static int hush_cache_add(struct hush_cache_entry *entry, struct pipe *list)
+{
+	struct pipe **lists;
+
+	lists = realloc(entry->lists, (entry->count + 1) * sizeof(*lists));
+	if (!lists) {
+		entry->failed = 1;
+		return run_list(list);
+	}
+	entry->lists = lists;
+	entry->lists[entry->count++] = list;
+
+	return run_list_real(list);
+}
+
+/* Finish adding to an entry, keeping it if all of the script was parsed */
+static void hush_cache_done(struct hush_cache_entry *entry, const char *s)
+{
+	entry->busy = 0;
+	if (!entry->failed)
+		entry->text = strdup(s);
+	if (!entry->text)
+		hush_cache_free(entry);
+	else
+		entry->used = ++hush_cache_clock;
+}
+
+/* Run the lists of a cached script as parse_stream_outer() would */
+static int hush_cache_run(struct hush_cache_entry *entry)
+{
+	int code = 1;
+	int i;
+
+	entry->busy++;
+	for (i = 0; i < entry->count; i++) {
+		code = run_list_real(entry->lists[i]);
+		if (code == -2) {	/* exit */
+			code = 0;
+			break;
+		}
+		if (code == -1)
+			flag_repeat = 0;
+	}
+	entry->busy--;
+
+	return (code != 0) ? 1 : 0;
+}
+
+void hush_cache_get_stats(ulong *hits, ulong *misses, int *count)
+{
+	int i;
+
+	*hits = hush_cache_hits;
+	*misses = hush_cache_misses;
+	for (i = 0, *count = 0; i < ARRAY_SIZE(hush_cache); i++)
+		*count += hush_cache[i].text != NULL;
+}
+
+static int on_hushcache(const char *name, const char *value, enum env_op op,
+			int flags)
+{
+	int i;
+
+	/* The old text can no longer be run, so drop what is not in use */
+	for (i = 0; i < ARRAY_SIZE(hush_cache); i++) {
+		if (hush_cache[i].text && !hush_cache[i].busy)
+			hush_cache_free(&hush_cache[i]);
+	}
+
+	return 0;
+}
+U_BOOT_ENV_CALLBACK(hushcache, on_hushcache);
+#endif /* CONFIG_HUSH_PARSE_CACHE */
+
 /* most recursion does not come through here, the exeception is
  * from builtin_source() */
 static int parse_stream_outer(struct in_str *inp, int flag)
@@ -3214,8 +3404,18 @@ static int parse_stream_outer(struct in_str *inp, int flag)
 #ifndef __U_BOOT__
 			run_list(ctx.list_head);
 #else
+#ifdef CONFIG_HUSH_PARSE_CACHE
+			if (inp->cache)
+				code = hush_cache_add(inp->cache, ctx.list_head);
+			else
+#endif
 			code = run_list(ctx.list_head);
 			if (code == -2) {	/* exit */
+#ifdef CONFIG_HUSH_PARSE_CACHE
+				/* The rest of the script was not parsed */
+				if (inp->cache)
+					inp->cache->failed = 1;
+#endif
 				b_free(&temp);
 				code = 0;
 				/* XXX hackish way to not allow exit from main loop */
@@ -3236,6 +3436,10 @@ static int parse_stream_outer(struct in_str *inp, int flag)
 #ifdef __U_BOOT__
 			if (inp->__promptme == 0) printf("<INTERRUPT>\n");
 			inp->__promptme = 1;
+#endif
+#ifdef CONFIG_HUSH_PARSE_CACHE
+			if (inp->cache)
+				inp->cache->failed = 1;
 #endif
 			temp.nonnull = 0;
 			temp.quote = 0;
@@ -3261,26 +3465,48 @@ int parse_string_outer(const char *s, int flag)
 {
 	struct in_str input;
 #ifdef __U_BOOT__
+#ifdef CONFIG_HUSH_PARSE_CACHE
+	struct hush_cache_entry *entry = NULL;
+#endif
 	char *p = NULL;
 	int rcode;
 	if (!s)
 		return 1;
 	if (!*s)
 		return 0;
+#ifdef CONFIG_HUSH_PARSE_CACHE
+	/*
+	 * Text built by substituting variables is different each time, so is
+	 * not worth caching
+	 */
+	if (!(flag & FLAG_REPARSING)) {
+		entry = hush_cache_find(s, flag);
+		if (entry && entry->text)
+			return hush_cache_run(entry);
+	}
+#endif
 	if (!(p = strchr(s, '\n')) || *++p) {
 		p = xmalloc(strlen(s) + 2);
 		strcpy(p, s);
 		strcat(p, "\n");
 		setup_string_in_str(&input, p);
-		rcode = parse_stream_outer(&input, flag);
-		free(p);
-		return rcode;
 	} else {
+		p = NULL;
+		setup_string_in_str(&input, s);
+	}
+#ifdef CONFIG_HUSH_PARSE_CACHE
+	input.cache = entry;
 #endif
+	rcode = parse_stream_outer(&input, flag);
+#ifdef CONFIG_HUSH_PARSE_CACHE
+	if (entry)
+		hush_cache_done(entry, s);
+#endif
+	free(p);
+	return rcode;
+#else
 	setup_string_in_str(&input, s);
 	return parse_stream_outer(&input, flag);
-#ifdef __U_BOOT__
-	}
 #endif
 }
 
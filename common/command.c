@@ -12,6 +12,7 @@
 #include <command.h>
 #include <console.h>
 #include <env.h>
+#include <malloc.h>
 #include <linux/ctype.h>
 
 /*
@@ -556,6 +557,40 @@ int cmd_discard_repeatable(cmd_tbl_t *cmdtp, int flag, int argc,
 	return cmdtp->cmd_rep(cmdtp, flag, argc, argv, &repeatable);
 }
 
+#ifdef CONFIG_CMD_STATS
+/* Time spent in each command, in the same order as the command table */
+static struct cmd_stats *cmd_stats;
+
+static struct cmd_stats *cmd_find_stats(const cmd_tbl_t *cmdtp, bool alloc)
+{
+	cmd_tbl_t *start = ll_entry_start(cmd_tbl_t, cmd);
+	const int len = ll_entry_count(cmd_tbl_t, cmd);
+
+	/* Sub-commands are not counted separately */
+	if (cmdtp < start || cmdtp >= start + len)
+		return NULL;
+	if (!cmd_stats && alloc)
+		cmd_stats = calloc(len, sizeof(*cmd_stats));
+	if (!cmd_stats)
+		return NULL;
+
+	return &cmd_stats[cmdtp - start];
+}
+
+const struct cmd_stats *cmd_get_stats(const cmd_tbl_t *cmdtp)
+{
+	return cmd_find_stats(cmdtp, false);
+}
+
+void cmd_reset_stats(void)
+{
+	const int len = ll_entry_count(cmd_tbl_t, cmd);
+
+	if (cmd_stats)
+		memset(cmd_stats, '\0', len * sizeof(*cmd_stats));
+}
+#endif
+
 /**
  * Call a command function. This should be the only route in U-Boot to call
  * a command, so that we can track whether we are waiting for input or
@@ -572,8 +607,21 @@ static int cmd_call(cmd_tbl_t *cmdtp, int flag, int argc, char * const argv[],
 		    int *repeatable)
 {
 	int result;
+#ifdef CONFIG_CMD_STATS
+	struct cmd_stats *stats;
+	ulong start = timer_get_us(), us;
+#endif
 
 	result = cmdtp->cmd_rep(cmdtp, flag, argc, argv, repeatable);
+#ifdef CONFIG_CMD_STATS
+	us = timer_get_us() - start;
+	stats = cmd_find_stats(cmdtp, true);
+	if (stats) {
+		stats->calls++;
+		stats->total_us += us;
+		stats->max_us = max(stats->max_us, us);
+	}
+#endif
 	if (result)
 		debug("Command failed, result=%d\n", result);
 	return result;
@@ -697,6 +697,31 @@ static struct mallinfo current_mallinfo = {  0, 0, 0, 0, 0, 0, 0, 0, 0, 0 };
 /* The total memory obtained from system via sbrk */
 #define sbrked_mem  (current_mallinfo.arena)
 
+#if CONFIG_IS_ENABLED(SYS_MALLOC_FAST_BINS)
+/*
+  Fast bins (U-Boot):
+
+    Freed chunks of up to MALLOC_FAST_MAX bytes are kept on per-size,
+    singly-linked LIFO lists instead of being consolidated, so that the
+    many small allocations made by driver model, the environment, EFI and
+    the filesystems can be satisfied just by popping a list. Cached chunks
+    stay marked in use, so the rest of the allocator never sees them.
+
+    To keep them from fragmenting the heap, all cached chunks are released
+    into the normal bins by malloc_consolidate() before a large request is
+    serviced and before the heap would have to be extended.
+*/
+
+#define NFASTBINS           ((MALLOC_FAST_MAX >> 3) + 1)
+#define fastbin_index(sz)   (((unsigned long)(sz)) >> 3)
+
+static mchunkptr fastbins[NFASTBINS];
+static unsigned long fastbin_bytes;   /* total size of cached chunks */
+static struct malloc_class_stats class_stats[NFASTBINS];
+
+static void free_chunk(mchunkptr p);
+#endif /* SYS_MALLOC_FAST_BINS */
+
 /* Tracking mmaps */
 
 #ifdef DEBUG
@@ -849,6 +874,63 @@ static void do_check_malloced_chunk(p, s) mchunkptr p; INTERNAL_SIZE_T s;
 #define check_malloced_chunk(P,N)
 #endif
 
+#if CONFIG_IS_ENABLED(SYS_MALLOC_FAST_BINS)
+/* Take a chunk of exactly nb bytes from its fast bin, if there is one */
+static mchunkptr fastbin_get(INTERNAL_SIZE_T nb)
+{
+  int idx = fastbin_index(nb);
+  mchunkptr victim = fastbins[idx];
+
+  class_stats[idx].allocs++;
+  if (!victim)
+    return NULL;
+  fastbins[idx] = victim->fd;
+  fastbin_bytes -= nb;
+  class_stats[idx].hits++;
+  class_stats[idx].cached--;
+
+  return victim;
+}
+
+/* Put a small chunk on its fast bin; returns 1 if it was taken */
+static int fastbin_put(mchunkptr p)
+{
+  INTERNAL_SIZE_T sz = chunksize(p);
+  int idx;
+
+  if (chunk_is_mmapped(p) || sz > MALLOC_FAST_MAX)
+    return 0;
+  check_inuse_chunk(p);
+  idx = fastbin_index(sz);
+  p->fd = fastbins[idx];
+  fastbins[idx] = p;
+  fastbin_bytes += sz;
+  class_stats[idx].frees++;
+  class_stats[idx].cached++;
+
+  return 1;
+}
+
+/* Release all cached chunks into the normal bins */
+static void malloc_consolidate(void)
+{
+  mchunkptr p, next;
+  int i;
+
+  for (i = 0; i < NFASTBINS; i++)
+  {
+    for (p = fastbins[i]; p; p = next)
+    {
+      next = p->fd;
+      free_chunk(p);
+    }
+    fastbins[i] = NULL;
+    class_stats[i].cached = 0;
+  }
+  fastbin_bytes = 0;
+}
+#endif /* SYS_MALLOC_FAST_BINS */
+
 
 
 /*
@@ -1269,6 +1351,19 @@ Void_t* mALLOc(bytes) size_t bytes;
 
   nb = request2size(bytes);  /* padded request size; */
 
+#if CONFIG_IS_ENABLED(SYS_MALLOC_FAST_BINS)
+  if (nb <= MALLOC_FAST_MAX)
+  {
+    victim = fastbin_get(nb);
+    if (victim)
+      return chunk2mem(victim);
+  }
+  else if (fastbin_bytes && !is_small_request(nb))
+    malloc_consolidate();
+
+retry:
+#endif
+
   /* Check for exact match in a bin */
 
   if (is_small_request(nb))  /* Faster version for small requests */
@@ -1465,6 +1560,15 @@ Void_t* mALLOc(bytes) size_t bytes;
       return chunk2mem(victim);
 #endif
 
+#if CONFIG_IS_ENABLED(SYS_MALLOC_FAST_BINS)
+    /* Use up any cached chunks before growing the heap */
+    if (fastbin_bytes)
+    {
+      malloc_consolidate();
+      goto retry;
+    }
+#endif
+
     /* Try to extend */
     malloc_extend_top(nb);
     if ( (remainder_size = chunksize(top) - nb) < (long)MINSIZE)
@@ -1506,12 +1610,11 @@ Void_t* mALLOc(bytes) size_t bytes;
 
 
 #if __STD_C
-void fREe(Void_t* mem)
+static void free_chunk(mchunkptr p)
 #else
-void fREe(mem) Void_t* mem;
+static void free_chunk(p) mchunkptr p;
 #endif
 {
-  mchunkptr p;         /* chunk corresponding to mem */
   INTERNAL_SIZE_T hd;  /* its head field */
   INTERNAL_SIZE_T sz;  /* its size */
   int       idx;       /* its bin index */
@@ -1522,16 +1625,6 @@ void fREe(mem) Void_t* mem;
   mchunkptr fwd;       /* misc temp for linking */
   int       islr;      /* track whether merging with last_remainder */
 
-#if CONFIG_VAL(SYS_MALLOC_F_LEN)
-	/* free() is a no-op - all the memory will be freed on relocation */
-	if (!(gd->flags & GD_FLG_FULL_MALLOC_INIT))
-		return;
-#endif
-
-  if (mem == NULL)                              /* free(0) has no effect */
-    return;
-
-  p = mem2chunk(mem);
   hd = p->size;
 
 #if HAVE_MMAP
@@ -1603,6 +1696,29 @@ void fREe(mem) Void_t* mem;
     frontlink(p, sz, idx, bck, fwd);
 }
 
+#if __STD_C
+void fREe(Void_t* mem)
+#else
+void fREe(mem) Void_t* mem;
+#endif
+{
+#if CONFIG_VAL(SYS_MALLOC_F_LEN)
+	/* free() is a no-op - all the memory will be freed on relocation */
+	if (!(gd->flags & GD_FLG_FULL_MALLOC_INIT))
+		return;
+#endif
+
+  if (mem == NULL)                              /* free(0) has no effect */
+    return;
+
+#if CONFIG_IS_ENABLED(SYS_MALLOC_FAST_BINS)
+  if (fastbin_put(mem2chunk(mem)))
+    return;
+#endif
+
+  free_chunk(mem2chunk(mem));
+}
+
 
 
 
@@ -2253,6 +2369,51 @@ size_t malloc_usable_size(mem) Void_t* mem;
 
 
 
+void malloc_get_heap_info(struct malloc_heap_info *info)
+{
+	mbinptr b;
+	mchunkptr p;
+	ulong size;
+	int i;
+
+	memset(info, '\0', sizeof(*info));
+	info->total = mem_malloc_end - mem_malloc_start;
+	info->brk = sbrked_mem;
+	info->brk_peak = max_sbrked_mem;
+	if (sbrk_base == (char *)-1)
+		return;		/* nothing allocated yet */
+
+	info->free = chunksize(top);
+	info->largest_free = info->free;
+	info->free_chunks = 1;
+	for (i = 1; i < NAV; ++i) {
+		b = bin_at(i);
+		for (p = last(b); p != b; p = p->bk) {
+			size = chunksize(p);
+			info->free += size;
+			info->largest_free = max(info->largest_free, size);
+			info->free_chunks++;
+		}
+	}
+#if CONFIG_IS_ENABLED(SYS_MALLOC_FAST_BINS)
+	info->cached = fastbin_bytes;
+#endif
+	info->inuse = info->brk - info->free - info->cached;
+}
+
+int malloc_get_class_stats(const struct malloc_class_stats **statsp)
+{
+#if CONFIG_IS_ENABLED(SYS_MALLOC_FAST_BINS)
+	*statsp = class_stats;
+
+	return NFASTBINS;
+#else
+	*statsp = NULL;
+
+	return 0;
+#endif
+}
+
 /* Utility to update current_mallinfo for malloc_stats and mallinfo() */
 
 #ifdef DEBUG
@@ -20,25 +20,206 @@ DECLARE_GLOBAL_DATA_PTR;
  * @size:	Actual size of iotrace buffer in bytes
  * @needed_size: Needed of iotrace buffer in bytes
  * @offset:	Current write offset into iotrace buffer
- * @region_start: Address of IO region to trace
- * @region_size: Size of region to trace. if 0 will trace all address space
+ * @count:	Number of records in the buffer
+ * @overwritten: Number of records lost in ring mode
+ * @region:	IO regions to trace. if none, trace all address space
+ * @region_count: Number of regions in @region
  * @crc32:	Current value of CRC chceksum of trace records
  * @enabled:	true if enabled, false if disabled
+ * @wrapped:	true if the buffer has been filled in ring mode
+ * @mode:	How records are stored (enum iotrace_mode)
+ * @block_count: Number of blocks in a compact buffer
+ * @block:	Index of the block being written in a compact buffer
+ * @seq:	Sequence number of that block
+ * @last:	Values from the previous record in that block, which the
+ *		next record is stored relative to
  */
 static struct iotrace {
 	ulong start;
 	ulong size;
 	ulong needed_size;
 	ulong offset;
-	ulong region_start;
-	ulong region_size;
+	ulong count;
+	ulong overwritten;
+	struct iotrace_region region[IOTRACE_MAX_REGIONS];
+	int region_count;
 	u32 crc32;
 	bool enabled;
+	bool wrapped;
+	uint mode;
+	ulong block_count;
+	ulong block;
+	u32 seq;
+	struct {
+		ulong timestamp;
+		ulong addr;
+		ulong caller;
+	} last;
 } iotrace;
 
-static void add_record(int flags, const void *ptr, ulong value)
+/* Largest compact record: the flags byte and four 64-bit LEB128 values */
+#define IOTRACE_MAX_REC		(1 + 4 * 10)
+
+static bool iotrace_in_region(ulong addr)
+{
+	int i;
+
+	if (!iotrace.region_count)
+		return true;
+	for (i = 0; i < iotrace.region_count; i++) {
+		if (addr - iotrace.region[i].start < iotrace.region[i].size)
+			return true;
+	}
+
+	return false;
+}
+
+static u8 *put_uleb128(u8 *p, u64 val)
+{
+	do {
+		*p = val & 0x7f;
+		val >>= 7;
+		if (val)
+			*p |= 0x80;
+	} while (*p++ & 0x80);
+
+	return p;
+}
+
+static u8 *put_sleb128(u8 *p, s64 val)
+{
+	/* Zig-zag encode, so that small negative deltas stay small */
+	return put_uleb128(p, ((u64)val << 1) ^ (val >> 63));
+}
+
+static const u8 *get_uleb128(const u8 *p, u64 *valp)
+{
+	u64 val = 0;
+	int shift = 0;
+
+	do {
+		val |= (u64)(*p & 0x7f) << shift;
+		shift += 7;
+	} while (*p++ & 0x80);
+	*valp = val;
+
+	return p;
+}
+
+static const u8 *get_sleb128(const u8 *p, s64 *valp)
+{
+	u64 val;
+
+	p = get_uleb128(p, &val);
+	*valp = (val >> 1) ^ -(val & 1);
+
+	return p;
+}
+
+static struct iotrace_block *iotrace_get_block(ulong block)
+{
+	return map_sysmem(iotrace.start + sizeof(struct iotrace_hdr) +
+			  block * IOTRACE_BLOCK_SIZE, IOTRACE_BLOCK_SIZE);
+}
+
+/* Start writing to the given block, dropping any records already in it */
+static void iotrace_start_block(ulong block)
+{
+	struct iotrace_block *blk = iotrace_get_block(block);
+
+	iotrace.count -= blk->count;
+	iotrace.overwritten += blk->count;
+	blk->seq = ++iotrace.seq;
+	blk->used = 0;
+	blk->count = 0;
+	iotrace.block = block;
+	memset(&iotrace.last, '\0', sizeof(iotrace.last));
+}
+
+static int iotrace_encode(u8 *buf, const struct iotrace_record *rec,
+			  ulong caller)
+{
+	u8 *p = buf;
+
+	*p++ = rec->flags;
+	p = put_uleb128(p, (ulong)rec->timestamp - iotrace.last.timestamp);
+	p = put_sleb128(p, (long)(rec->addr - iotrace.last.addr));
+	p = put_uleb128(p, rec->value);
+	p = put_sleb128(p, (long)(caller - iotrace.last.caller));
+
+	return p - buf;
+}
+
+static void add_compact_record(const struct iotrace_record *rec,
+			       ulong caller)
+{
+	struct iotrace_block *blk;
+	u8 buf[IOTRACE_MAX_REC];
+	int len;
+
+	len = iotrace_encode(buf, rec, caller);
+	iotrace.needed_size += len;
+	if (!iotrace.block_count)
+		return;
+
+	blk = iotrace_get_block(iotrace.block);
+	if (sizeof(*blk) + blk->used + len > IOTRACE_BLOCK_SIZE) {
+		if (iotrace.block + 1 < iotrace.block_count) {
+			iotrace_start_block(iotrace.block + 1);
+		} else if (iotrace.mode & IOTRACE_MODE_RING) {
+			iotrace.wrapped = true;
+			iotrace_start_block(0);
+		} else {
+			WARN_ONCE(1, "WARNING: iotrace buffer exhausted, please check needed length using \"iotrace stats\"\n");
+			return;
+		}
+		blk = iotrace_get_block(iotrace.block);
+		len = iotrace_encode(buf, rec, caller);
+	}
+	memcpy((u8 *)(blk + 1) + blk->used, buf, len);
+	blk->used += len;
+	blk->count++;
+	iotrace.count++;
+	iotrace.offset = sizeof(struct iotrace_hdr) +
+		iotrace.block * IOTRACE_BLOCK_SIZE + sizeof(*blk) + blk->used;
+
+	iotrace.last.timestamp = rec->timestamp;
+	iotrace.last.addr = rec->addr;
+	iotrace.last.caller = caller;
+}
+
+static void add_full_record(const struct iotrace_record *srec)
+{
+	struct iotrace_record *rec;
+
+	iotrace.needed_size += sizeof(struct iotrace_record);
+
+	/* Store it if there is room */
+	if (iotrace.offset + sizeof(*rec) >= iotrace.size) {
+		if (!(iotrace.mode & IOTRACE_MODE_RING) ||
+		    iotrace.size <= sizeof(*rec)) {
+			WARN_ONCE(1, "WARNING: iotrace buffer exhausted, please check needed length using \"iotrace stats\"\n");
+			return;
+		}
+		iotrace.wrapped = true;
+		iotrace.offset = 0;
+	}
+	rec = (struct iotrace_record *)map_sysmem(iotrace.start +
+						  iotrace.offset,
+						  sizeof(*rec));
+	memcpy(rec, srec, sizeof(*rec));
+
+	if (iotrace.wrapped)
+		iotrace.overwritten++;
+	else
+		iotrace.count++;
+	iotrace.offset += sizeof(struct iotrace_record);
+}
+
+static void add_record(int flags, const void *ptr, ulong value, void *caller)
 {
-	struct iotrace_record srec, *rec = &srec;
+	struct iotrace_record rec;
+	ulong addr;
 
 	/*
 	 * We don't support iotrace before relocation. Since the trace buffer
@@ -49,33 +230,27 @@ static void add_record(int flags, const void *ptr, ulong value)
 	if (!(gd->flags & GD_FLG_RELOC) || !iotrace.enabled)
 		return;
 
-	if (iotrace.region_size)
-		if ((ulong)ptr < iotrace.region_start ||
-		    (ulong)ptr > iotrace.region_start + iotrace.region_size)
-			return;
-
-	/* Store it if there is room */
-	if (iotrace.offset + sizeof(*rec) < iotrace.size) {
-		rec = (struct iotrace_record *)map_sysmem(
-					iotrace.start + iotrace.offset,
-					sizeof(value));
-	} else {
-		WARN_ONCE(1, "WARNING: iotrace buffer exhausted, please check needed length using \"iotrace stats\"\n");
-		iotrace.needed_size += sizeof(struct iotrace_record);
+	addr = map_to_sysmem(ptr);
+	if (!iotrace_in_region(addr))
 		return;
-	}
 
-	rec->timestamp = timer_get_us();
-	rec->flags = flags;
-	rec->addr = map_to_sysmem(ptr);
-	rec->value = value;
+	memset(&rec, '\0', sizeof(rec));
+	rec.timestamp = timer_get_us();
+	rec.flags = flags;
+	rec.addr = addr;
+	rec.value = value;
 
-	/* Update our checksum */
-	iotrace.crc32 = crc32(iotrace.crc32, (unsigned char *)rec,
-			      sizeof(*rec));
+	/*
+	 * Update our checksum. This is done even if the record cannot be
+	 * stored, so that it covers all accesses.
+	 */
+	iotrace.crc32 = crc32(iotrace.crc32, (unsigned char *)&rec,
+			      sizeof(rec));
 
-	iotrace.needed_size += sizeof(struct iotrace_record);
-	iotrace.offset += sizeof(struct iotrace_record);
+	if (iotrace.mode & IOTRACE_MODE_COMPACT)
+		add_compact_record(&rec, (ulong)caller - gd->reloc_off);
+	else
+		add_full_record(&rec);
 }
 
 u32 iotrace_readl(const void *ptr)
@@ -83,14 +258,15 @@ u32 iotrace_readl(const void *ptr)
 	u32 v;
 
 	v = readl(ptr);
-	add_record(IOT_32 | IOT_READ, ptr, v);
+	add_record(IOT_32 | IOT_READ, ptr, v, __builtin_return_address(0));
 
 	return v;
 }
 
 void iotrace_writel(ulong value, void *ptr)
 {
-	add_record(IOT_32 | IOT_WRITE, ptr, value);
+	add_record(IOT_32 | IOT_WRITE, ptr, value,
+		   __builtin_return_address(0));
 	writel(value, ptr);
 }
 
@@ -99,14 +275,15 @@ u16 iotrace_readw(const void *ptr)
 	u32 v;
 
 	v = readw(ptr);
-	add_record(IOT_16 | IOT_READ, ptr, v);
+	add_record(IOT_16 | IOT_READ, ptr, v, __builtin_return_address(0));
 
 	return v;
 }
 
 void iotrace_writew(ulong value, void *ptr)
 {
-	add_record(IOT_16 | IOT_WRITE, ptr, value);
+	add_record(IOT_16 | IOT_WRITE, ptr, value,
+		   __builtin_return_address(0));
 	writew(value, ptr);
 }
 
@@ -115,14 +292,15 @@ u8 iotrace_readb(const void *ptr)
 	u32 v;
 
 	v = readb(ptr);
-	add_record(IOT_8 | IOT_READ, ptr, v);
+	add_record(IOT_8 | IOT_READ, ptr, v, __builtin_return_address(0));
 
 	return v;
 }
 
 void iotrace_writeb(ulong value, void *ptr)
 {
-	add_record(IOT_8 | IOT_WRITE, ptr, value);
+	add_record(IOT_8 | IOT_WRITE, ptr, value,
+		   __builtin_return_address(0));
 	writeb(value, ptr);
 }
 
@@ -138,20 +316,40 @@ u32 iotrace_get_checksum(void)
 
 void iotrace_set_region(ulong start, ulong size)
 {
-	iotrace.region_start = start;
-	iotrace.region_size = size;
+	iotrace_reset_region();
+	if (size)
+		iotrace_add_region(start, size);
+}
+
+int iotrace_add_region(ulong start, ulong size)
+{
+	if (!size)
+		return -EINVAL;
+	if (iotrace.region_count == IOTRACE_MAX_REGIONS)
+		return -ENOSPC;
+	iotrace.region[iotrace.region_count].start = start;
+	iotrace.region[iotrace.region_count].size = size;
+	iotrace.region_count++;
+
+	return 0;
 }
 
 void iotrace_reset_region(void)
 {
-	iotrace.region_start = 0;
-	iotrace.region_size = 0;
+	iotrace.region_count = 0;
 }
 
 void iotrace_get_region(ulong *start, ulong *size)
 {
-	*start = iotrace.region_start;
-	*size = iotrace.region_size;
+	*start = iotrace.region_count ? iotrace.region[0].start : 0;
+	*size = iotrace.region_count ? iotrace.region[0].size : 0;
+}
+
+int iotrace_get_regions(const struct iotrace_region **regionp)
+{
+	*regionp = iotrace.region;
+
+	return iotrace.region_count;
 }
 
 void iotrace_set_enabled(int enable)
@@ -166,10 +364,125 @@ int iotrace_get_enabled(void)
 
 void iotrace_set_buffer(ulong start, ulong size)
 {
+	struct iotrace_hdr *hdr;
+	ulong i;
+
 	iotrace.start = start;
 	iotrace.size = size;
 	iotrace.offset = 0;
+	iotrace.count = 0;
+	iotrace.overwritten = 0;
+	iotrace.wrapped = false;
 	iotrace.crc32 = 0;
+	iotrace.block_count = 0;
+
+	if (!(iotrace.mode & IOTRACE_MODE_COMPACT) ||
+	    size < sizeof(*hdr) + IOTRACE_BLOCK_SIZE)
+		return;
+
+	hdr = map_sysmem(start, sizeof(*hdr));
+	hdr->magic = IOTRACE_MAGIC;
+	hdr->version = IOTRACE_VERSION;
+	hdr->mode = iotrace.mode;
+	hdr->block_size = IOTRACE_BLOCK_SIZE;
+	hdr->block_count = (size - sizeof(*hdr)) / IOTRACE_BLOCK_SIZE;
+	hdr->long_size = sizeof(long);
+	iotrace.block_count = hdr->block_count;
+
+	for (i = 0; i < iotrace.block_count; i++)
+		memset(iotrace_get_block(i), '\0',
+		       sizeof(struct iotrace_block));
+	iotrace.seq = 0;
+	iotrace_start_block(0);
+	iotrace.offset = sizeof(*hdr) + sizeof(struct iotrace_block);
+}
+
+void iotrace_set_mode(uint mode)
+{
+	iotrace.mode = mode;
+	iotrace_set_buffer(iotrace.start, iotrace.size);
+}
+
+uint iotrace_get_mode(void)
+{
+	return iotrace.mode;
+}
+
+ulong iotrace_get_overwritten(void)
+{
+	return iotrace.overwritten;
+}
+
+static int iotrace_walk_compact(int (*func)(struct iotrace_record *rec,
+					    ulong caller, void *priv),
+				void *priv)
+{
+	struct iotrace_record rec;
+	struct iotrace_block *blk;
+	ulong i, timestamp, addr, caller;
+	const u8 *p, *end;
+	u64 val;
+	s64 delta;
+	int ret;
+
+	for (i = 0; i < iotrace.block_count; i++) {
+		/* Once wrapped, the oldest block is the one after this one */
+		blk = iotrace_get_block(iotrace.wrapped ?
+			(iotrace.block + 1 + i) % iotrace.block_count : i);
+		if (!blk->seq)
+			break;
+		p = (const u8 *)(blk + 1);
+		end = p + blk->used;
+		timestamp = 0;
+		addr = 0;
+		caller = 0;
+		while (p < end) {
+			memset(&rec, '\0', sizeof(rec));
+			rec.flags = *p++;
+			p = get_uleb128(p, &val);
+			timestamp += val;
+			p = get_sleb128(p, &delta);
+			addr += delta;
+			p = get_uleb128(p, &val);
+			rec.value = val;
+			p = get_sleb128(p, &delta);
+			caller += delta;
+			rec.timestamp = timestamp;
+			rec.addr = addr;
+
+			ret = func(&rec, caller, priv);
+			if (ret)
+				return ret;
+		}
+	}
+
+	return 0;
+}
+
+int iotrace_walk(int (*func)(struct iotrace_record *rec, ulong caller,
+			     void *priv), void *priv)
+{
+	struct iotrace_record *rec;
+	ulong i, slot, slots;
+	int ret;
+
+	if (iotrace.mode & IOTRACE_MODE_COMPACT)
+		return iotrace_walk_compact(func, priv);
+
+	/* Once wrapped, the oldest record is the one at the write offset */
+	slots = iotrace.wrapped ? iotrace.count : 0;
+	slot = iotrace.wrapped ? iotrace.offset / sizeof(*rec) : 0;
+	for (i = 0; i < iotrace.count; i++, slot++) {
+		if (slot == slots)
+			slot = 0;
+		rec = map_sysmem(iotrace.start + slot * sizeof(*rec),
+				 sizeof(*rec));
+		ret = func(rec, 0, priv);
+		if (ret)
+			return ret;
+	}
+
+	return 0;
 }
 
 void iotrace_get_buffer(ulong *start, ulong *size, ulong *needed_size, ulong *offset, ulong *count)
@@ -178,5 +491,5 @@ void iotrace_get_buffer(ulong *start, ulong *size, ulong *needed_size, ulong *of
 	*size = iotrace.size;
 	*needed_size = iotrace.needed_size;
 	*offset = iotrace.offset;
-	*count = iotrace.offset / sizeof(struct iotrace_record);
+	*count = iotrace.count;
 }
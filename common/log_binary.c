@@ -0,0 +1,638 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Binary log driver
+ *
+ * This keeps the format string and arguments of each log record rather than
+ * the formatted message, so that logging is cheap enough to leave enabled at
+ * debug level. Messages are only formatted when the log is dumped with
+ * 'log dump' or passed on to the OS with log_binary_export().
+ *
+ * Records are kept in a ring, dropping the oldest when it is full. Each is a
+ * struct log_bin_rec followed by copies of the file name, function name and
+ * format string, then the arguments, each stored as a u64 or, for %s, as a
+ * NUL-terminated copy of the string. Nothing points outside the record, since
+ * the caller's strings need not be constant (e.g. 'log rec' passes its
+ * arguments). Messages with arguments which cannot be kept this way (e.g. %pM,
+ * which reads memory that may well have changed by the time the log is
+ * dumped) are formatted straight away and stored in place of the format
+ * string and arguments.
+ */
+
+#include <common.h>
+#include <bloblist.h>
+#include <log.h>
+#include <malloc.h>
+#include <time.h>
+#include <linux/ctype.h>
+
+DECLARE_GLOBAL_DATA_PTR;
+
+enum {
+	LOG_BIN_REC_MAX		= 256,	/* maximum size of a record */
+	LOG_BIN_SPEC_MAX	= 32,	/* maximum length of a conversion */
+	LOG_BIN_NAME_MAX	= 64,	/* maximum length of file / function */
+
+	LOG_BIN_FORMATTED	= 1 << 0,	/* record holds the message */
+};
+
+/* Types of argument used by a conversion specification */
+enum log_bin_arg {
+	ARG_END,	/* end of the format string */
+	ARG_NONE,	/* no argument, i.e. %% */
+	ARG_INT,
+	ARG_LONG,
+	ARG_LLONG,
+	ARG_SIZE,
+	ARG_PTRDIFF,
+	ARG_PTR,
+	ARG_STR,
+	ARG_OTHER,	/* cannot be saved, so must be formatted straight away */
+};
+
+/**
+ * struct log_bin_spec - a conversion specification in a format string
+ *
+ * @start: Pointer to the '%' at the start of the specification
+ * @len: Length of the specification
+ * @stars: Number of '*' for width / precision, each taking an int argument
+ * @precision: Precision if given as a number, else -1
+ * @star_precision: true if the precision is given by the last '*'
+ */
+struct log_bin_spec {
+	const char *start;
+	int len;
+	int stars;
+	int precision;
+	bool star_precision;
+};
+
+/**
+ * struct log_bin_rec - header for a record in the binary log
+ *
+ * @size: Size of the record, including this header
+ * @cat: Category (enum log_category_t)
+ * @level: Level (enum log_level_t)
+ * @flags: Flags (LOG_BIN_...)
+ * @line: Line number where the record was generated
+ * @time: Time when the record was generated, in microseconds
+ *
+ * This is followed by the NUL-terminated file and function names, then either
+ * the NUL-terminated format string and its arguments or, with
+ * LOG_BIN_FORMATTED, the formatted message (not terminated)
+ */
+struct log_bin_rec {
+	u16 size;
+	u16 cat;
+	u8 level;
+	u8 flags;
+	u32 line;
+	u64 time;
+};
+
+/**
+ * struct log_bin_priv - state of the binary log
+ *
+ * @buf: Ring buffer, CONFIG_LOG_BINARY_SIZE bytes
+ * @head: Position of the oldest record (free-running)
+ * @tail: Position for the next record (free-running)
+ * @count: Number of records in the ring
+ * @dropped: Number of records dropped to make space for newer ones
+ * @busy: true while the ring is being accessed, to avoid recursion
+ */
+static struct log_bin_priv {
+	char *buf;
+	uint head;
+	uint tail;
+	ulong count;
+	ulong dropped;
+	bool busy;
+} log_bin;
+
+#define LOG_BIN_MASK	(CONFIG_LOG_BINARY_SIZE - 1)
+
+/**
+ * log_bin_next_spec() - Find the next conversion specification in a format
+ *
+ * This follows the subset of printf() conversions supported by vsnprintf()
+ *
+ * @fmtp: Pointer to format string, updated to point after the specification
+ * @spec: Returns information about the specification
+ * @return type of argument used by the specification, or ARG_END if there
+ *	are no more
+ */
+static enum log_bin_arg log_bin_next_spec(const char **fmtp,
+					  struct log_bin_spec *spec)
+{
+	const char *fmt = strchr(*fmtp, '%');
+	int qualifier = 0;
+	char conv;
+
+	if (!fmt)
+		return ARG_END;
+	spec->start = fmt++;
+	spec->stars = 0;
+	spec->precision = -1;
+	spec->star_precision = false;
+
+	while (*fmt && strchr("-+ #0", *fmt))
+		fmt++;
+	if (*fmt == '*') {
+		spec->stars++;
+		fmt++;
+	}
+	while (isdigit(*fmt))
+		fmt++;
+	if (*fmt == '.') {
+		fmt++;
+		if (*fmt == '*') {
+			spec->stars++;
+			spec->star_precision = true;
+			fmt++;
+		} else {
+			spec->precision = simple_strtoul(fmt, NULL, 10);
+			while (isdigit(*fmt))
+				fmt++;
+		}
+	}
+	if (*fmt && strchr("hlLZzt", *fmt)) {
+		qualifier = *fmt++;
+		if (qualifier == 'l' && *fmt == 'l') {
+			qualifier = 'L';
+			fmt++;
+		}
+	}
+	conv = *fmt;
+	if (conv)
+		fmt++;
+	*fmtp = fmt;
+	spec->len = fmt - spec->start;
+
+	switch (conv) {
+	case '%':
+		return ARG_NONE;
+	case 'c':
+		return ARG_INT;
+	case 's':
+		/* UTF-16 strings are not supported */
+		return qualifier == 'l' ? ARG_OTHER : ARG_STR;
+	case 'p':
+		/* Pointer extensions such as %pM look at the data */
+		return isalnum(*fmt) ? ARG_OTHER : ARG_PTR;
+	case 'd':
+	case 'i':
+	case 'o':
+	case 'u':
+	case 'x':
+	case 'X':
+		switch (qualifier) {
+		case 'L':
+			return ARG_LLONG;
+		case 'l':
+			return ARG_LONG;
+		case 'Z':
+		case 'z':
+			return ARG_SIZE;
+		case 't':
+			return ARG_PTRDIFF;
+		default:
+			return ARG_INT;
+		}
+	default:
+		return ARG_OTHER;
+	}
+}
+
+static bool log_bin_put(char **ptrp, char *end, const void *data, int len)
+{
+	if (*ptrp + len > end)
+		return false;
+	memcpy(*ptrp, data, len);
+	*ptrp += len;
+
+	return true;
+}
+
+/* Add a string to a record, truncating it to @max characters */
+static void log_bin_put_str(char **ptrp, const char *str, int max)
+{
+	int len = str ? strnlen(str, max) : 0;
+
+	if (len)
+		memcpy(*ptrp, str, len);
+	(*ptrp)[len] = '\0';
+	*ptrp += len + 1;
+}
+
+/**
+ * log_bin_save_args() - Save the arguments for a format string
+ *
+ * @fmt: Format string
+ * @argsp: Arguments for the format string
+ * @buf: Buffer to hold the arguments
+ * @size: Size of buffer
+ * @return number of bytes used in @buf, or -ENOSPC if the arguments do not
+ *	fit, or -ENOTSUPP if they cannot be saved
+ */
+static int log_bin_save_args(const char *fmt, va_list *argsp, char *buf,
+			     int size)
+{
+	struct log_bin_spec spec;
+	char *ptr = buf, *end = buf + size;
+	enum log_bin_arg type;
+	va_list args;
+	int ret = 0;
+
+	va_copy(args, *argsp);
+	while ((type = log_bin_next_spec(&fmt, &spec)) != ARG_END) {
+		const char *str;
+		int star = 0;
+		u64 val;
+
+		for (; spec.stars; spec.stars--) {
+			star = va_arg(args, int);
+			val = star;
+			if (!log_bin_put(&ptr, end, &val, sizeof(val)))
+				goto nospace;
+		}
+		switch (type) {
+		case ARG_NONE:
+			continue;
+		case ARG_INT:
+			val = va_arg(args, int);
+			break;
+		case ARG_LONG:
+			val = va_arg(args, long);
+			break;
+		case ARG_LLONG:
+			val = va_arg(args, long long);
+			break;
+		case ARG_SIZE:
+			val = va_arg(args, size_t);
+			break;
+		case ARG_PTRDIFF:
+			val = va_arg(args, ptrdiff_t);
+			break;
+		case ARG_PTR:
+			val = (uintptr_t)va_arg(args, void *);
+			break;
+		case ARG_STR:
+			/* With a precision, the string need not be terminated */
+			str = va_arg(args, const char *);
+			if (!str)
+				str = "<NULL>";
+			if (spec.star_precision)
+				spec.precision = max(star, 0);
+			if (!log_bin_put(&ptr, end, str, spec.precision >= 0 ?
+					 strnlen(str, spec.precision) :
+					 strlen(str)) ||
+			    !log_bin_put(&ptr, end, "", 1))
+				goto nospace;
+			continue;
+		default:
+			ret = -ENOTSUPP;
+			goto out;
+		}
+		if (!log_bin_put(&ptr, end, &val, sizeof(val)))
+			goto nospace;
+	}
+	ret = ptr - buf;
+	goto out;
+nospace:
+	ret = -ENOSPC;
+out:
+	va_end(args);
+
+	return ret;
+}
+
+/**
+ * log_bin_format_msg() - Format a message from its saved arguments
+ *
+ * @fmt: Format string
+ * @args: Arguments, as saved by log_bin_save_args()
+ * @args_end: End of arguments
+ * @buf: Buffer for the message
+ * @size: Size of buffer
+ * @return number of characters written to @buf, excluding the terminator
+ */
+static int log_bin_format_msg(const char *fmt, const char *args,
+			      const char *args_end, char *buf, int size)
+{
+	const char *prev = fmt;
+	struct log_bin_spec spec;
+	enum log_bin_arg type;
+	int pos = 0;
+
+	for (; (type = log_bin_next_spec(&fmt, &spec)) != ARG_END; prev = fmt) {
+		char conv[LOG_BIN_SPEC_MAX + 2 * 12];
+		char *out = conv;
+		const char *in;
+		u64 val = 0;
+
+		/* Copy the text before the specification */
+		pos += scnprintf(buf + pos, size - pos, "%.*s",
+				 (int)(spec.start - prev), prev);
+		if (type == ARG_NONE) {
+			pos += scnprintf(buf + pos, size - pos, "%%");
+			continue;
+		}
+
+		/* Copy the specification, filling in any '*' */
+		for (in = spec.start; in < fmt; in++) {
+			if (out - conv >= LOG_BIN_SPEC_MAX)
+				break;
+			if (*in != '*') {
+				*out++ = *in;
+				continue;
+			}
+			if (args + sizeof(val) > args_end)
+				return pos;
+			memcpy(&val, args, sizeof(val));
+			args += sizeof(val);
+			out += sprintf(out, "%d", (int)val);
+		}
+		*out = '\0';
+
+		if (type == ARG_STR) {
+			int len = strnlen(args, args_end - args);
+
+			if (len == args_end - args)
+				return pos;
+			pos += scnprintf(buf + pos, size - pos, conv, args);
+			args += len + 1;
+			continue;
+		}
+		if (args + sizeof(val) > args_end)
+			return pos;
+		memcpy(&val, args, sizeof(val));
+		args += sizeof(val);
+		switch (type) {
+		case ARG_LONG:
+			pos += scnprintf(buf + pos, size - pos, conv, (long)val);
+			break;
+		case ARG_LLONG:
+			pos += scnprintf(buf + pos, size - pos, conv,
+					 (long long)val);
+			break;
+		case ARG_SIZE:
+			pos += scnprintf(buf + pos, size - pos, conv,
+					 (size_t)val);
+			break;
+		case ARG_PTRDIFF:
+			pos += scnprintf(buf + pos, size - pos, conv,
+					 (ptrdiff_t)val);
+			break;
+		case ARG_PTR:
+			pos += scnprintf(buf + pos, size - pos, conv,
+					 (void *)(uintptr_t)val);
+			break;
+		default:
+			pos += scnprintf(buf + pos, size - pos, conv, (int)val);
+			break;
+		}
+	}
+	pos += scnprintf(buf + pos, size - pos, "%s", fmt);
+
+	return pos;
+}
+
+/**
+ * log_bin_format_rec() - Format a record from the binary log
+ *
+ * The fields shown are selected by gd->log_fmt, as with the console driver
+ *
+ * @rec: Record to format, followed by its arguments or message
+ * @buf: Buffer for the output
+ * @size: Size of buffer
+ * @return number of characters written to @buf, excluding the terminator
+ */
+static int log_bin_format_rec(const struct log_bin_rec *rec, char *buf,
+			      int size)
+{
+	const char *file = (const char *)(rec + 1);
+	const char *func = file + strlen(file) + 1;
+	const char *data = func + strlen(func) + 1;
+	const char *end = (const char *)rec + rec->size;
+	const char *msg_fmt = NULL;
+	int fmt = gd->log_fmt;
+	int pos;
+
+	if (!(rec->flags & LOG_BIN_FORMATTED)) {
+		msg_fmt = data;
+		data += strlen(msg_fmt) + 1;
+	}
+
+	pos = scnprintf(buf, size, "[%5lu.%06lu] ",
+			(ulong)(rec->time / 1000000),
+			(ulong)(rec->time % 1000000));
+	if (fmt & (1 << LOGF_LEVEL))
+		pos += scnprintf(buf + pos, size - pos, "%s.",
+				 log_get_level_name(rec->level));
+	if (fmt & (1 << LOGF_CAT))
+		pos += scnprintf(buf + pos, size - pos, "%s,",
+				 log_get_cat_name(rec->cat));
+	if (fmt & (1 << LOGF_FILE))
+		pos += scnprintf(buf + pos, size - pos, "%s:", file);
+	if (fmt & (1 << LOGF_LINE))
+		pos += scnprintf(buf + pos, size - pos, "%d-", rec->line);
+	if (fmt & (1 << LOGF_FUNC))
+		pos += scnprintf(buf + pos, size - pos, "%s()", func);
+	if (fmt & (1 << LOGF_MSG)) {
+		if (fmt != (1 << LOGF_MSG))
+			pos += scnprintf(buf + pos, size - pos, " ");
+		if (msg_fmt)
+			pos += log_bin_format_msg(msg_fmt, data, end,
+						  buf + pos, size - pos);
+		else
+			pos += scnprintf(buf + pos, size - pos, "%.*s",
+					 (int)(end - data), data);
+	}
+
+	return pos;
+}
+
+static void log_bin_write(uint pos, const void *data, uint len)
+{
+	uint ofs = pos & LOG_BIN_MASK;
+	uint first = min(len, (uint)CONFIG_LOG_BINARY_SIZE - ofs);
+
+	memcpy(log_bin.buf + ofs, data, first);
+	memcpy(log_bin.buf, data + first, len - first);
+}
+
+static void log_bin_read(uint pos, void *data, uint len)
+{
+	uint ofs = pos & LOG_BIN_MASK;
+	uint first = min(len, (uint)CONFIG_LOG_BINARY_SIZE - ofs);
+
+	memcpy(data, log_bin.buf + ofs, first);
+	memcpy(data + first, log_bin.buf, len - first);
+}
+
+/* Add a record to the ring, dropping the oldest ones to make space */
+static void log_bin_add(const struct log_bin_rec *rec)
+{
+	/* LOG_BIN_MASK needs a power of two; each record must fit the ring */
+	BUILD_BUG_ON(CONFIG_LOG_BINARY_SIZE & LOG_BIN_MASK);
+	BUILD_BUG_ON(CONFIG_LOG_BINARY_SIZE < LOG_BIN_REC_MAX);
+
+	while (log_bin.tail - log_bin.head + rec->size >
+	       CONFIG_LOG_BINARY_SIZE) {
+		u16 size;
+
+		log_bin_read(log_bin.head, &size, sizeof(size));
+		log_bin.head += size;
+		log_bin.count--;
+		log_bin.dropped++;
+	}
+	log_bin_write(log_bin.tail, rec, rec->size);
+	log_bin.tail += rec->size;
+	log_bin.count++;
+}
+
+static int log_binary_emit(struct log_device *ldev, struct log_rec *rec)
+{
+	char data[LOG_BIN_REC_MAX] __aligned(sizeof(u64));
+	struct log_bin_rec *hdr = (struct log_bin_rec *)data;
+	char *ptr = data + sizeof(*hdr), *msg;
+	char *end = data + sizeof(data);
+	int len;
+
+	/* There is nowhere to keep records before relocation */
+	if (!(gd->flags & GD_FLG_RELOC) || log_bin.busy)
+		return -EBUSY;
+	log_bin.busy = true;
+	if (!log_bin.buf) {
+		log_bin.buf = malloc(CONFIG_LOG_BINARY_SIZE);
+		if (!log_bin.buf)
+			goto out;
+	}
+
+	hdr->cat = rec->cat;
+	hdr->level = rec->level;
+	hdr->flags = 0;
+	hdr->line = rec->line;
+	hdr->time = timer_get_us();
+	log_bin_put_str(&ptr, rec->file, LOG_BIN_NAME_MAX);
+	log_bin_put_str(&ptr, rec->func, LOG_BIN_NAME_MAX);
+
+	msg = ptr;
+	len = -ENOSPC;
+	if (log_bin_put(&ptr, end, rec->fmt, strlen(rec->fmt) + 1))
+		len = log_bin_save_args(rec->fmt, rec->args, ptr, end - ptr);
+	if (len < 0) {
+		va_list fmt_args;
+
+		va_copy(fmt_args, *rec->args);
+		len = vscnprintf(msg, end - msg, rec->fmt, fmt_args);
+		va_end(fmt_args);
+		hdr->flags |= LOG_BIN_FORMATTED;
+		ptr = msg;
+	}
+	hdr->size = ptr + len - data;
+	log_bin_add(hdr);
+out:
+	log_bin.busy = false;
+
+	return 0;
+}
+
+/**
+ * log_bin_for_each() - Format each record in the binary log, oldest first
+ *
+ * @func: Function to call with each formatted record
+ * @priv: Private data for @func
+ */
+static void log_bin_for_each(void (*func)(const char *line, void *priv),
+			     void *priv)
+{
+	char data[LOG_BIN_REC_MAX] __aligned(sizeof(u64));
+	struct log_bin_rec *rec = (struct log_bin_rec *)data;
+	char line[CONFIG_SYS_CBSIZE];
+	uint pos;
+
+	for (pos = log_bin.head; pos != log_bin.tail; pos += rec->size) {
+		log_bin_read(pos, data, sizeof(rec->size));
+		log_bin_read(pos, data, rec->size);
+		log_bin_format_rec(rec, line, sizeof(line));
+		func(line, priv);
+	}
+}
+
+static void log_bin_print(const char *line, void *priv)
+{
+	puts(line);
+}
+
+void log_binary_dump(void)
+{
+	if (log_bin.busy)
+		return;
+	log_bin.busy = true;
+	if (log_bin.dropped)
+		printf("(%lu older records dropped)\n", log_bin.dropped);
+	if (log_bin.buf)
+		log_bin_for_each(log_bin_print, NULL);
+	printf("%lu records, %u/%u bytes used\n", log_bin.count,
+	       log_bin.tail - log_bin.head, CONFIG_LOG_BINARY_SIZE);
+	log_bin.busy = false;
+}
+
+#if CONFIG_IS_ENABLED(BLOBLIST)
+/* Output buffer used by log_binary_export() */
+struct log_bin_export {
+	char *buf;
+	int size;
+	int pos;
+};
+
+static void log_bin_export_line(const char *line, void *priv)
+{
+	struct log_bin_export *exp = priv;
+	int len = strlen(line);
+
+	if (exp->buf)
+		strlcpy(exp->buf + exp->pos, line, exp->size - exp->pos);
+	exp->pos = min(exp->pos + len, exp->size - 1);
+}
+
+int log_binary_export(void)
+{
+	struct log_bin_export exp;
+	void *blob;
+	int ret;
+
+	if (!log_bin.buf || log_bin.busy)
+		return 0;
+	log_bin.busy = true;
+
+	/* Work out the space needed, then format into the bloblist */
+	exp.buf = NULL;
+	exp.size = INT_MAX;
+	exp.pos = 0;
+	log_bin_for_each(log_bin_export_line, &exp);
+	exp.size = exp.pos + 1;
+	ret = bloblist_ensure_size_ret(BLOBLISTT_LOG, &exp.size, &blob);
+	if (!ret) {
+		exp.buf = blob;
+		exp.pos = 0;
+		exp.buf[0] = '\0';
+		log_bin_for_each(log_bin_export_line, &exp);
+		bloblist_finish();
+	}
+	log_bin.busy = false;
+
+	return ret;
+}
+#else
+int log_binary_export(void)
+{
+	return 0;
+}
+#endif
+
+LOG_DRIVER(binary) = {
+	.name	= "binary",
+	.flags	= LOGDF_RAW,
+	.emit	= log_binary_emit,
+};
@@ -0,0 +1,16 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Common entry point for resetting the board
+ */
+
+#include <common.h>
+#include <command.h>
+#include <serial.h>
+
+int do_reset(cmd_tbl_t *cmdtp, int flag, int argc, char * const argv[])
+{
+	/* Output still queued for the UART would be lost with the reset */
+	serial_flush();
+
+	return arch_do_reset(cmdtp, flag, argc, argv);
+}
@@ -61,6 +61,16 @@ endif
 
 ifdef FTRACE
 PLATFORM_CPPFLAGS += -finstrument-functions -DFTRACE
+TRACE_EXCLUDE_FILES := $(CONFIG_TRACE_EXCLUDE_FILES:"%"=%)
+TRACE_EXCLUDE_FUNCS := $(CONFIG_TRACE_EXCLUDE_FUNCS:"%"=%)
+ifneq ($(TRACE_EXCLUDE_FILES),)
+PLATFORM_CPPFLAGS += \
+	-finstrument-functions-exclude-file-list=$(TRACE_EXCLUDE_FILES)
+endif
+ifneq ($(TRACE_EXCLUDE_FUNCS),)
+PLATFORM_CPPFLAGS += \
+	-finstrument-functions-exclude-function-list=$(TRACE_EXCLUDE_FUNCS)
+endif
 endif
 
 #########################################################################
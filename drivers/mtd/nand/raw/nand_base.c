@@ -1111,6 +1111,56 @@ int nand_read_page_op(struct nand_chip *chip, unsigned int page,
 }
 EXPORT_SYMBOL_GPL(nand_read_page_op);
 
+/**
+ * nand_read_cache_supported - Check whether cached sequential reads can be used
+ * @chip: The NAND chip
+ *
+ * Both the chip (through its ONFI parameter page) and the controller driver
+ * (through NAND_CACHE_READ) have to support them.
+ */
+static bool nand_read_cache_supported(struct nand_chip *chip)
+{
+	struct mtd_info *mtd = nand_to_mtd(chip);
+
+	return (chip->options & NAND_CACHE_READ) && chip->onfi_version &&
+	       (le16_to_cpu(chip->onfi_params.opt_cmd) &
+		ONFI_OPT_CMD_READ_CACHE) &&
+	       mtd->writesize > 512 && nand_standard_page_accessors(&chip->ecc) &&
+	       chip->ecc.mode != NAND_ECC_HW_OOB_FIRST;
+}
+
+/**
+ * nand_read_page_cache_op - Do a cached sequential READ PAGE operation
+ * @chip: The NAND chip
+ * @page: page to read
+ * @first: this page starts the sequence
+ * @last: this page ends the sequence
+ *
+ * The first page of a sequence is loaded with a READ PAGE operation. Each
+ * page is then moved to the cache register with READ CACHE SEQUENTIAL, which
+ * lets the chip load the next page from the array while this one is
+ * transferred, or with READ CACHE END for the last page. The pages of a
+ * sequence have to be consecutive and in the same block.
+ * This function does not select/unselect the CS line.
+ *
+ * Returns 0 on success, a negative error code otherwise.
+ */
+static int nand_read_page_cache_op(struct nand_chip *chip, unsigned int page,
+				   bool first, bool last)
+{
+	struct mtd_info *mtd = nand_to_mtd(chip);
+
+	if (first) {
+		chip->cmdfunc(mtd, NAND_CMD_READ0, 0, page);
+		if (last)
+			return 0;
+	}
+	chip->cmdfunc(mtd, last ? NAND_CMD_READCACHEEND : NAND_CMD_READCACHESEQ,
+		      -1, -1);
+
+	return 0;
+}
+
 /**
  * nand_read_param_page_op - Do a READ PARAMETER PAGE operation
  * @chip: The NAND chip
@@ -2317,6 +2367,8 @@ static int nand_do_read_ops(struct mtd_info *mtd, loff_t from,
 	unsigned int max_bitflips = 0;
 	int retry_mode = 0;
 	bool ecc_fail = false;
+	bool cache_read = nand_read_cache_supported(chip);
+	int seq_last = -1;	/* last page of the cached read sequence */
 
 	chipnr = (int)(from >> chip->chip_shift);
 	chip->select_chip(mtd, chipnr);
@@ -2346,7 +2398,7 @@ static int nand_do_read_ops(struct mtd_info *mtd, loff_t from,
 			use_bufpoi = 0;
 
 		/* Is the current page in the buffer? */
-		if (realpage != chip->pagebuf || oob) {
+		if (realpage != chip->pagebuf || oob || realpage <= seq_last) {
 			bufpoi = use_bufpoi ? chip->buffers->databuf : buf;
 
 			if (use_bufpoi && aligned)
@@ -2354,7 +2406,24 @@ static int nand_do_read_ops(struct mtd_info *mtd, loff_t from,
 						 __func__, buf);
 
 read_retry:
-			if (nand_standard_page_accessors(&chip->ecc)) {
+			if (cache_read) {
+				bool first = realpage > seq_last;
+
+				/* Read up to the end of the request or block */
+				if (first) {
+					int block_end = realpage |
+						((1 << (chip->phys_erase_shift -
+							chip->page_shift)) - 1);
+
+					seq_last = realpage +
+						(col + readlen - 1) / mtd->writesize;
+					seq_last = min(seq_last, block_end);
+				}
+				ret = nand_read_page_cache_op(chip, page, first,
+							      realpage == seq_last);
+				if (ret)
+					break;
+			} else if (nand_standard_page_accessors(&chip->ecc)) {
 				ret = nand_read_page_op(chip, page, 0, NULL, 0);
 				if (ret)
 					break;
@@ -2419,6 +2488,12 @@ read_retry:
 
 			if (mtd->ecc_stats.failed - ecc_failures) {
 				if (retry_mode + 1 < chip->read_retries) {
+					/* Re-read the page on its own */
+					if (realpage < seq_last)
+						nand_read_page_cache_op(chip,
+							page, false, true);
+					cache_read = false;
+					seq_last = -1;
 					retry_mode++;
 					ret = nand_setup_read_retry(mtd,
 							retry_mode);
@@ -2468,6 +2543,9 @@ read_retry:
 			chip->select_chip(mtd, chipnr);
 		}
 	}
+	/* End a sequence which was cut short by an error */
+	if (realpage < seq_last)
+		nand_read_page_cache_op(chip, page, false, true);
 	chip->select_chip(mtd, -1);
 
 	ops->retlen = ops->len - (size_t) readlen;
@@ -206,7 +206,9 @@ static int spinand_init_quad_enable(struct spinand_device *spinand)
 
 	if (spinand->op_templates.read_cache->data.buswidth == 4 ||
 	    spinand->op_templates.write_cache->data.buswidth == 4 ||
-	    spinand->op_templates.update_cache->data.buswidth == 4)
+	    spinand->op_templates.update_cache->data.buswidth == 4 ||
+	    (spinand->op_templates.cont_read &&
+	     spinand->op_templates.cont_read->data.buswidth == 4))
 		enable = true;
 
 	return spinand_upd_cfg(spinand, CFG_QUAD_ENABLE,
@@ -237,6 +239,15 @@ static int spinand_load_page_op(struct spinand_device *spinand,
 	return spi_mem_exec_op(spinand->slave, &op);
 }
 
+static int spinand_read_cache_seq_op(struct spinand_device *spinand,
+				     bool last)
+{
+	struct spi_mem_op seq_op = SPINAND_PAGE_READ_CACHE_SEQ_OP;
+	struct spi_mem_op last_op = SPINAND_PAGE_READ_CACHE_LAST_OP;
+
+	return spi_mem_exec_op(spinand->slave, last ? &last_op : &seq_op);
+}
+
 static int spinand_read_from_cache_op(struct spinand_device *spinand,
 				      const struct nand_page_io_req *req)
 {
@@ -532,6 +543,120 @@ static int spinand_read_page(struct spinand_device *spinand,
 	return spinand_check_ecc_status(spinand, status);
 }
 
+/*
+ * Read a page as part of a READ PAGE CACHE SEQUENTIAL sequence. The first
+ * page of a sequence is loaded into the data register with PAGE READ. Each
+ * page is then moved to the cache with READ PAGE CACHE SEQUENTIAL, which
+ * also starts loading the next page into the data register while the cache
+ * is read out, or with READ PAGE CACHE LAST for the last page.
+ */
+static int spinand_read_page_seq(struct spinand_device *spinand,
+				 const struct nand_page_io_req *req,
+				 bool first, bool last, bool ecc_enabled)
+{
+	u8 status;
+	int ret;
+
+	if (first) {
+		ret = spinand_load_page_op(spinand, req);
+		if (ret)
+			return ret;
+
+		ret = spinand_wait(spinand, NULL);
+		if (ret < 0)
+			return ret;
+	}
+
+	ret = spinand_read_cache_seq_op(spinand, last);
+	if (ret)
+		return ret;
+
+	ret = spinand_wait(spinand, &status);
+	if (ret < 0)
+		return ret;
+
+	ret = spinand_read_from_cache_op(spinand, req);
+	if (ret)
+		return ret;
+
+	if (!ecc_enabled)
+		return 0;
+
+	return spinand_check_ecc_status(spinand, status);
+}
+
+/*
+ * Read the main area of @npages consecutive pages, starting with the page
+ * of @req, into the data buffer of @req with a single READ FROM CACHE in
+ * continuous read mode. The ECC status covers all the pages.
+ */
+static int spinand_read_pages_cont(struct spinand_device *spinand,
+				   const struct nand_page_io_req *req,
+				   unsigned int npages, bool ecc_enabled)
+{
+	struct nand_device *nand = spinand_to_nand(spinand);
+	struct spi_mem_op op = *spinand->op_templates.cont_read;
+	u8 status;
+	int ret;
+
+	ret = spinand->set_cont_read(spinand, true);
+	if (ret)
+		return ret;
+
+	ret = spinand_load_page_op(spinand, req);
+	if (ret)
+		goto out;
+
+	ret = spinand_wait(spinand, NULL);
+	if (ret < 0)
+		goto out;
+
+	op.data.buf.in = req->databuf.in;
+	op.data.nbytes = npages * nanddev_page_size(nand);
+	ret = spi_mem_exec_op(spinand->slave, &op);
+	if (ret)
+		goto out;
+
+	/* The end of the stream aborts loading the next page */
+	ret = spinand_wait(spinand, &status);
+	if (ret < 0)
+		goto out;
+
+	ret = ecc_enabled ? spinand_check_ecc_status(spinand, status) : 0;
+out:
+	spinand->set_cont_read(spinand, false);
+
+	return ret;
+}
+
+/*
+ * Get the number of pages which can be read in continuous read mode,
+ * starting with the current page of @iter. The stream is kept within an
+ * eraseblock, must cover whole pages without OOB data and must not be split
+ * by the controller, since deselecting the chip ends it.
+ */
+static unsigned int spinand_cont_read_pages(struct spinand_device *spinand,
+					    const struct nand_io_iter *iter)
+{
+	struct nand_device *nand = spinand_to_nand(spinand);
+	struct spi_mem_op op = *spinand->op_templates.cont_read;
+	unsigned int pagesize = nanddev_page_size(nand);
+	unsigned int npages;
+
+	if (spinand->read_mode != SPINAND_READ_CONT || iter->oobleft ||
+	    iter->req.dataoffs || iter->dataleft < 2 * pagesize)
+		return 0;
+
+	npages = min(iter->dataleft / pagesize,
+		     nanddev_pages_per_eraseblock(nand) - iter->req.pos.page);
+	op.data.nbytes = npages * pagesize;
+	if (spi_mem_adjust_op_size(spinand->slave, &op))
+		return 0;
+	npages = op.data.nbytes / pagesize;
+
+	return npages < 2 ? 0 : npages;
+}
+
 static int spinand_write_page(struct spinand_device *spinand,
 			      const struct nand_page_io_req *req)
 {
@@ -566,6 +691,8 @@ static int spinand_mtd_read(struct mtd_info *mtd, loff_t from,
 	struct nand_io_iter iter;
 	bool enable_ecc = false;
 	bool ecc_failed = false;
+	bool in_seq = false;
+	unsigned int npages;
 	int ret = 0;
 
 	if (ops->mode != MTD_OPS_RAW && spinand->eccinfo.ooblayout)
@@ -576,6 +703,8 @@ static int spinand_mtd_read(struct mtd_info *mtd, loff_t from,
 #endif
 
 	nanddev_io_for_each_page(nand, from, ops, &iter) {
+		bool more;
+
 		ret = spinand_select_target(spinand, iter.req.pos.target);
 		if (ret)
 			break;
@@ -584,7 +713,43 @@ static int spinand_mtd_read(struct mtd_info *mtd, loff_t from,
 		if (ret)
 			break;
 
-		ret = spinand_read_page(spinand, &iter.req, enable_ecc);
+		npages = spinand_cont_read_pages(spinand, &iter);
+		if (npages) {
+			ret = spinand_read_pages_cont(spinand, &iter.req, npages,
+						      enable_ecc);
+			if (ret < 0 && ret != -EBADMSG)
+				break;
+
+			if (ret == -EBADMSG) {
+				ecc_failed = true;
+				mtd->ecc_stats.failed++;
+				ret = 0;
+			} else {
+				mtd->ecc_stats.corrected += ret;
+				max_bitflips = max_t(unsigned int,
+						     max_bitflips, ret);
+			}
+
+			ops->retlen += npages * nanddev_page_size(nand);
+			while (--npages)
+				nanddev_io_iter_next_page(nand, &iter);
+			continue;
+		}
+
+		/* Whether the next page follows within the same eraseblock */
+		more = (iter.dataleft > iter.req.datalen ||
+			iter.oobleft > iter.req.ooblen) &&
+		       iter.req.pos.page + 1 <
+		       nanddev_pages_per_eraseblock(nand);
+
+		if (spinand->read_mode == SPINAND_READ_CACHE_SEQ &&
+		    (in_seq || more)) {
+			ret = spinand_read_page_seq(spinand, &iter.req, !in_seq,
+						    !more, enable_ecc);
+			in_seq = more;
+		} else {
+			ret = spinand_read_page(spinand, &iter.req, enable_ecc);
+		}
 		if (ret < 0 && ret != -EBADMSG)
 			break;
 
@@ -601,6 +766,12 @@ static int spinand_mtd_read(struct mtd_info *mtd, loff_t from,
 		ops->oobretlen += iter.req.ooblen;
 	}
 
+	/* Leave the cache read sequence if it was aborted */
+	if (in_seq && ret < 0) {
+		spinand_read_cache_seq_op(spinand, true);
+		spinand_wait(spinand, NULL);
+	}
+
 #ifndef __UBOOT__
 	mutex_unlock(&spinand->lock);
 #endif
@@ -610,6 +781,50 @@ static int spinand_mtd_read(struct mtd_info *mtd, loff_t from,
 	return ret ? ret : max_bitflips;
 }
 
+/**
+ * spinand_mtd_set_read_mode() - Select how a SPI NAND reads consecutive pages
+ * @mtd: MTD device or partition of a SPI NAND
+ * @mode: the read mode to use
+ *
+ * By default the fastest mode the chip supports is used. This allows to
+ * compare the modes.
+ *
+ * Return: the previous read mode, -ENODEV if @mtd is not a SPI NAND, or
+ *	   -ENOTSUPP if the chip does not support @mode.
+ */
+int spinand_mtd_set_read_mode(struct mtd_info *mtd,
+			      enum spinand_read_mode mode)
+{
+	struct spinand_device *spinand;
+	enum spinand_read_mode old;
+
+	while (mtd->parent)
+		mtd = mtd->parent;
+	if (mtd->_read_oob != spinand_mtd_read)
+		return -ENODEV;
+
+	spinand = mtd_to_spinand(mtd);
+	switch (mode) {
+	case SPINAND_READ_PAGE:
+		break;
+	case SPINAND_READ_CACHE_SEQ:
+		if (!(spinand->flags & SPINAND_HAS_READ_CACHE_SEQ))
+			return -ENOTSUPP;
+		break;
+	case SPINAND_READ_CONT:
+		if (!spinand->set_cont_read)
+			return -ENOTSUPP;
+		break;
+	default:
+		return -EINVAL;
+	}
+
+	old = spinand->read_mode;
+	spinand->read_mode = mode;
+
+	return old;
+}
+
 static int spinand_mtd_write(struct mtd_info *mtd, loff_t to,
 			     struct mtd_oob_ops *ops)
 {
@@ -958,6 +1173,18 @@ int spinand_match_and_init(struct spinand_device *spinand,
 					       info->op_variants.update_cache);
 		spinand->op_templates.update_cache = op;
 
+		/* Without a usable op, pages are read one at a time */
+		spinand->set_cont_read = NULL;
+		spinand->op_templates.cont_read = NULL;
+		if (info->set_cont_read && info->cont_read_variants) {
+			op = spinand_select_op_variant(spinand,
+						       info->cont_read_variants);
+			if (op) {
+				spinand->set_cont_read = info->set_cont_read;
+				spinand->op_templates.cont_read = op;
+			}
+		}
+
 		return 0;
 	}
 
@@ -1079,6 +1306,13 @@ static int spinand_init(struct spinand_device *spinand)
 		goto err_free_bufs;
 	}
 
+	if (spinand->set_cont_read)
+		spinand->read_mode = SPINAND_READ_CONT;
+	else if (spinand->flags & SPINAND_HAS_READ_CACHE_SEQ)
+		spinand->read_mode = SPINAND_READ_CACHE_SEQ;
+	else
+		spinand->read_mode = SPINAND_READ_PAGE;
+
 	/* After power up, all blocks are locked, so unlock them here. */
 	for (i = 0; i < nand->memorg.ntargets; i++) {
 		ret = spinand_select_target(spinand, i);
@@ -1241,6 +1475,22 @@ module_spi_mem_driver(spinand_drv);
 MODULE_DESCRIPTION("SPI NAND framework");
 MODULE_AUTHOR("Peter Pan<peterpandong@micron.com>");
 MODULE_LICENSE("GPL v2");
+#else
+static int spinand_remove(struct udevice *dev)
+{
+	struct spinand_device *spinand = dev_get_priv(dev);
+	struct mtd_info *mtd = dev_get_uclass_priv(dev);
+	int ret;
+
+	ret = del_mtd_device(mtd);
+	if (ret)
+		return ret;
+
+	free(mtd->name);
+	spinand_cleanup(spinand);
+
+	return 0;
+}
 #endif /* __UBOOT__ */
 
 static const struct udevice_id spinand_ids[] = {
@@ -1254,4 +1504,5 @@ U_BOOT_DRIVER(spinand) = {
 	.of_match = spinand_ids,
 	.priv_auto_alloc_size = sizeof(struct spinand_device),
 	.probe = spinand_probe,
+	.remove = spinand_remove,
 };
@@ -0,0 +1,247 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Emulation of a Winbond W25N01GV SPI NAND for sandbox
+ *
+ * The main area of each page holds a fixed pattern (see
+ * sandbox_spinand_data()) and the spare area is erased, so every block is
+ * good. Program and erase operations are accepted but have no effect.
+ *
+ * Both buffer read mode and continuous read mode are emulated. The dummy
+ * bytes of a read are checked as the chip would see them: if the host sends
+ * the wrong number of address and dummy bytes, the data comes out shifted.
+ */
+
+#include <common.h>
+#include <dm.h>
+#include <spi.h>
+#include <asm/test.h>
+#include <linux/mtd/spinand.h>
+
+enum {
+	SANDBOX_SPINAND_PAGE_SIZE	= 2048,
+	SANDBOX_SPINAND_PAGES		= 64 * 1024,
+	SANDBOX_SPINAND_CMD_MAX		= 8,
+
+	SANDBOX_SPINAND_CFG_BUF		= BIT(3),
+};
+
+static const u8 sandbox_spinand_id[] = { 0x00, 0xef, 0xaa, 0x21 };
+
+/**
+ * struct sandbox_spinand - state of the emulated SPI NAND
+ *
+ * @cmd: Opcode, address and dummy bytes of the current operation
+ * @cmd_len: Number of bytes in @cmd
+ * @pos: Number of data bytes transferred so far in the current operation
+ * @page: Page loaded into the cache by the last PAGE READ
+ * @prot: Protection register
+ * @cfg: Configuration register
+ */
+struct sandbox_spinand {
+	u8 cmd[SANDBOX_SPINAND_CMD_MAX];
+	int cmd_len;
+	uint pos;
+	uint page;
+	u8 prot;
+	u8 cfg;
+};
+
+u8 sandbox_spinand_data(uint page, uint col)
+{
+	return col + (col >> 8) + page * 3;
+}
+
+static void sandbox_spinand_reset(struct sandbox_spinand *priv)
+{
+	priv->prot = 0x7c;
+	priv->cfg = SANDBOX_SPINAND_CFG_BUF | CFG_ECC_ENABLE;
+	priv->page = 0;
+}
+
+/* Get a byte of the data stream of a read from the cache */
+static u8 sandbox_spinand_read_byte(struct sandbox_spinand *priv, int pos)
+{
+	uint col, page;
+
+	if (pos < 0)
+		return 0xff;	/* still in the dummy bytes */
+
+	if (!(priv->cfg & SANDBOX_SPINAND_CFG_BUF)) {
+		/* The main area of one page after another, from column 0 */
+		page = priv->page + pos / SANDBOX_SPINAND_PAGE_SIZE;
+		col = pos % SANDBOX_SPINAND_PAGE_SIZE;
+		if (page >= SANDBOX_SPINAND_PAGES)
+			return 0xff;
+
+		return sandbox_spinand_data(page, col);
+	}
+
+	/* The cache holds one page, from the column given in the op */
+	col = ((priv->cmd[1] << 8 | priv->cmd[2]) & 0xfff) + pos;
+	if (col >= SANDBOX_SPINAND_PAGE_SIZE)
+		return 0xff;
+
+	return sandbox_spinand_data(priv->page, col);
+}
+
+/* Get the number of bytes the chip takes before it outputs data */
+static int sandbox_spinand_read_cmd_len(struct sandbox_spinand *priv)
+{
+	bool buf = priv->cfg & SANDBOX_SPINAND_CFG_BUF;
+
+	switch (priv->cmd[0]) {
+	case 0x03:
+		/* column address and a dummy byte, or three dummy bytes */
+		return 1 + 3;
+	case 0x0b:
+	case 0x3b:
+	case 0x6b:
+		return 1 + (buf ? 3 : 4);
+	default:
+		return -1;
+	}
+}
+
+/* Start a new operation, given its opcode, address and dummy bytes */
+static int sandbox_spinand_start(struct udevice *dev, const u8 *dout,
+				 uint bytes)
+{
+	struct sandbox_spinand *priv = dev_get_priv(dev);
+
+	if (!dout || !bytes || bytes > SANDBOX_SPINAND_CMD_MAX)
+		return -EPROTO;
+	memcpy(priv->cmd, dout, bytes);
+	priv->cmd_len = bytes;
+	priv->pos = 0;
+
+	switch (priv->cmd[0]) {
+	case 0xff:
+		sandbox_spinand_reset(priv);
+		break;
+	case 0x13:
+		if (bytes != 4)
+			return -EPROTO;
+		priv->page = (priv->cmd[1] << 16 | priv->cmd[2] << 8 |
+			      priv->cmd[3]) % SANDBOX_SPINAND_PAGES;
+		break;
+	case 0x03:
+	case 0x0b:
+	case 0x3b:
+	case 0x6b:
+	case 0x0f:
+	case 0x1f:
+	case 0x9f:
+		break;
+	case 0x02:
+	case 0x04:
+	case 0x06:
+	case 0x10:
+	case 0x84:
+	case 0xd8:
+		/* Writing is not supported, so ignore these */
+		break;
+	default:
+		log_debug("%s: unknown opcode %02x\n", dev->name,
+			  priv->cmd[0]);
+		return -EPROTONOSUPPORT;
+	}
+
+	return 0;
+}
+
+/* Transfer the data of the current operation */
+static int sandbox_spinand_data_xfer(struct udevice *dev, const u8 *dout,
+				     u8 *din, uint bytes)
+{
+	struct sandbox_spinand *priv = dev_get_priv(dev);
+	int shift;
+	uint i;
+
+	switch (priv->cmd[0]) {
+	case 0x9f:
+		for (i = 0; din && i < bytes; i++) {
+			uint pos = priv->pos + i;
+
+			din[i] = pos < sizeof(sandbox_spinand_id) ?
+				sandbox_spinand_id[pos] : 0;
+		}
+		break;
+	case 0x0f:
+		for (i = 0; din && i < bytes; i++) {
+			switch (priv->cmd[1]) {
+			case REG_BLOCK_LOCK:
+				din[i] = priv->prot;
+				break;
+			case REG_CFG:
+				din[i] = priv->cfg;
+				break;
+			default:
+				/* Never busy, no ECC errors */
+				din[i] = 0;
+				break;
+			}
+		}
+		break;
+	case 0x1f:
+		if (!dout || !bytes)
+			return -EPROTO;
+		if (priv->cmd[1] == REG_BLOCK_LOCK)
+			priv->prot = dout[0];
+		else if (priv->cmd[1] == REG_CFG)
+			priv->cfg = dout[0];
+		break;
+	case 0x03:
+	case 0x0b:
+	case 0x3b:
+	case 0x6b:
+		shift = priv->cmd_len - sandbox_spinand_read_cmd_len(priv);
+		for (i = 0; din && i < bytes; i++)
+			din[i] = sandbox_spinand_read_byte(priv,
+							   priv->pos + i +
+							   shift);
+		break;
+	default:
+		if (din)
+			memset(din, 0xff, bytes);
+		break;
+	}
+	priv->pos += bytes;
+
+	return 0;
+}
+
+static int sandbox_spinand_xfer(struct udevice *dev, unsigned int bitlen,
+				const void *dout, void *din,
+				unsigned long flags)
+{
+	uint bytes = bitlen / 8;
+
+	/* The first transfer holds the opcode, address and dummy bytes */
+	if (flags & SPI_XFER_BEGIN) {
+		if (din)
+			memset(din, 0xff, bytes);
+
+		return sandbox_spinand_start(dev, dout, bytes);
+	}
+
+	return sandbox_spinand_data_xfer(dev, dout, din, bytes);
+}
+
+static int sandbox_spinand_probe(struct udevice *dev)
+{
+	sandbox_spinand_reset(dev_get_priv(dev));
+
+	return 0;
+}
+
+static const struct dm_spi_emul_ops sandbox_spinand_emul_ops = {
+	.xfer	= sandbox_spinand_xfer,
+};
+
+U_BOOT_DRIVER(sandbox_spinand_emul) = {
+	.name		= "sandbox_spinand_emul",
+	.id		= UCLASS_SPI_EMUL,
+	.probe		= sandbox_spinand_probe,
+	.priv_auto_alloc_size = sizeof(struct sandbox_spinand),
+	.ops		= &sandbox_spinand_emul_ops,
+};
@@ -26,6 +26,23 @@ static SPINAND_OP_VARIANTS(read_cache_variants,
 		SPINAND_PAGE_READ_FROM_CACHE_OP(true, 0, 1, NULL, 0),
 		SPINAND_PAGE_READ_FROM_CACHE_OP(false, 0, 1, NULL, 0));
 
+/*
+ * In continuous read mode (BUF = 0) the read-from-cache ops take no column
+ * address. The stream starts at column 0 after 3 dummy bytes for Read or 4
+ * for the Fast Read ops.
+ */
+#define WINBOND_CONT_READ_OP(opcode, ndummy, buswidth)			\
+	SPI_MEM_OP(SPI_MEM_OP_CMD(opcode, 1),				\
+		   SPI_MEM_OP_NO_ADDR,					\
+		   SPI_MEM_OP_DUMMY(ndummy, 1),				\
+		   SPI_MEM_OP_DATA_IN(0, NULL, buswidth))
+
+static SPINAND_OP_VARIANTS(cont_read_variants,
+		WINBOND_CONT_READ_OP(0x6b, 4, 4),
+		WINBOND_CONT_READ_OP(0x3b, 4, 2),
+		WINBOND_CONT_READ_OP(0x0b, 4, 1),
+		WINBOND_CONT_READ_OP(0x03, 3, 1));
+
 static SPINAND_OP_VARIANTS(write_cache_variants,
 		SPINAND_PROG_LOAD_X4(true, 0, NULL, 0),
 		SPINAND_PROG_LOAD(true, 0, NULL, 0));
@@ -77,6 +94,13 @@ static int w25m02gv_select_target(struct spinand_device *spinand,
 	return spi_mem_exec_op(spinand->slave, &op);
 }
 
+static int w25n01gv_set_cont_read(struct spinand_device *spinand, bool enable)
+{
+	/* Continuous read mode is buffer read mode disabled */
+	return spinand_upd_cfg(spinand, WINBOND_CFG_BUF_READ,
+			       enable ? 0 : WINBOND_CFG_BUF_READ);
+}
+
 static const struct spinand_info winbond_spinand_table[] = {
 	SPINAND_INFO("W25M02GV", 0xAB,
 		     NAND_MEMORG(1, 2048, 64, 64, 1024, 1, 1, 2),
@@ -86,7 +110,9 @@ static const struct spinand_info winbond_spinand_table[] = {
 					      &update_cache_variants),
 		     0,
 		     SPINAND_ECCINFO(&w25m02gv_ooblayout, NULL),
-		     SPINAND_SELECT_TARGET(w25m02gv_select_target)),
+		     SPINAND_SELECT_TARGET(w25m02gv_select_target)
+		     SPINAND_CONT_READ(w25n01gv_set_cont_read,
+				       &cont_read_variants)),
 	SPINAND_INFO("W25N01GV", 0xAA,
 		     NAND_MEMORG(1, 2048, 64, 64, 1024, 1, 1, 1),
 		     NAND_ECCREQ(1, 512),
@@ -94,7 +120,9 @@ static const struct spinand_info winbond_spinand_table[] = {
 					      &write_cache_variants,
 					      &update_cache_variants),
 		     0,
-		     SPINAND_ECCINFO(&w25m02gv_ooblayout, NULL)),
+		     SPINAND_ECCINFO(&w25m02gv_ooblayout, NULL),
+		     SPINAND_CONT_READ(w25n01gv_set_cont_read,
+				       &cont_read_variants)),
 };
 
 /**
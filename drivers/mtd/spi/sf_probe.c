@@ -155,6 +155,8 @@ static int spi_flash_std_remove(struct udevice *dev)
 #if CONFIG_IS_ENABLED(SPI_FLASH_MTD)
 	spi_flash_mtd_unregister();
 #endif
+	spi_nor_remove(dev_get_uclass_priv(dev));
+
 	return 0;
 }
 
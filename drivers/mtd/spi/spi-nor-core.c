@@ -17,6 +17,7 @@
 #include <linux/log2.h>
 #include <linux/math64.h>
 #include <linux/sizes.h>
+#include <malloc.h>
 
 #include <linux/mtd/mtd.h>
 #include <linux/mtd/spi-nor.h>
@@ -36,6 +37,15 @@
 
 #define DEFAULT_READY_WAIT_JIFFIES		(40UL * HZ)
 
+/*
+ * For full-chip erase, calibrated to a 2MB flash (M25P16); should be scaled up
+ * for larger flash
+ */
+#define CHIP_ERASE_2MB_READY_WAIT_JIFFIES	(40UL * HZ)
+
+/* Size of the reads used to check whether a sector is blank */
+#define SPI_NOR_BLANK_CHUNK			SZ_4K
+
 static int spi_nor_read_write_reg(struct spi_nor *nor, struct spi_mem_op
 		*op, void *buf)
 {
@@ -72,26 +82,96 @@ static int spi_nor_write_reg(struct spi_nor *nor, u8 opcode, u8 *buf, int len)
 	return spi_nor_read_write_reg(nor, &op, buf);
 }
 
+static void spi_nor_read_op(struct spi_nor *nor, struct spi_mem_op *op,
+			    loff_t from, size_t len, u_char *buf)
+{
+	*op = (struct spi_mem_op)
+		SPI_MEM_OP(SPI_MEM_OP_CMD(nor->read_opcode, 1),
+			   SPI_MEM_OP_ADDR(nor->addr_width, from, 1),
+			   SPI_MEM_OP_DUMMY(nor->read_dummy, 1),
+			   SPI_MEM_OP_DATA_IN(len, buf, 1));
+
+	/* get transfer protocols. */
+	op->cmd.buswidth = spi_nor_get_protocol_inst_nbits(nor->read_proto);
+	op->addr.buswidth = spi_nor_get_protocol_addr_nbits(nor->read_proto);
+	op->dummy.buswidth = op->addr.buswidth;
+	op->data.buswidth = spi_nor_get_protocol_data_nbits(nor->read_proto);
+
+	/* convert the dummy cycles to the number of bytes */
+	op->dummy.nbytes = (nor->read_dummy * op->dummy.buswidth) / 8;
+}
+
+#if CONFIG_IS_ENABLED(SPI_DIRMAP)
+static ssize_t spi_nor_dirmap_read(struct spi_nor *nor, loff_t from,
+				   size_t len, u_char *buf)
+{
+	size_t remaining = len;
+	ssize_t ret;
+
+	while (remaining) {
+		ret = spi_mem_dirmap_read(nor->dirmap.rdesc, from, remaining,
+					  buf);
+		if (ret < 0)
+			return ret;
+		if (!ret)
+			return -EIO;
+
+		from += ret;
+		remaining -= ret;
+		buf += ret;
+	}
+
+	return len;
+}
+
+/*
+ * Set up a direct mapping of the flash for reads. Controllers which can map
+ * the flash into the address space or read it by DMA use that, the others
+ * fall back to regular spi-mem operations, so a failure here is not fatal.
+ */
+static void spi_nor_create_read_dirmap(struct spi_nor *nor)
+{
+	struct spi_mem_dirmap_info info = {
+		.offset = 0,
+		.length = nor->mtd.size,
+	};
+	struct spi_mem_dirmap_desc *desc;
+
+	/* Reads above 16MiB go through the bank address register */
+	if (nor->addr_width == 3 && nor->mtd.size > SZ_16M)
+		return;
+
+	spi_nor_read_op(nor, &info.op_tmpl, 0, 0, NULL);
+	desc = spi_mem_dirmap_create(nor->spi, &info);
+	if (IS_ERR(desc)) {
+		debug("SF: no read dirmap: %ld\n", PTR_ERR(desc));
+		return;
+	}
+	nor->dirmap.rdesc = desc;
+}
+#endif
+
+void spi_nor_remove(struct spi_nor *nor)
+{
+#if CONFIG_IS_ENABLED(SPI_DIRMAP)
+	spi_mem_dirmap_destroy(nor->dirmap.rdesc);
+	nor->dirmap.rdesc = NULL;
+#endif
+}
+
 static ssize_t spi_nor_read_data(struct spi_nor *nor, loff_t from, size_t len,
 				 u_char *buf)
 {
-	struct spi_mem_op op =
-			SPI_MEM_OP(SPI_MEM_OP_CMD(nor->read_opcode, 1),
-				   SPI_MEM_OP_ADDR(nor->addr_width, from, 1),
-				   SPI_MEM_OP_DUMMY(nor->read_dummy, 1),
-				   SPI_MEM_OP_DATA_IN(len, buf, 1));
+	struct spi_mem_op op;
 	size_t remaining = len;
 	int ret;
 
-	/* get transfer protocols. */
-	op.cmd.buswidth = spi_nor_get_protocol_inst_nbits(nor->read_proto);
-	op.addr.buswidth = spi_nor_get_protocol_addr_nbits(nor->read_proto);
-	op.dummy.buswidth = op.addr.buswidth;
-	op.data.buswidth = spi_nor_get_protocol_data_nbits(nor->read_proto);
-
-	/* convert the dummy cycles to the number of bytes */
-	op.dummy.nbytes = (nor->read_dummy * op.dummy.buswidth) / 8;
+#if CONFIG_IS_ENABLED(SPI_DIRMAP)
+	if (nor->dirmap.rdesc)
+		return spi_nor_dirmap_read(nor, from, len, buf);
+#endif
 
+	spi_nor_read_op(nor, &op, from, len, buf);
 	while (remaining) {
 		op.data.nbytes = remaining < UINT_MAX ? remaining : UINT_MAX;
 		ret = spi_mem_adjust_op_size(nor->spi, &op);
@@ -294,6 +374,8 @@ static u8 spi_nor_convert_3to4_erase(u8 opcode)
 static void spi_nor_set_4byte_opcodes(struct spi_nor *nor,
 				      const struct flash_info *info)
 {
+	int i;
+
 	/* Do some manufacturer fixups first */
 	switch (JEDEC_MFR(info)) {
 	case SNOR_MFR_SPANSION:
@@ -309,6 +391,16 @@ static void spi_nor_set_4byte_opcodes(struct spi_nor *nor,
 	nor->read_opcode = spi_nor_convert_3to4_read(nor->read_opcode);
 	nor->program_opcode = spi_nor_convert_3to4_program(nor->program_opcode);
 	nor->erase_opcode = spi_nor_convert_3to4_erase(nor->erase_opcode);
+
+	/* Drop the larger erase types which have no 4-byte op code */
+	for (i = 0; i < SNOR_ERASE_TYPE_MAX; i++) {
+		struct spi_nor_erase_type *erase = &nor->erase_types[i];
+		u8 opcode = spi_nor_convert_3to4_erase(erase->opcode);
+
+		if (opcode == erase->opcode || erase->size <= nor->mtd.erasesize)
+			erase->size = 0;
+		erase->opcode = opcode;
+	}
 }
 #endif /* !CONFIG_SPI_FLASH_BAR */
 
@@ -445,6 +537,37 @@ static int spi_nor_wait_till_ready(struct spi_nor *nor)
 						    DEFAULT_READY_WAIT_JIFFIES);
 }
 
+/*
+ * Wait for a page program to complete. Where only the WIP bit of the status
+ * register has to be checked, let the SPI controller poll it, which it may
+ * do in hardware without going through the driver for each read.
+ */
+static int spi_nor_wait_program(struct spi_nor *nor)
+{
+#if CONFIG_IS_ENABLED(DM_SPI)
+	u8 sr;
+	struct spi_mem_op op = SPI_MEM_OP(SPI_MEM_OP_CMD(SPINOR_OP_RDSR, 1),
+					  SPI_MEM_OP_NO_ADDR,
+					  SPI_MEM_OP_NO_DUMMY,
+					  SPI_MEM_OP_DATA_IN(1, &sr, 1));
+
+	if (!(nor->flags & (SNOR_F_USE_FSR | SNOR_F_USE_CLSR |
+			    SNOR_F_READY_XSR_RDY)) &&
+	    nor->read_reg == spi_nor_read_reg) {
+		int ret = spi_mem_poll_status(nor->spi, &op, SR_WIP, 0, 0, 0,
+					      DEFAULT_READY_WAIT_JIFFIES * 1000 /
+					      HZ);
+
+		if (ret == -ETIMEDOUT)
+			dev_err(nor->dev, "flash operation timed out\n");
+
+		return ret;
+	}
+#endif
+
+	return spi_nor_wait_till_ready(nor);
+}
+
 #ifdef CONFIG_SPI_FLASH_BAR
 /*
  * This "clean_bar" is necessary in a situation when one was accessing
@@ -519,12 +642,26 @@ static int read_bar(struct spi_nor *nor, const struct flash_info *info)
 #endif
 
 /*
- * Initiate the erasure of a single sector
+ * Initiate the erasure of the whole chip
+ */
+static int spi_nor_erase_chip(struct spi_nor *nor)
+{
+	struct spi_mem_op op =
+		SPI_MEM_OP(SPI_MEM_OP_CMD(SPINOR_OP_CHIP_ERASE, 1),
+			   SPI_MEM_OP_NO_ADDR,
+			   SPI_MEM_OP_NO_DUMMY,
+			   SPI_MEM_OP_NO_DATA);
+
+	return spi_mem_exec_op(nor->spi, &op);
+}
+
+/*
+ * Initiate the erasure of a single sector or block, using @opcode
  */
-static int spi_nor_erase_sector(struct spi_nor *nor, u32 addr)
+static int spi_nor_erase_sector(struct spi_nor *nor, u8 opcode, u32 addr)
 {
 	struct spi_mem_op op =
-		SPI_MEM_OP(SPI_MEM_OP_CMD(nor->erase_opcode, 1),
+		SPI_MEM_OP(SPI_MEM_OP_CMD(opcode, 1),
 			   SPI_MEM_OP_ADDR(nor->addr_width, addr, 1),
 			   SPI_MEM_OP_NO_DUMMY,
 			   SPI_MEM_OP_NO_DATA);
@@ -539,15 +676,74 @@ static int spi_nor_erase_sector(struct spi_nor *nor, u32 addr)
 	return spi_mem_exec_op(nor->spi, &op);
 }
 
+/*
+ * Select the largest erase type which starts at @addr and does not go past
+ * @len. Returns its size and sets *@opcode.
+ */
+static u32 spi_nor_select_erase_type(struct spi_nor *nor, u32 addr, u32 len,
+				     u8 *opcode)
+{
+	int i;
+
+	/* Hardware specific erase only knows about the erase size */
+	for (i = 0; !nor->erase && i < SNOR_ERASE_TYPE_MAX; i++) {
+		const struct spi_nor_erase_type *erase = &nor->erase_types[i];
+
+		if (erase->size && erase->size <= len &&
+		    !(addr % erase->size)) {
+			*opcode = erase->opcode;
+			return erase->size;
+		}
+	}
+	*opcode = nor->erase_opcode;
+
+	return nor->mtd.erasesize;
+}
+
+/*
+ * Check whether an area of the flash is blank, using @buf to read it.
+ * Returns 1 if so, 0 if not, or a negative error.
+ */
+static int spi_nor_is_blank(struct spi_nor *nor, u32 addr, u32 len,
+			    u_char *buf)
+{
+	ssize_t ret, i;
+
+	while (len) {
+		ret = nor->read(nor, addr, min_t(u32, len, SPI_NOR_BLANK_CHUNK),
+				buf);
+		if (ret <= 0)
+			return ret ? ret : -EIO;
+		for (i = 0; i < ret; i++) {
+			if (buf[i] != 0xff)
+				return 0;
+		}
+		addr += ret;
+		len -= ret;
+	}
+
+	return 1;
+}
+
 /*
  * Erase an address range on the nor chip.  The address range may extend
  * one or more erase sectors.  Return an error is there is a problem erasing.
+ *
+ * Each step erases the largest block which is aligned and fits in what is
+ * left of the range, and the whole chip at once when possible. With
+ * CONFIG_SPI_FLASH_ERASE_SKIP_BLANK, blocks which are already blank are
+ * skipped.
  */
 static int spi_nor_erase(struct mtd_info *mtd, struct erase_info *instr)
 {
 	struct spi_nor *nor = mtd_to_spi_nor(mtd);
-	u32 addr, len, rem;
-	int ret;
+	struct spi_nor_erase_stats *stats = &nor->erase_stats;
+	ulong start = get_timer(0);
+	u_char *blank_buf = NULL;
+	u32 addr, len, rem, size;
+	bool blank = false;
+	u8 opcode;
+	int ret = 0;
 
 	dev_dbg(nor->dev, "at 0x%llx, len %lld\n", (long long)instr->addr,
 		(long long)instr->len);
@@ -562,31 +758,73 @@ static int spi_nor_erase(struct mtd_info *mtd, struct erase_info *instr)
 	addr = instr->addr;
 	len = instr->len;
 
+	if (IS_ENABLED(CONFIG_SPI_FLASH_ERASE_SKIP_BLANK)) {
+		blank_buf = malloc(SPI_NOR_BLANK_CHUNK);
+	} else if (!addr && len == mtd->size && !nor->erase &&
+		   !(nor->flags & SNOR_F_NO_OP_CHIP_ERASE)) {
+		unsigned long timeout;
+
+		write_enable(nor);
+		ret = spi_nor_erase_chip(nor);
+		if (ret)
+			goto erase_err;
+
+		timeout = max(CHIP_ERASE_2MB_READY_WAIT_JIFFIES *
+			      (unsigned long)(mtd->size / SZ_2M),
+			      DEFAULT_READY_WAIT_JIFFIES);
+		ret = spi_nor_wait_till_ready_with_timeout(nor, timeout);
+		if (ret)
+			goto erase_err;
+
+		stats->erased += len;
+		stats->ops++;
+		goto erase_err;
+	}
+
 	while (len) {
 #ifdef CONFIG_SPI_FLASH_BAR
 		ret = write_bar(nor, addr);
 		if (ret < 0)
-			return ret;
+			goto erase_err;
 #endif
-		write_enable(nor);
+		size = spi_nor_select_erase_type(nor, addr, len, &opcode);
+		if (blank_buf) {
+			ret = spi_nor_is_blank(nor, addr, size, blank_buf);
+			if (ret < 0)
+				goto erase_err;
+			blank = ret;
+		}
 
-		ret = spi_nor_erase_sector(nor, addr);
-		if (ret)
-			goto erase_err;
+		if (blank) {
+			stats->skipped += size;
+			stats->skipped_ops++;
+		} else {
+			write_enable(nor);
 
-		addr += mtd->erasesize;
-		len -= mtd->erasesize;
+			ret = spi_nor_erase_sector(nor, opcode, addr);
+			if (ret)
+				goto erase_err;
 
-		ret = spi_nor_wait_till_ready(nor);
-		if (ret)
-			goto erase_err;
+			ret = spi_nor_wait_till_ready(nor);
+			if (ret)
+				goto erase_err;
+
+			stats->erased += size;
+			stats->ops++;
+		}
+
+		addr += size;
+		len -= size;
 	}
+	ret = 0;
 
 erase_err:
 #ifdef CONFIG_SPI_FLASH_BAR
 	ret = clean_bar(nor);
 #endif
 	write_disable(nor);
+	free(blank_buf);
+	stats->time += get_timer(start);
 
 	return ret;
 }
@@ -1261,6 +1499,17 @@ static int spi_nor_write(struct mtd_info *mtd, loff_t to, size_t len,
 		page_remain = min_t(size_t,
 				    nor->page_size - page_offset, len - i);
 
+		/*
+		 * Programming 0xff leaves the flash unchanged, so skip such
+		 * pages, as found in the padding of firmware images.
+		 */
+		if (!memchr_inv(buf + i, 0xff, page_remain)) {
+			*retlen += page_remain;
+			i += page_remain;
+			ret = 0;
+			continue;
+		}
+
 #ifdef CONFIG_SPI_FLASH_BAR
 		ret = write_bar(nor, addr);
 		if (ret < 0)
@@ -1272,7 +1521,7 @@ static int spi_nor_write(struct mtd_info *mtd, loff_t to, size_t len,
 			goto write_err;
 		written = ret;
 
-		ret = spi_nor_wait_till_ready(nor);
+		ret = spi_nor_wait_program(nor);
 		if (ret)
 			goto write_err;
 		*retlen += written;
@@ -1502,6 +1751,7 @@ struct spi_nor_flash_parameter {
 	struct spi_nor_hwcaps		hwcaps;
 	struct spi_nor_read_command	reads[SNOR_CMD_READ_MAX];
 	struct spi_nor_pp_command	page_programs[SNOR_CMD_PP_MAX];
+	struct spi_nor_erase_type	erase_types[SNOR_ERASE_TYPE_MAX];
 
 	int (*quad_enable)(struct spi_nor *nor);
 };
@@ -1915,6 +2165,7 @@ static int spi_nor_parse_bfpt(struct spi_nor *nor,
 	}
 
 	/* Sector Erase settings. */
+	memset(params->erase_types, '\0', sizeof(params->erase_types));
 	for (i = 0; i < ARRAY_SIZE(sfdp_bfpt_erases); i++) {
 		const struct sfdp_bfpt_erase *er = &sfdp_bfpt_erases[i];
 		u32 erasesize;
@@ -1929,11 +2180,15 @@ static int spi_nor_parse_bfpt(struct spi_nor *nor,
 
 		erasesize = 1U << erasesize;
 		opcode = (half >> 8) & 0xff;
+		params->erase_types[i].size = erasesize;
+		params->erase_types[i].opcode = opcode;
 #ifdef CONFIG_SPI_FLASH_USE_4K_SECTORS
+		if (mtd->erasesize == SZ_4K)
+			continue;
 		if (erasesize == SZ_4K) {
 			nor->erase_opcode = opcode;
 			mtd->erasesize = erasesize;
-			break;
+			continue;
 		}
 #endif
 		if (!mtd->erasesize || mtd->erasesize < erasesize) {
@@ -2187,6 +2442,10 @@ static int spi_nor_init_params(struct spi_nor *nor,
 	spi_nor_set_pp_settings(&params->page_programs[SNOR_CMD_PP],
 				SPINOR_OP_PP, SNOR_PROTO_1_1_1);
 
+	/* Sector Erase settings. */
+	params->erase_types[0].size = info->sector_size;
+	params->erase_types[0].opcode = SPINOR_OP_SE;
+
 	if (info->flags & SPI_NOR_QUAD_READ) {
 		params->hwcaps.mask |= SNOR_HWCAPS_PP_1_1_4;
 		spi_nor_set_pp_settings(&params->page_programs[SNOR_CMD_PP_1_1_4],
@@ -2338,13 +2597,15 @@ static int spi_nor_select_pp(struct spi_nor *nor,
 }
 
 static int spi_nor_select_erase(struct spi_nor *nor,
-				const struct flash_info *info)
+				const struct flash_info *info,
+				const struct spi_nor_flash_parameter *params)
 {
 	struct mtd_info *mtd = &nor->mtd;
+	int i, j, n = 0;
 
-	/* Do nothing if already configured from SFDP. */
+	/* Keep the erase size if already configured from SFDP. */
 	if (mtd->erasesize)
-		return 0;
+		goto erase_types;
 
 #ifdef CONFIG_SPI_FLASH_USE_4K_SECTORS
 	/* prefer "small sector" erase if possible */
@@ -2360,6 +2621,25 @@ static int spi_nor_select_erase(struct spi_nor *nor,
 		nor->erase_opcode = SPINOR_OP_SE;
 		mtd->erasesize = info->sector_size;
 	}
+
+erase_types:
+	/*
+	 * Keep the larger erase types which are a multiple of the erase size,
+	 * sorted from the largest to the smallest.
+	 */
+	memset(nor->erase_types, '\0', sizeof(nor->erase_types));
+	for (i = 0; i < SNOR_ERASE_TYPE_MAX; i++) {
+		const struct spi_nor_erase_type *erase = &params->erase_types[i];
+
+		if (erase->size <= mtd->erasesize ||
+		    erase->size % mtd->erasesize)
+			continue;
+		for (j = n; j && nor->erase_types[j - 1].size < erase->size; j--)
+			nor->erase_types[j] = nor->erase_types[j - 1];
+		nor->erase_types[j] = *erase;
+		n++;
+	}
+
 	return 0;
 }
 
@@ -2406,7 +2686,7 @@ static int spi_nor_setup(struct spi_nor *nor, const struct flash_info *info,
 	}
 
 	/* Select the Sector Erase command. */
-	err = spi_nor_select_erase(nor, info);
+	err = spi_nor_select_erase(nor, info, params);
 	if (err) {
 		dev_dbg(nor->dev,
 			"can't select erase settings supported by both the SPI controller and memory.\n");
@@ -2622,6 +2902,10 @@ int spi_nor_scan(struct spi_nor *nor)
 	if (ret)
 		return ret;
 
+#if CONFIG_IS_ENABLED(SPI_DIRMAP)
+	spi_nor_create_read_dirmap(nor);
+#endif
+
 	nor->name = mtd->name;
 	nor->size = mtd->size;
 	nor->erase_size = mtd->erasesize;
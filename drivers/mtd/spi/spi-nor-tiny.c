@@ -71,26 +71,96 @@ static int spi_nor_write_reg(struct spi_nor *nor, u8 opcode, u8 *buf, int len)
 	return spi_nor_read_write_reg(nor, &op, buf);
 }
 
+static void spi_nor_read_op(struct spi_nor *nor, struct spi_mem_op *op,
+			    loff_t from, size_t len, u_char *buf)
+{
+	*op = (struct spi_mem_op)
+		SPI_MEM_OP(SPI_MEM_OP_CMD(nor->read_opcode, 1),
+			   SPI_MEM_OP_ADDR(nor->addr_width, from, 1),
+			   SPI_MEM_OP_DUMMY(nor->read_dummy, 1),
+			   SPI_MEM_OP_DATA_IN(len, buf, 1));
+
+	/* get transfer protocols. */
+	op->cmd.buswidth = spi_nor_get_protocol_inst_nbits(nor->read_proto);
+	op->addr.buswidth = spi_nor_get_protocol_addr_nbits(nor->read_proto);
+	op->dummy.buswidth = op->addr.buswidth;
+	op->data.buswidth = spi_nor_get_protocol_data_nbits(nor->read_proto);
+
+	/* convert the dummy cycles to the number of bytes */
+	op->dummy.nbytes = (nor->read_dummy * op->dummy.buswidth) / 8;
+}
+
+#if CONFIG_IS_ENABLED(SPI_DIRMAP)
+static ssize_t spi_nor_dirmap_read(struct spi_nor *nor, loff_t from,
+				   size_t len, u_char *buf)
+{
+	size_t remaining = len;
+	ssize_t ret;
+
+	while (remaining) {
+		ret = spi_mem_dirmap_read(nor->dirmap.rdesc, from, remaining,
+					  buf);
+		if (ret < 0)
+			return ret;
+		if (!ret)
+			return -EIO;
+
+		from += ret;
+		remaining -= ret;
+		buf += ret;
+	}
+
+	return len;
+}
+
+/*
+ * Set up a direct mapping of the flash for reads. Controllers which can map
+ * the flash into the address space or read it by DMA use that, the others
+ * fall back to regular spi-mem operations, so a failure here is not fatal.
+ */
+static void spi_nor_create_read_dirmap(struct spi_nor *nor)
+{
+	struct spi_mem_dirmap_info info = {
+		.offset = 0,
+		.length = nor->mtd.size,
+	};
+	struct spi_mem_dirmap_desc *desc;
+
+	/* Reads above 16MiB go through the bank address register */
+	if (nor->addr_width == 3 && nor->mtd.size > SZ_16M)
+		return;
+
+	spi_nor_read_op(nor, &info.op_tmpl, 0, 0, NULL);
+	desc = spi_mem_dirmap_create(nor->spi, &info);
+	if (IS_ERR(desc)) {
+		debug("SF: no read dirmap: %ld\n", PTR_ERR(desc));
+		return;
+	}
+	nor->dirmap.rdesc = desc;
+}
+#endif
+
+void spi_nor_remove(struct spi_nor *nor)
+{
+#if CONFIG_IS_ENABLED(SPI_DIRMAP)
+	spi_mem_dirmap_destroy(nor->dirmap.rdesc);
+	nor->dirmap.rdesc = NULL;
+#endif
+}
+
 static ssize_t spi_nor_read_data(struct spi_nor *nor, loff_t from, size_t len,
 				 u_char *buf)
 {
-	struct spi_mem_op op =
-			SPI_MEM_OP(SPI_MEM_OP_CMD(nor->read_opcode, 1),
-				   SPI_MEM_OP_ADDR(nor->addr_width, from, 1),
-				   SPI_MEM_OP_DUMMY(nor->read_dummy, 1),
-				   SPI_MEM_OP_DATA_IN(len, buf, 1));
+	struct spi_mem_op op;
 	size_t remaining = len;
 	int ret;
 
-	/* get transfer protocols. */
-	op.cmd.buswidth = spi_nor_get_protocol_inst_nbits(nor->read_proto);
-	op.addr.buswidth = spi_nor_get_protocol_addr_nbits(nor->read_proto);
-	op.dummy.buswidth = op.addr.buswidth;
-	op.data.buswidth = spi_nor_get_protocol_data_nbits(nor->read_proto);
-
-	/* convert the dummy cycles to the number of bytes */
-	op.dummy.nbytes = (nor->read_dummy * op.dummy.buswidth) / 8;
+#if CONFIG_IS_ENABLED(SPI_DIRMAP)
+	if (nor->dirmap.rdesc)
+		return spi_nor_dirmap_read(nor, from, len, buf);
+#endif
 
+	spi_nor_read_op(nor, &op, from, len, buf);
 	while (remaining) {
 		op.data.nbytes = remaining < UINT_MAX ? remaining : UINT_MAX;
 		ret = spi_mem_adjust_op_size(nor->spi, &op);
@@ -795,6 +865,10 @@ int spi_nor_scan(struct spi_nor *nor)
 	if (ret)
 		return ret;
 
+#if CONFIG_IS_ENABLED(SPI_DIRMAP)
+	spi_nor_create_read_dirmap(nor);
+#endif
+
 	return 0;
 }
 
@@ -394,6 +394,35 @@ static int ns16550_serial_putc(struct udevice *dev, const char ch)
 	return 0;
 }
 
+/*
+ * With the FIFO enabled, THRE means that the whole TX FIFO is empty. All
+ * 16550-compatible UARTs have room for at least 16 characters.
+ */
+#define NS16550_TX_FIFO_SIZE	16
+
+static ssize_t ns16550_serial_puts(struct udevice *dev, const char *s,
+				   size_t len)
+{
+	struct NS16550 *const com_port = dev_get_priv(dev);
+	size_t count, i;
+
+	if (!(serial_in(&com_port->lsr) & UART_LSR_THRE))
+		return -EAGAIN;
+
+	count = 1;
+	if (ns16550_getfcr(com_port) & UART_FCR_FIFO_EN)
+		count = NS16550_TX_FIFO_SIZE;
+	count = min(count, len);
+	for (i = 0; i < count; i++)
+		serial_out(s[i], &com_port->thr);
+
+	/* See the comment in ns16550_serial_putc() */
+	if (memchr(s, '\n', count))
+		WATCHDOG_RESET();
+
+	return count;
+}
+
 static int ns16550_serial_pending(struct udevice *dev, bool input)
 {
 	struct NS16550 *const com_port = dev_get_priv(dev);
@@ -575,6 +604,7 @@ int ns16550_serial_ofdata_to_platdata(struct udevice *dev)
 
 const struct dm_serial_ops ns16550_serial_ops = {
 	.putc = ns16550_serial_putc,
+	.puts = ns16550_serial_puts,
 	.pending = ns16550_serial_pending,
 	.getc = ns16550_serial_getc,
 	.setbrg = ns16550_serial_setbrg,
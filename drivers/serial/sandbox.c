@@ -41,8 +41,18 @@ struct sandbox_serial_platdata {
 	int colour;	/* Text colour to use for output, -1 for none */
 };
 
+/**
+ * struct sandbox_serial_priv - Private data for this driver
+ *
+ * @start_of_line: true if the next character starts a new line
+ * @tx_space: Number of characters the emulated UART takes before it is busy,
+ *	or -1 if it is never busy (used by tests)
+ * @tx_count: Number of characters written
+ */
 struct sandbox_serial_priv {
 	bool start_of_line;
+	int tx_space;
+	ulong tx_count;
 };
 
 /**
@@ -71,6 +81,7 @@ static int sandbox_serial_probe(struct udevice *dev)
 	if (state->term_raw != STATE_TERM_COOKED)
 		os_tty_raw(0, state->term_raw == STATE_TERM_RAW_WITH_SIGS);
 	priv->start_of_line = 0;
+	priv->tx_space = -1;
 
 	if (state->term_raw != STATE_TERM_RAW)
 		disable_ctrlc(1);
@@ -93,6 +104,8 @@ static int sandbox_serial_putc(struct udevice *dev, const char ch)
 	struct sandbox_serial_priv *priv = dev_get_priv(dev);
 	struct sandbox_serial_platdata *plat = dev->platdata;
 
+	if (!priv->tx_space)
+		return -EAGAIN;
 	if (priv->start_of_line && plat->colour != -1) {
 		priv->start_of_line = false;
 		output_ansi_colour(plat->colour);
@@ -101,10 +114,61 @@ static int sandbox_serial_putc(struct udevice *dev, const char ch)
 	os_write(1, &ch, 1);
 	if (ch == '\n')
 		priv->start_of_line = true;
+	if (priv->tx_space > 0)
+		priv->tx_space--;
+	priv->tx_count++;
 
 	return 0;
 }
 
+static ssize_t sandbox_serial_puts(struct udevice *dev, const char *s,
+				   size_t len)
+{
+	struct sandbox_serial_priv *priv = dev_get_priv(dev);
+	struct sandbox_serial_platdata *plat = dev->platdata;
+	const char *newline;
+	ssize_t ret;
+
+	if (!priv->tx_space)
+		return -EAGAIN;
+	if (priv->tx_space > 0)
+		len = min_t(size_t, len, priv->tx_space);
+
+	/* Write up to the end of the line, so the next one gets its colour */
+	newline = memchr(s, '\n', len);
+	if (newline)
+		len = newline - s + 1;
+	if (priv->start_of_line && plat->colour != -1) {
+		priv->start_of_line = false;
+		output_ansi_colour(plat->colour);
+	}
+
+	ret = os_write(1, s, len);
+	if (ret < 0)
+		return ret;
+	if (ret && s[ret - 1] == '\n')
+		priv->start_of_line = true;
+	if (priv->tx_space > 0)
+		priv->tx_space -= ret;
+	priv->tx_count += ret;
+
+	return ret;
+}
+
+void sandbox_serial_set_tx_space(struct udevice *dev, int space)
+{
+	struct sandbox_serial_priv *priv = dev_get_priv(dev);
+
+	priv->tx_space = space;
+}
+
+ulong sandbox_serial_get_tx_count(struct udevice *dev)
+{
+	struct sandbox_serial_priv *priv = dev_get_priv(dev);
+
+	return priv->tx_count;
+}
+
 static unsigned int increment_buffer_index(unsigned int index)
 {
 	return (index + 1) % ARRAY_SIZE(serial_buf);
@@ -239,6 +303,7 @@ static int sandbox_serial_ofdata_to_platdata(struct udevice *dev)
 
 static const struct dm_serial_ops sandbox_serial_ops = {
 	.putc = sandbox_serial_putc,
+	.puts = sandbox_serial_puts,
 	.pending = sandbox_serial_pending,
 	.getc = sandbox_serial_getc,
 	.getconfig = sandbox_serial_getconfig,
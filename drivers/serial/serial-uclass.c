@@ -15,6 +15,7 @@
 #include <dm/lists.h>
 #include <dm/device-internal.h>
 #include <dm/of_access.h>
+#include <dm/uclass-internal.h>
 
 DECLARE_GLOBAL_DATA_PTR;
 
@@ -173,23 +174,174 @@ void serial_initialize(void)
 	serial_init();
 }
 
-static void _serial_putc(struct udevice *dev, char ch)
+/*
+ * Write as much of a string as the UART takes without waiting. Returns the
+ * number of characters written.
+ */
+static size_t serial_write_nowait(struct udevice *dev, const char *str,
+				  size_t len)
 {
 	struct dm_serial_ops *ops = serial_get_ops(dev);
+	ssize_t count;
 	int err;
 
+	if (ops->puts) {
+		count = ops->puts(dev, str, len);
+		if (count == -EAGAIN)
+			return 0;
+
+		/* Drop the characters on other errors, like putc() below */
+		return count < 0 ? len : count;
+	}
+
+	for (count = 0; count < len; count++) {
+		err = ops->putc(dev, str[count]);
+		if (err == -EAGAIN)
+			break;
+	}
+
+	return count;
+}
+
+static void serial_write(struct udevice *dev, const char *str, size_t len)
+{
+	size_t count;
+
+	while (len) {
+		count = serial_write_nowait(dev, str, len);
+		str += count;
+		len -= count;
+	}
+}
+
+#if CONFIG_IS_ENABLED(SERIAL_TX_BUFFER)
+#define TX_SIZE		CONFIG_SERIAL_TX_BUFFER_SIZE
+
+/* Send as much of the TX buffer as the UART takes without waiting */
+static void serial_tx_drain(struct udevice *dev)
+{
+	struct serial_dev_priv *upriv = dev_get_uclass_priv(dev);
+	uint rd, len;
+	size_t count;
+
+	while (upriv->tx_rd_ptr != upriv->tx_wr_ptr) {
+		rd = upriv->tx_rd_ptr % TX_SIZE;
+		len = min(upriv->tx_wr_ptr - upriv->tx_rd_ptr, TX_SIZE - rd);
+		count = serial_write_nowait(dev, upriv->tx_buf + rd, len);
+		if (!count)
+			break;
+		upriv->tx_rd_ptr += count;
+	}
+}
+
+/* Send all of the TX buffer and write directly to the UART until resumed */
+static void serial_tx_stop(struct udevice *dev)
+{
+	struct serial_dev_priv *upriv = dev_get_uclass_priv(dev);
+
+	if (!upriv->tx_buf)
+		return;
+	while (upriv->tx_rd_ptr != upriv->tx_wr_ptr)
+		serial_tx_drain(dev);
+	upriv->tx_stopped = true;
+}
+
+/* Add a string to the TX buffer, waiting only if the buffer is full */
+static void serial_tx_queue(struct udevice *dev, const char *str, size_t len)
+{
+	struct serial_dev_priv *upriv = dev_get_uclass_priv(dev);
+	uint wr, count;
+
+	while (len) {
+		serial_tx_drain(dev);
+		count = TX_SIZE - (upriv->tx_wr_ptr - upriv->tx_rd_ptr);
+		if (!count)
+			continue;
+		wr = upriv->tx_wr_ptr % TX_SIZE;
+		count = min3(count, (uint)len, TX_SIZE - wr);
+		memcpy(upriv->tx_buf + wr, str, count);
+		upriv->tx_wr_ptr += count;
+		str += count;
+		len -= count;
+	}
+	serial_tx_drain(dev);
+}
+
+void serial_flush(void)
+{
+	struct udevice *dev;
+
+	for (uclass_find_first_device(UCLASS_SERIAL, &dev);
+	     dev;
+	     uclass_find_next_device(&dev)) {
+		if (device_active(dev))
+			serial_tx_stop(dev);
+	}
+}
+
+void serial_resume_buffer(void)
+{
+	struct serial_dev_priv *upriv;
+	struct udevice *dev;
+
+	for (uclass_find_first_device(UCLASS_SERIAL, &dev);
+	     dev;
+	     uclass_find_next_device(&dev)) {
+		if (device_active(dev)) {
+			upriv = dev_get_uclass_priv(dev);
+			upriv->tx_stopped = false;
+		}
+	}
+}
+#endif /* CONFIG_IS_ENABLED(SERIAL_TX_BUFFER) */
+
+static void serial_out(struct udevice *dev, const char *str, size_t len)
+{
+#if CONFIG_IS_ENABLED(SERIAL_TX_BUFFER)
+	struct serial_dev_priv *upriv = dev_get_uclass_priv(dev);
+
+	if (upriv->tx_buf && !upriv->tx_stopped) {
+		serial_tx_queue(dev, str, len);
+		return;
+	}
+#endif
+	serial_write(dev, str, len);
+}
+
+static void _serial_putc(struct udevice *dev, char ch)
+{
 	if (ch == '\n')
 		_serial_putc(dev, '\r');
 
-	do {
-		err = ops->putc(dev, ch);
-	} while (err == -EAGAIN);
+	serial_out(dev, &ch, 1);
 }
 
 static void _serial_puts(struct udevice *dev, const char *str)
 {
-	while (*str)
-		_serial_putc(dev, *str++);
+	const char *newline;
+	size_t len;
+
+	while (*str) {
+		newline = strchrnul(str, '\n');
+		len = newline - str;
+		if (len)
+			serial_out(dev, str, len);
+		if (!*newline)
+			break;
+		serial_out(dev, "\r\n", 2);
+		str = newline + 1;
+	}
+}
+
+/* Send any buffered output while the console is being polled */
+static void serial_poll_tx(struct udevice *dev)
+{
+#if CONFIG_IS_ENABLED(SERIAL_TX_BUFFER)
+	struct serial_dev_priv *upriv = dev_get_uclass_priv(dev);
+
+	if (upriv->tx_buf)
+		serial_tx_drain(dev);
+#endif
 }
 
 static int __serial_getc(struct udevice *dev)
@@ -199,8 +351,10 @@ static int __serial_getc(struct udevice *dev)
 
 	do {
 		err = ops->getc(dev);
-		if (err == -EAGAIN)
+		if (err == -EAGAIN) {
+			serial_poll_tx(dev);
 			WATCHDOG_RESET();
+		}
 	} while (err == -EAGAIN);
 
 	return err >= 0 ? err : 0;
@@ -210,6 +364,7 @@ static int __serial_tstc(struct udevice *dev)
 {
 	struct dm_serial_ops *ops = serial_get_ops(dev);
 
+	serial_poll_tx(dev);
 	if (ops->pending)
 		return ops->pending(dev, true);
 
@@ -429,8 +584,10 @@ U_BOOT_ENV_CALLBACK(baudrate, on_baudrate);
 static int serial_post_probe(struct udevice *dev)
 {
 	struct dm_serial_ops *ops = serial_get_ops(dev);
-#ifdef CONFIG_DM_STDIO
+#if defined(CONFIG_DM_STDIO) || CONFIG_IS_ENABLED(SERIAL_TX_BUFFER)
 	struct serial_dev_priv *upriv = dev_get_uclass_priv(dev);
+#endif
+#ifdef CONFIG_DM_STDIO
 	struct stdio_dev sdev;
 #endif
 	int ret;
@@ -442,6 +599,8 @@ static int serial_post_probe(struct udevice *dev)
 		ops->getc += gd->reloc_off;
 	if (ops->putc)
 		ops->putc += gd->reloc_off;
+	if (ops->puts)
+		ops->puts += gd->reloc_off;
 	if (ops->pending)
 		ops->pending += gd->reloc_off;
 	if (ops->clear)
@@ -464,6 +623,12 @@ static int serial_post_probe(struct udevice *dev)
 			return ret;
 	}
 
+#if CONFIG_IS_ENABLED(SERIAL_TX_BUFFER)
+	/* Allocate the TX buffer once the full malloc() pool is available */
+	if (gd->flags & GD_FLG_RELOC)
+		upriv->tx_buf = malloc(TX_SIZE);
+#endif
+
 #ifdef CONFIG_DM_STDIO
 	if (!(gd->flags & GD_FLG_RELOC))
 		return 0;
@@ -489,12 +654,20 @@ static int serial_post_probe(struct udevice *dev)
 
 static int serial_pre_remove(struct udevice *dev)
 {
-#if CONFIG_IS_ENABLED(SYS_STDIO_DEREGISTER)
+#if CONFIG_IS_ENABLED(SYS_STDIO_DEREGISTER) || \
+	CONFIG_IS_ENABLED(SERIAL_TX_BUFFER)
 	struct serial_dev_priv *upriv = dev_get_uclass_priv(dev);
+#endif
 
+#if CONFIG_IS_ENABLED(SYS_STDIO_DEREGISTER)
 	if (stdio_deregister_dev(upriv->sdev, true))
 		return -EPERM;
 #endif
+#if CONFIG_IS_ENABLED(SERIAL_TX_BUFFER)
+	serial_tx_stop(dev);
+	free(upriv->tx_buf);
+	upriv->tx_buf = NULL;
+#endif
 
 	return 0;
 }
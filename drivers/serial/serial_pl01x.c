@@ -312,6 +312,21 @@ int pl01x_serial_putc(struct udevice *dev, const char ch)
 	return pl01x_putc(priv->regs, ch);
 }
 
+static ssize_t pl01x_serial_puts(struct udevice *dev, const char *s,
+				 size_t len)
+{
+	struct pl01x_priv *priv = dev_get_priv(dev);
+	size_t count;
+
+	/* Fill the FIFO until it is full */
+	for (count = 0; count < len; count++) {
+		if (pl01x_putc(priv->regs, s[count]) == -EAGAIN)
+			break;
+	}
+
+	return count;
+}
+
 int pl01x_serial_pending(struct udevice *dev, bool input)
 {
 	struct pl01x_priv *priv = dev_get_priv(dev);
@@ -325,6 +340,7 @@ int pl01x_serial_pending(struct udevice *dev, bool input)
 
 static const struct dm_serial_ops pl01x_serial_ops = {
 	.putc = pl01x_serial_putc,
+	.puts = pl01x_serial_puts,
 	.pending = pl01x_serial_pending,
 	.getc = pl01x_serial_getc,
 	.setbrg = pl01x_serial_setbrg,
@@ -350,6 +350,45 @@ static int ti_qspi_exec_mem_op(struct spi_slave *slave,
 	return ret;
 }
 
+#if CONFIG_IS_ENABLED(SPI_DIRMAP)
+static int ti_qspi_dirmap_create(struct spi_mem_dirmap_desc *desc)
+{
+	struct ti_qspi_priv *priv = dev_get_priv(desc->slave->dev->parent);
+	const struct spi_mem_op *op = &desc->info.op_tmpl;
+
+	/* Only reads which fit in the MMIO window can use it */
+	if (op->data.dir != SPI_MEM_DATA_IN || op->addr.nbytes > 4 ||
+	    desc->info.offset + desc->info.length > priv->mmap_size)
+		return -EOPNOTSUPP;
+
+	return 0;
+}
+
+static ssize_t ti_qspi_dirmap_read(struct spi_mem_dirmap_desc *desc,
+				   u64 offs, size_t len, void *buf)
+{
+	struct dm_spi_slave_platdata *slave_plat;
+	const struct spi_mem_op *op = &desc->info.op_tmpl;
+	struct ti_qspi_priv *priv;
+
+	priv = dev_get_priv(desc->slave->dev->parent);
+	slave_plat = dev_get_parent_platdata(desc->slave->dev);
+
+	if (offs >= desc->info.length)
+		return -EINVAL;
+	len = min_t(u64, len, desc->info.length - offs);
+
+	/* The setup register is cleared when the bus is released */
+	ti_qspi_setup_mmap_read(priv, slave_plat->cs, op->cmd.opcode,
+				op->data.buswidth, op->addr.nbytes,
+				op->dummy.nbytes);
+	ti_qspi_copy_mmap(buf, priv->memory_map + desc->info.offset + offs,
+			  len);
+
+	return len;
+}
+#endif
+
 static int ti_qspi_claim_bus(struct udevice *dev)
 {
 	struct dm_spi_slave_platdata *slave_plat = dev_get_parent_platdata(dev);
@@ -479,6 +518,10 @@ static int ti_qspi_ofdata_to_platdata(struct udevice *bus)
 
 static const struct spi_controller_mem_ops ti_qspi_mem_ops = {
 	.exec_op = ti_qspi_exec_mem_op,
+#if CONFIG_IS_ENABLED(SPI_DIRMAP)
+	.dirmap_create = ti_qspi_dirmap_create,
+	.dirmap_read = ti_qspi_dirmap_read,
+#endif
 };
 
 static const struct dm_spi_ops ti_qspi_ops = {
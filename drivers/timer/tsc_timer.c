@@ -11,6 +11,7 @@
 #include <malloc.h>
 #include <time.h>
 #include <timer.h>
+#include <trace.h>
 #include <asm/cpu.h>
 #include <asm/io.h>
 #include <asm/i8254.h>
@@ -472,6 +473,18 @@ u64 notrace timer_early_get_count(void)
 	return rdtsc() - gd->arch.tsc_base;
 }
 
+#ifdef CONFIG_TRACE_TIMESTAMP_COUNTER
+uint64_t notrace trace_get_timestamp(void)
+{
+	return rdtsc();
+}
+
+ulong notrace trace_get_timestamp_rate(void)
+{
+	return get_tbclk();
+}
+#endif
+
 static const struct timer_ops tsc_timer_ops = {
 	.get_count = tsc_timer_get_count,
 };
@@ -86,6 +86,29 @@ struct pos_info {
 	int ypos;
 };
 
+/**
+ * struct tt_glyph - A rendered character in the glyph cache
+ *
+ * @data:	8-bit-per-pixel image of the character, or NULL if it is blank
+ * @x_shift:	Fraction of a pixel the character was rendered at
+ * @ch:		Character
+ * @width:	Width of @data in pixels
+ * @height:	Height of @data in pixels
+ * @xoff:	X offset of @data from the cursor position
+ * @yoff:	Y offset of @data from the baseline
+ * @last_use:	Value of the cache's use counter when last drawn
+ */
+struct tt_glyph {
+	u8 *data;
+	double x_shift;
+	int ch;
+	int width;
+	int height;
+	int xoff;
+	int yoff;
+	uint last_use;
+};
+
 /*
  * Allow one for each character on the command line plus one for each newline.
  * This is just an estimate, but it should not be exceeded.
@@ -111,6 +134,13 @@ struct pos_info {
  * @scale:	Scale of the font. This is calculated from the pixel height
  *		of the font. It is used by the STB library to generate images
  *		of the correct size.
+ * @cache:	Glyph cache (CONFIG_CONSOLE_TRUETYPE_CACHE entries), or NULL
+ * @cache_count:	Number of glyphs in the cache
+ * @cache_use:	Counter incremented for each character drawn, used to find
+ *		the least-recently used glyph
+ * @cache_bytes:	Memory used by the glyph images in the cache
+ * @cache_hits:	Number of characters drawn from the cache
+ * @cache_misses:	Number of characters rendered
  */
 struct console_tt_priv {
 	int font_size;
@@ -120,6 +150,12 @@ struct console_tt_priv {
 	int pos_ptr;
 	int baseline;
 	double scale;
+	struct tt_glyph *cache;
+	int cache_count;
+	uint cache_use;
+	ulong cache_bytes;
+	ulong cache_hits;
+	ulong cache_misses;
 };
 
 static int console_truetype_set_row(struct udevice *dev, uint row, int clr)
@@ -162,6 +198,8 @@ static int console_truetype_set_row(struct udevice *dev, uint row, int clr)
 	default:
 		return -ENOSYS;
 	}
+	video_damage(dev->parent, 0, row * priv->font_size, vid_priv->xsize,
+		     priv->font_size);
 
 	return 0;
 }
@@ -178,6 +216,8 @@ static int console_truetype_move_rows(struct udevice *dev, uint rowdst,
 	dst = vid_priv->fb + rowdst * priv->font_size * vid_priv->line_length;
 	src = vid_priv->fb + rowsrc * priv->font_size * vid_priv->line_length;
 	memmove(dst, src, priv->font_size * vid_priv->line_length * count);
+	video_damage(dev->parent, 0, rowdst * priv->font_size, vid_priv->xsize,
+		     count * priv->font_size);
 
 	/* Scroll up our position history */
 	diff = (rowsrc - rowdst) * priv->font_size;
@@ -187,6 +227,133 @@ static int console_truetype_move_rows(struct udevice *dev, uint rowdst,
 	return 0;
 }
 
+/* Render a character into @glyph */
+static void console_truetype_render(struct console_tt_priv *priv,
+				    struct tt_glyph *glyph, int ch,
+				    double x_shift)
+{
+	glyph->data = stbtt_GetCodepointBitmapSubpixel(&priv->font,
+			priv->scale, priv->scale, x_shift, 0, ch,
+			&glyph->width, &glyph->height, &glyph->xoff,
+			&glyph->yoff);
+	glyph->ch = ch;
+	glyph->x_shift = x_shift;
+}
+
+/**
+ * console_truetype_get_glyph() - Get a rendered character from the cache
+ *
+ * If the character is not in the cache it is rendered, replacing the
+ * least-recently used glyph if the cache is full.
+ *
+ * @priv:	Private data for the console
+ * @ch:		Character to get
+ * @x_shift:	Fraction of a pixel to render it at
+ * @return glyph
+ */
+static struct tt_glyph *console_truetype_get_glyph(struct console_tt_priv *priv,
+						   int ch, double x_shift)
+{
+	struct tt_glyph *glyph, *lru = NULL;
+	int i;
+
+	priv->cache_use++;
+	for (i = 0; i < priv->cache_count; i++) {
+		glyph = &priv->cache[i];
+		if (glyph->ch == ch && glyph->x_shift == x_shift) {
+			glyph->last_use = priv->cache_use;
+			priv->cache_hits++;
+			return glyph;
+		}
+		if (!lru || (int)(glyph->last_use - lru->last_use) < 0)
+			lru = glyph;
+	}
+
+	priv->cache_misses++;
+	if (priv->cache_count < CONFIG_CONSOLE_TRUETYPE_CACHE) {
+		glyph = &priv->cache[priv->cache_count++];
+	} else {
+		glyph = lru;
+		priv->cache_bytes -= glyph->width * glyph->height;
+		free(glyph->data);
+	}
+	console_truetype_render(priv, glyph, ch, x_shift);
+	if (glyph->data)
+		priv->cache_bytes += glyph->width * glyph->height;
+	else
+		glyph->width = glyph->height = 0;
+	glyph->last_use = priv->cache_use;
+
+	return glyph;
+}
+
+static inline u16 tt_rgb565(uint val)
+{
+	return val >> 3 | (val >> 2) << 5 | (val >> 3) << 11;
+}
+
+/**
+ * console_truetype_blit() - Draw a rendered character
+ *
+ * This converts the 8bpp image into the colour depth of the display. We only
+ * expect white-on-black or the reverse so the code only handles this simple
+ * case: the image is inverted for a light background, then ORed into the
+ * frame buffer for a light foreground or ANDed for a dark one.
+ *
+ * @vid_priv:	Video device to draw on
+ * @line:	Start of the first frame buffer line to draw on, at the cursor
+ *		position
+ * @glyph:	Character to draw
+ * @return 0 if OK, -ENOSYS if the display depth is not supported
+ */
+static int console_truetype_blit(struct video_priv *vid_priv, void *line,
+				 const struct tt_glyph *glyph)
+{
+	const u8 *bits = glyph->data;
+	uint invert = vid_priv->colour_bg ? 0xff : 0;
+	bool set = vid_priv->colour_fg;
+	int row, i;
+
+	for (row = 0; row < glyph->height; row++) {
+		switch (vid_priv->bpix) {
+#ifdef CONFIG_VIDEO_BPP16
+		case VIDEO_BPP16: {
+			u16 *dst = (u16 *)line + glyph->xoff;
+
+			if (set) {
+				for (i = 0; i < glyph->width; i++)
+					dst[i] |= tt_rgb565(bits[i] ^ invert);
+			} else {
+				for (i = 0; i < glyph->width; i++)
+					dst[i] &= tt_rgb565(bits[i] ^ invert);
+			}
+			break;
+		}
+#endif
+#ifdef CONFIG_VIDEO_BPP32
+		case VIDEO_BPP32: {
+			u32 *dst = (u32 *)line + glyph->xoff;
+
+			if (set) {
+				for (i = 0; i < glyph->width; i++)
+					dst[i] |= (bits[i] ^ invert) * 0x010101;
+			} else {
+				for (i = 0; i < glyph->width; i++)
+					dst[i] &= (bits[i] ^ invert) * 0x010101;
+			}
+			break;
+		}
+#endif
+		default:
+			return -ENOSYS;
+		}
+		bits += glyph->width;
+		line += vid_priv->line_length;
+	}
+
+	return 0;
+}
+
 static int console_truetype_putc_xy(struct udevice *dev, uint x, uint y,
 				    char ch)
 {
@@ -195,15 +362,14 @@ static int console_truetype_putc_xy(struct udevice *dev, uint x, uint y,
 	struct video_priv *vid_priv = dev_get_uclass_priv(vid);
 	struct console_tt_priv *priv = dev_get_priv(dev);
 	stbtt_fontinfo *font = &priv->font;
-	int width, height, xoff, yoff;
+	struct tt_glyph *glyph, tmp;
 	double xpos, x_shift;
 	int lsb;
 	int width_frac, linenum;
 	struct pos_info *pos;
-	u8 *bits, *data;
 	int advance;
 	void *line;
-	int row;
+	int ret;
 
 	/* First get some basic metrics about this character */
 	stbtt_GetCodepointHMetrics(font, ch, &advance, &lsb);
@@ -239,86 +405,39 @@ static int console_truetype_putc_xy(struct udevice *dev, uint x, uint y,
 	}
 
 	/*
-	 * Figure out how much past the start of a pixel we are, and pass this
-	 * information into the render, which will return a 8-bit-per-pixel
-	 * image of the character. For empty characters, like ' ', data will
-	 * return NULL;
+	 * Figure out how much past the start of a pixel we are, and get a
+	 * 8-bit-per-pixel image of the character rendered at that position,
+	 * from the cache if possible. For empty characters, like ' ', there
+	 * is no image.
 	 */
-	data = stbtt_GetCodepointBitmapSubpixel(font, priv->scale, priv->scale,
-						x_shift, 0, ch, &width, &height,
-						&xoff, &yoff);
-	if (!data)
+#if CONFIG_CONSOLE_TRUETYPE_SUBPIXELS
+	x_shift = (int)(x_shift * CONFIG_CONSOLE_TRUETYPE_SUBPIXELS);
+	x_shift /= CONFIG_CONSOLE_TRUETYPE_SUBPIXELS;
+#endif
+	if (priv->cache) {
+		glyph = console_truetype_get_glyph(priv, ch, x_shift);
+	} else {
+		glyph = &tmp;
+		console_truetype_render(priv, glyph, ch, x_shift);
+	}
+	if (!glyph->data)
 		return width_frac;
 
 	/* Figure out where to write the character in the frame buffer */
-	bits = data;
 	line = vid_priv->fb + y * vid_priv->line_length +
 		VID_TO_PIXEL(x) * VNBYTES(vid_priv->bpix);
-	linenum = priv->baseline + yoff;
+	linenum = priv->baseline + glyph->yoff;
 	if (linenum > 0)
 		line += linenum * vid_priv->line_length;
 
-	/*
-	 * Write a row at a time, converting the 8bpp image into the colour
-	 * depth of the display. We only expect white-on-black or the reverse
-	 * so the code only handles this simple case.
-	 */
-	for (row = 0; row < height; row++) {
-		switch (vid_priv->bpix) {
-#ifdef CONFIG_VIDEO_BPP16
-		case VIDEO_BPP16: {
-			uint16_t *dst = (uint16_t *)line + xoff;
-			int i;
-
-			for (i = 0; i < width; i++) {
-				int val = *bits;
-				int out;
-
-				if (vid_priv->colour_bg)
-					val = 255 - val;
-				out = val >> 3 |
-					(val >> 2) << 5 |
-					(val >> 3) << 11;
-				if (vid_priv->colour_fg)
-					*dst++ |= out;
-				else
-					*dst++ &= out;
-				bits++;
-			}
-			break;
-		}
-#endif
-#ifdef CONFIG_VIDEO_BPP32
-		case VIDEO_BPP32: {
-			u32 *dst = (u32 *)line + xoff;
-			int i;
-
-			for (i = 0; i < width; i++) {
-				int val = *bits;
-				int out;
-
-				if (vid_priv->colour_bg)
-					val = 255 - val;
-				out = val | val << 8 | val << 16;
-				if (vid_priv->colour_fg)
-					*dst++ |= out;
-				else
-					*dst++ &= out;
-				bits++;
-			}
-			break;
-		}
-#endif
-		default:
-			free(data);
-			return -ENOSYS;
-		}
-
-		line += vid_priv->line_length;
-	}
-	free(data);
+	ret = console_truetype_blit(vid_priv, line, glyph);
+	if (!ret)
+		video_damage(vid, VID_TO_PIXEL(x) + glyph->xoff,
+			     y + max(linenum, 0), glyph->width, glyph->height);
+	if (!priv->cache)
+		free(glyph->data);
 
-	return width_frac;
+	return ret ? ret : width_frac;
 }
 
 /**
@@ -379,6 +498,7 @@ static int console_truetype_erase(struct udevice *dev, int xstart, int ystart,
 		}
 		line += vid_priv->line_length;
 	}
+	video_damage(dev->parent, xstart, ystart, xend - xstart, yend - ystart);
 
 	return 0;
 }
@@ -432,6 +552,20 @@ static int console_truetype_backspace(struct udevice *dev)
 	return 0;
 }
 
+static int console_truetype_get_cache_stats(struct udevice *dev,
+					struct vidconsole_cache_stats *stats)
+{
+	struct console_tt_priv *priv = dev_get_priv(dev);
+
+	stats->hits = priv->cache_hits;
+	stats->misses = priv->cache_misses;
+	stats->entries = priv->cache_count;
+	stats->max_entries = priv->cache ? CONFIG_CONSOLE_TRUETYPE_CACHE : 0;
+	stats->bytes = priv->cache_bytes;
+
+	return 0;
+}
+
 static int console_truetype_entry_start(struct udevice *dev)
 {
 	struct console_tt_priv *priv = dev_get_priv(dev);
@@ -550,17 +684,37 @@ static int console_truetype_probe(struct udevice *dev)
 	priv->scale = stbtt_ScaleForPixelHeight(font, priv->font_size);
 	stbtt_GetFontVMetrics(font, &ascent, 0, 0);
 	priv->baseline = (int)(ascent * priv->scale);
+
+	if (CONFIG_CONSOLE_TRUETYPE_CACHE) {
+		priv->cache = calloc(CONFIG_CONSOLE_TRUETYPE_CACHE,
+				     sizeof(struct tt_glyph));
+		if (!priv->cache)
+			return -ENOMEM;
+	}
 	debug("%s: ready\n", __func__);
 
 	return 0;
 }
 
+static int console_truetype_remove(struct udevice *dev)
+{
+	struct console_tt_priv *priv = dev_get_priv(dev);
+	int i;
+
+	for (i = 0; i < priv->cache_count; i++)
+		free(priv->cache[i].data);
+	free(priv->cache);
+
+	return 0;
+}
+
 struct vidconsole_ops console_truetype_ops = {
 	.putc_xy	= console_truetype_putc_xy,
 	.move_rows	= console_truetype_move_rows,
 	.set_row	= console_truetype_set_row,
 	.backspace	= console_truetype_backspace,
 	.entry_start	= console_truetype_entry_start,
+	.get_cache_stats	= console_truetype_get_cache_stats,
 };
 
 U_BOOT_DRIVER(vidconsole_truetype) = {
@@ -568,5 +722,6 @@ U_BOOT_DRIVER(vidconsole_truetype) = {
 	.id	= UCLASS_VIDEO_CONSOLE,
 	.ops	= &console_truetype_ops,
 	.probe	= console_truetype_probe,
+	.remove	= console_truetype_remove,
 	.priv_auto_alloc_size	= sizeof(struct console_tt_priv),
 };
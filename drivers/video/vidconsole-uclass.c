@@ -56,6 +56,16 @@ int vidconsole_set_row(struct udevice *dev, uint row, int clr)
 	return ops->set_row(dev, row, clr);
 }
 
+int vidconsole_get_cache_stats(struct udevice *dev,
+			       struct vidconsole_cache_stats *stats)
+{
+	struct vidconsole_ops *ops = vidconsole_get_ops(dev);
+
+	if (!ops->get_cache_stats)
+		return -ENOSYS;
+	return ops->get_cache_stats(dev, stats);
+}
+
 static int vidconsole_entry_start(struct udevice *dev)
 {
 	struct vidconsole_ops *ops = vidconsole_get_ops(dev);
@@ -115,6 +115,7 @@ int video_clear(struct udevice *dev)
 		memset(priv->fb, priv->colour_bg, priv->fb_size);
 		break;
 	}
+	video_damage(dev, 0, 0, priv->xsize, priv->ysize);
 
 	return 0;
 }
@@ -145,30 +146,109 @@ void video_set_default_colors(struct udevice *dev, bool invert)
 	priv->colour_bg = vid_console_color(priv, back);
 }
 
+#ifdef CONFIG_VIDEO_DAMAGE
+void video_damage(struct udevice *vid, int x, int y, int width, int height)
+{
+	struct video_priv *priv = dev_get_uclass_priv(vid);
+	int xend = min(x + width, (int)priv->xsize);
+	int yend = min(y + height, (int)priv->ysize);
+
+	x = max(x, 0);
+	y = max(y, 0);
+	if (x >= xend || y >= yend)
+		return;
+
+	if (priv->damage.xstart < priv->damage.xend) {
+		priv->damage.xstart = min(priv->damage.xstart, x);
+		priv->damage.ystart = min(priv->damage.ystart, y);
+		priv->damage.xend = max(priv->damage.xend, xend);
+		priv->damage.yend = max(priv->damage.yend, yend);
+	} else {
+		priv->damage.xstart = x;
+		priv->damage.ystart = y;
+		priv->damage.xend = xend;
+		priv->damage.yend = yend;
+	}
+}
+#endif
+
+#if defined(CONFIG_ARM) && !CONFIG_IS_ENABLED(SYS_DCACHE_OFF)
+static void video_flush_range(ulong start, ulong end)
+{
+	flush_dcache_range(rounddown(start, CONFIG_SYS_CACHELINE_SIZE),
+			   ALIGN(end, CONFIG_SYS_CACHELINE_SIZE));
+}
+
+/* Flush the damaged part of the frame buffer, or all of it */
+static void video_flush_dcache(struct video_priv *priv)
+{
+	ulong fb = (ulong)priv->fb;
+#ifdef CONFIG_VIDEO_DAMAGE
+	ulong start, end;
+	int y;
+
+	if (priv->damage.xstart >= priv->damage.xend)
+		return;
+	start = (priv->damage.xstart << priv->bpix) / 8;
+	end = DIV_ROUND_UP(priv->damage.xend << priv->bpix, 8);
+
+	/*
+	 * Flush line by line if that saves much, e.g. when writing a few
+	 * characters; otherwise just flush the whole lines in one go.
+	 */
+	if ((end - start) * 2 < priv->line_length) {
+		for (y = priv->damage.ystart; y < priv->damage.yend; y++)
+			video_flush_range(fb + y * priv->line_length + start,
+					  fb + y * priv->line_length + end);
+	} else {
+		video_flush_range(fb + priv->damage.ystart * priv->line_length,
+				  fb + priv->damage.yend * priv->line_length);
+	}
+#else
+	video_flush_range(fb, fb + priv->fb_size);
+#endif
+}
+#endif
+
 /* Flush video activity to the caches */
 void video_sync(struct udevice *vid, bool force)
 {
+	struct video_ops *ops = video_get_ops(vid);
+	struct video_priv *priv = dev_get_uclass_priv(vid);
+	int ret;
+
+#ifdef CONFIG_VIDEO_DAMAGE
+	if (priv->fb_exposed)
+		video_damage(vid, 0, 0, priv->xsize, priv->ysize);
+#endif
+
 	/*
 	 * flush_dcache_range() is declared in common.h but it seems that some
 	 * architectures do not actually implement it. Is there a way to find
 	 * out whether it exists? For now, ARM is safe.
 	 */
 #if defined(CONFIG_ARM) && !CONFIG_IS_ENABLED(SYS_DCACHE_OFF)
-	struct video_priv *priv = dev_get_uclass_priv(vid);
-
-	if (priv->flush_dcache) {
-		flush_dcache_range((ulong)priv->fb,
-				   ALIGN((ulong)priv->fb + priv->fb_size,
-					 CONFIG_SYS_CACHELINE_SIZE));
-	}
+	if (priv->flush_dcache)
+		video_flush_dcache(priv);
 #elif defined(CONFIG_VIDEO_SANDBOX_SDL)
-	struct video_priv *priv = dev_get_uclass_priv(vid);
 	static ulong last_sync;
 
 	if (force || get_timer(last_sync) > 10) {
 		sandbox_sdl_sync(priv->fb);
 		last_sync = get_timer(0);
 	}
+#endif
+	if (ops && ops->video_sync) {
+		ret = ops->video_sync(vid);
+		if (ret)
+			debug("%s: Cannot sync '%s' (err=%d)\n", __func__,
+			      vid->name, ret);
+	}
+#ifdef CONFIG_VIDEO_DAMAGE
+	priv->damage.xstart = priv->xsize;
+	priv->damage.ystart = priv->ysize;
+	priv->damage.xend = 0;
+	priv->damage.yend = 0;
 #endif
 }
 
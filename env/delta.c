@@ -0,0 +1,275 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Environment change log
+ *
+ * Rather than rewriting the whole environment each time it is saved, the
+ * variables which changed are appended to a log. The log starts with a
+ * header naming (by its CRC) the environment copy it applies to, followed
+ * by records holding either "name=value" or just "name" for a deleted
+ * variable:
+ *
+ *	header | record | record | ... | (erased / stale data)
+ *
+ * Each record has a CRC seeded with the CRC of the header, so records left
+ * over from an earlier log (e.g. on MMC, which is not erased) are not
+ * taken for valid ones. Reading stops at the first invalid record.
+ *
+ * Once the log is full, the driver saves the whole environment as usual and
+ * starts a new log for it. As the header only matches the new environment
+ * copy, a power failure in between leaves either the old copy with its log
+ * or the new copy on its own.
+ *
+ * SPL only replays the log: the environment is not saved there, so no copy
+ * is kept to compare against.
+ */
+
+#include <common.h>
+#include <env.h>
+#include <env_internal.h>
+#include <malloc.h>
+#include <search.h>
+#include <errno.h>
+#include <u-boot/crc.h>
+
+#define ENV_DELTA_MAGIC		0x4c564e45	/* "ENVL" */
+
+struct env_delta_hdr {
+	u32 magic;
+	u32 base_crc;	/* CRC of the environment copy the log applies to */
+	u32 seq;	/* incremented each time the log is started afresh */
+	u32 crc;	/* CRC of the fields above */
+};
+
+struct env_delta_rec {
+	u32 crc;	/* CRC of len and data, seeded with the header CRC */
+	u32 len;	/* length of data, including the terminating NUL */
+	char data[];	/* "name=value" or "name", padded to 4 bytes */
+};
+
+#define REC_SIZE(len)	ALIGN(sizeof(struct env_delta_rec) + (len), 4)
+
+static struct {
+	struct env_delta_hdr hdr;
+	ulong pos;		/* offset for the next record, 0 if log unusable */
+	char *snapshot;		/* environment as it is stored, in export format */
+} env_delta_state;
+
+static u32 env_delta_hdr_crc(const struct env_delta_hdr *hdr)
+{
+	return crc32(0, (const u8 *)hdr, offsetof(struct env_delta_hdr, crc));
+}
+
+static u32 env_delta_rec_crc(const struct env_delta_rec *rec)
+{
+	return crc32(env_delta_state.hdr.crc, (const u8 *)&rec->len,
+		     sizeof(rec->len) + rec->len);
+}
+
+#ifndef CONFIG_SPL_BUILD
+/* Take a copy of the environment to compare against when saving */
+static int env_delta_snapshot(void)
+{
+	if (!env_delta_state.snapshot) {
+		env_delta_state.snapshot = malloc(ENV_SIZE);
+		if (!env_delta_state.snapshot)
+			return -ENOMEM;
+	}
+	if (hexport_r(&env_htab, '\0', 0, &env_delta_state.snapshot,
+		      ENV_SIZE, 0, NULL) < 0) {
+		free(env_delta_state.snapshot);
+		env_delta_state.snapshot = NULL;
+		return -ENOSPC;
+	}
+
+	return 0;
+}
+#endif
+
+void env_delta_load(struct env_delta *delta, const env_t *base)
+{
+	struct env_delta_hdr *hdr = &env_delta_state.hdr;
+	struct env_delta_rec *rec;
+	ulong pos, count = 0;
+	char *buf;
+	u32 crc;
+
+	env_delta_state.pos = 0;
+	buf = malloc(delta->size);
+	if (!buf || delta->read(delta, 0, delta->size, buf)) {
+		memset(hdr, '\0', sizeof(*hdr));
+		goto out;
+	}
+
+	memcpy(hdr, buf, sizeof(*hdr));
+	memcpy(&crc, &base->crc, sizeof(crc));
+	if (hdr->magic != ENV_DELTA_MAGIC || hdr->crc != env_delta_hdr_crc(hdr))
+		memset(hdr, '\0', sizeof(*hdr));
+	if (!hdr->magic || hdr->base_crc != crc) {
+		debug("env: change log does not match environment\n");
+		goto out;
+	}
+
+	for (pos = sizeof(*hdr); pos + sizeof(*rec) <= delta->size;
+	     pos += REC_SIZE(rec->len)) {
+		rec = (struct env_delta_rec *)(buf + pos);
+		if (!rec->len || rec->len > delta->size - pos - sizeof(*rec) ||
+		    rec->data[rec->len - 1] || rec->crc != env_delta_rec_crc(rec))
+			break;
+		himport_r(&env_htab, rec->data, rec->len, '\0',
+			  H_NOCLEAR | H_FORCE, 0, 0, NULL);
+		count++;
+	}
+	debug("env: applied %lu changes, log used %lu/%lu\n", count, pos,
+	      delta->size);
+
+	/*
+	 * Flash can only be written once erased: if a record was only
+	 * partly written, leave it alone and start a new log on next save.
+	 */
+	env_delta_state.pos = pos;
+	if (delta->erase && pos < delta->size) {
+		ulong i, end = min_t(ulong, pos + sizeof(*rec), delta->size);
+
+		for (i = pos; i < end; i++) {
+			if ((uchar)buf[i] != 0xff)
+				env_delta_state.pos = 0;
+		}
+	}
+
+#ifndef CONFIG_SPL_BUILD
+	if (env_delta_snapshot())
+		env_delta_state.pos = 0;
+#endif
+out:
+	free(buf);
+}
+
+#ifndef CONFIG_SPL_BUILD
+/* Compare the names of two exported "name=value" strings */
+static int env_delta_keycmp(const char *a, const char *b)
+{
+	for (; *a == *b; a++, b++) {
+		if (*a == '=')
+			return 0;
+	}
+
+	return (*a == '=' ? 0 : (uchar)*a) - (*b == '=' ? 0 : (uchar)*b);
+}
+
+/* Add a record to the buffer, returns its size or 0 if it does not fit */
+static ulong env_delta_add(char *buf, ulong space, const char *data,
+			   ulong len)
+{
+	struct env_delta_rec *rec = (struct env_delta_rec *)buf;
+	ulong size = REC_SIZE(len + 1);
+
+	if (size > space)
+		return 0;
+	memset(buf, '\0', size);
+	rec->len = len + 1;
+	memcpy(rec->data, data, len);
+	rec->crc = env_delta_rec_crc(rec);
+
+	return size;
+}
+
+int env_delta_save(struct env_delta *delta)
+{
+	ulong space, len = 0;
+	char *old, *new, *cur, *buf;
+	int ret;
+
+	if (!env_delta_state.pos || !env_delta_state.snapshot)
+		return -ENOSPC;
+
+	space = delta->size - env_delta_state.pos;
+	cur = malloc(ENV_SIZE);
+	buf = malloc(space);
+	if (!cur || !buf) {
+		ret = -ENOMEM;
+		goto out;
+	}
+	if (hexport_r(&env_htab, '\0', 0, &cur, ENV_SIZE, 0, NULL) < 0) {
+		ret = -ENOSPC;
+		goto out;
+	}
+
+	/* Both lists are sorted by name, so walk them side by side */
+	old = env_delta_state.snapshot;
+	new = cur;
+	while (*old || *new) {
+		int cmp = !*old ? 1 : !*new ? -1 : env_delta_keycmp(old, new);
+		const char *data = NULL;
+		ulong size;
+
+		if (cmp < 0) {		/* deleted */
+			data = old;
+			size = strchrnul(old, '=') - old;
+		} else if (cmp > 0 || strcmp(old, new)) { /* new / changed */
+			data = new;
+			size = strlen(new);
+		}
+		if (data) {
+			size = env_delta_add(buf + len, space - len, data, size);
+			if (!size) {
+				ret = -ENOSPC;
+				goto out;
+			}
+			len += size;
+		}
+		if (cmp <= 0)
+			old += strlen(old) + 1;
+		if (cmp >= 0)
+			new += strlen(new) + 1;
+	}
+
+	if (len) {
+		printf("Appending %lu bytes of changes... ", len);
+		ret = delta->write(delta, env_delta_state.pos, len, buf);
+		if (ret) {
+			/* The record may be partly written; start afresh */
+			env_delta_state.pos = 0;
+			goto out;
+		}
+		env_delta_state.pos += len;
+	}
+
+	free(env_delta_state.snapshot);
+	env_delta_state.snapshot = cur;
+	cur = NULL;
+	ret = 0;
+out:
+	free(buf);
+	free(cur);
+
+	return ret;
+}
+
+int env_delta_reset(struct env_delta *delta, const env_t *base)
+{
+	struct env_delta_hdr *hdr = &env_delta_state.hdr;
+	int ret;
+
+	env_delta_state.pos = 0;
+	if (delta->erase) {
+		ret = delta->erase(delta);
+		if (ret)
+			return ret;
+	}
+
+	hdr->magic = ENV_DELTA_MAGIC;
+	memcpy(&hdr->base_crc, &base->crc, sizeof(hdr->base_crc));
+	hdr->seq++;
+	hdr->crc = env_delta_hdr_crc(hdr);
+	ret = delta->write(delta, 0, sizeof(*hdr), hdr);
+	if (ret)
+		return ret;
+
+	ret = env_delta_snapshot();
+	if (ret)
+		return ret;
+	env_delta_state.pos = sizeof(*hdr);
+
+	return 0;
+}
+#endif /* CONFIG_SPL_BUILD */
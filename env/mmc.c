@@ -173,6 +173,59 @@ static void fini_mmc_for_env(struct mmc *mmc)
 #endif
 }
 
+#ifdef CONFIG_ENV_DELTA
+/* Read or update part of the change log, which need not be block-aligned */
+static int env_mmc_delta_rw(struct env_delta *delta, ulong offset, ulong len,
+			    void *buf, bool write)
+{
+	struct blk_desc *desc = mmc_get_blk_desc(delta->priv);
+	ulong blksz = desc->blksz;
+	uint blk_start, blk_cnt, n;
+	char *tmp;
+	int ret = 0;
+
+	offset += CONFIG_ENV_DELTA_OFFSET;
+	blk_start = offset / blksz;
+	blk_cnt = DIV_ROUND_UP(offset % blksz + len, blksz);
+	tmp = malloc_cache_aligned(blk_cnt * blksz);
+	if (!tmp)
+		return -ENOMEM;
+
+	n = blk_dread(desc, blk_start, blk_cnt, tmp);
+	if (n != blk_cnt) {
+		ret = -EIO;
+	} else if (write) {
+		memcpy(tmp + offset % blksz, buf, len);
+		n = blk_dwrite(desc, blk_start, blk_cnt, tmp);
+		if (n != blk_cnt)
+			ret = -EIO;
+	} else {
+		memcpy(buf, tmp + offset % blksz, len);
+	}
+	free(tmp);
+
+	return ret;
+}
+
+static int env_mmc_delta_read(struct env_delta *delta, ulong offset,
+			      ulong len, void *buf)
+{
+	return env_mmc_delta_rw(delta, offset, len, buf, false);
+}
+
+static int env_mmc_delta_write(struct env_delta *delta, ulong offset,
+			       ulong len, const void *buf)
+{
+	return env_mmc_delta_rw(delta, offset, len, (void *)buf, true);
+}
+
+static struct env_delta env_mmc_delta = {
+	.size	= CONFIG_ENV_DELTA_SIZE,
+	.read	= env_mmc_delta_read,
+	.write	= env_mmc_delta_write,
+};
+#endif
+
 #if defined(CONFIG_CMD_SAVEENV) && !defined(CONFIG_SPL_BUILD)
 static inline int write_env(struct mmc *mmc, unsigned long size,
 			    unsigned long offset, const void *buffer)
@@ -203,6 +256,14 @@ static int env_mmc_save(void)
 		return 1;
 	}
 
+#ifdef CONFIG_ENV_DELTA
+	env_mmc_delta.priv = mmc;
+	if (!env_delta_save(&env_mmc_delta)) {
+		ret = 0;
+		goto fini;
+	}
+#endif
+
 	ret = env_export(env_new);
 	if (ret)
 		goto fini;
@@ -224,6 +285,12 @@ static int env_mmc_save(void)
 		goto fini;
 	}
 
+#ifdef CONFIG_ENV_DELTA
+	ret = env_delta_reset(&env_mmc_delta, env_new);
+	if (ret)
+		goto fini;
+#endif
+
 	ret = 0;
 
 #ifdef CONFIG_ENV_OFFSET_REDUND
@@ -333,6 +400,13 @@ static int env_mmc_load(void)
 
 	ret = env_import_redund((char *)tmp_env1, read1_fail, (char *)tmp_env2,
 				read2_fail);
+#ifdef CONFIG_ENV_DELTA
+	if (!ret) {
+		env_mmc_delta.priv = mmc;
+		env_delta_load(&env_mmc_delta, gd->env_valid == ENV_REDUND ?
+			       tmp_env2 : tmp_env1);
+	}
+#endif
 
 fini:
 	fini_mmc_for_env(mmc);
@@ -378,6 +452,10 @@ static int env_mmc_load(void)
 	if (!ret) {
 		ep = (env_t *)buf;
 		gd->env_addr = (ulong)&ep->data;
+#ifdef CONFIG_ENV_DELTA
+		env_mmc_delta.priv = mmc;
+		env_delta_load(&env_mmc_delta, ep);
+#endif
 	}
 
 fini:
@@ -68,6 +68,39 @@ static int setup_flash_device(void)
 	return 0;
 }
 
+#ifdef CONFIG_ENV_DELTA
+static int env_sf_delta_read(struct env_delta *delta, ulong offset, ulong len,
+			     void *buf)
+{
+	return spi_flash_read(env_flash, CONFIG_ENV_DELTA_OFFSET + offset, len,
+			      buf);
+}
+
+#ifdef CMD_SAVEENV
+static int env_sf_delta_write(struct env_delta *delta, ulong offset,
+			      ulong len, const void *buf)
+{
+	return spi_flash_write(env_flash, CONFIG_ENV_DELTA_OFFSET + offset, len,
+			       buf);
+}
+
+static int env_sf_delta_erase(struct env_delta *delta)
+{
+	return spi_flash_erase(env_flash, CONFIG_ENV_DELTA_OFFSET,
+			       CONFIG_ENV_DELTA_SIZE);
+}
+#endif
+
+static struct env_delta env_sf_delta = {
+	.size	= CONFIG_ENV_DELTA_SIZE,
+	.read	= env_sf_delta_read,
+#ifdef CMD_SAVEENV
+	.write	= env_sf_delta_write,
+	.erase	= env_sf_delta_erase,
+#endif
+};
+#endif
+
 #if defined(CONFIG_ENV_OFFSET_REDUND)
 #ifdef CMD_SAVEENV
 static int env_sf_save(void)
@@ -81,6 +114,11 @@ static int env_sf_save(void)
 	if (ret)
 		return ret;
 
+#ifdef CONFIG_ENV_DELTA
+	if (!env_delta_save(&env_sf_delta))
+		return 0;
+#endif
+
 	ret = env_export(&env_new);
 	if (ret)
 		return -EIO;
@@ -136,6 +174,12 @@ static int env_sf_save(void)
 	if (ret)
 		goto done;
 
+#ifdef CONFIG_ENV_DELTA
+	ret = env_delta_reset(&env_sf_delta, &env_new);
+	if (ret)
+		goto done;
+#endif
+
 	puts("done\n");
 
 	gd->env_valid = gd->env_valid == ENV_REDUND ? ENV_VALID : ENV_REDUND;
@@ -177,6 +221,11 @@ static int env_sf_load(void)
 
 	ret = env_import_redund((char *)tmp_env1, read1_fail, (char *)tmp_env2,
 				read2_fail);
+#ifdef CONFIG_ENV_DELTA
+	if (!ret)
+		env_delta_load(&env_sf_delta, gd->env_valid == ENV_REDUND ?
+			       tmp_env2 : tmp_env1);
+#endif
 
 	spi_flash_free(env_flash);
 	env_flash = NULL;
@@ -199,6 +248,11 @@ static int env_sf_save(void)
 	if (ret)
 		return ret;
 
+#ifdef CONFIG_ENV_DELTA
+	if (!env_delta_save(&env_sf_delta))
+		return 0;
+#endif
+
 	/* Is the sector larger than the env (i.e. embedded) */
 	if (CONFIG_ENV_SECT_SIZE > CONFIG_ENV_SIZE) {
 		saved_size = CONFIG_ENV_SECT_SIZE - CONFIG_ENV_SIZE;
@@ -238,6 +292,12 @@ static int env_sf_save(void)
 			goto done;
 	}
 
+#ifdef CONFIG_ENV_DELTA
+	ret = env_delta_reset(&env_sf_delta, &env_new);
+	if (ret)
+		goto done;
+#endif
+
 	ret = 0;
 	puts("done\n");
 
@@ -272,8 +332,12 @@ static int env_sf_load(void)
 	}
 
 	ret = env_import(buf, 1);
-	if (!ret)
+	if (!ret) {
 		gd->env_valid = ENV_VALID;
+#ifdef CONFIG_ENV_DELTA
+		env_delta_load(&env_sf_delta, (env_t *)buf);
+#endif
+	}
 
 err_read:
 	spi_flash_free(env_flash);
@@ -7,6 +7,7 @@
 
 #include "btrfs.h"
 #include <config.h>
+#include <fs.h>
 #include <malloc.h>
 #include <linux/time.h>
 
@@ -207,6 +208,65 @@ int btrfs_read(const char *file, void *buf, loff_t offset, loff_t len,
 	return 0;
 }
 
+struct btrfs_file {
+	struct btrfs_root root;
+	u64 inr;
+};
+
+int btrfs_file_open(struct fs_file *file)
+{
+	struct btrfs_root root = btrfs_info.fs_root;
+	struct btrfs_inode_item inode;
+	struct btrfs_file *bf;
+	u64 inr;
+	u8 type;
+
+	inr = btrfs_lookup_path(&root, root.root_dirid, file->path, &type,
+				&inode, 40);
+	if (inr == -1ULL)
+		return -ENOENT;
+	if (type != BTRFS_FT_REG_FILE)
+		return -EISDIR;
+
+	bf = malloc(sizeof(*bf));
+	if (!bf)
+		return -ENOMEM;
+	bf->root = root;
+	bf->inr = inr;
+	file->size = inode.size;
+	file->priv = bf;
+
+	return 0;
+}
+
+int btrfs_file_read_at(struct fs_file *file, void *buf, loff_t offset,
+		       loff_t len, loff_t *actread)
+{
+	struct btrfs_file *bf = file->priv;
+	u64 rd;
+
+	if (offset >= file->size) {
+		*actread = 0;
+		return 0;
+	}
+	if (!len || len > file->size - offset)
+		len = file->size - offset;
+
+	rd = btrfs_file_read(&bf->root, bf->inr, offset, len, buf);
+	if (rd == -1ULL) {
+		printf("An error occured while reading file %s\n", file->path);
+		return -EIO;
+	}
+
+	*actread = rd;
+	return 0;
+}
+
+void btrfs_file_close(struct fs_file *file)
+{
+	free(file->priv);
+}
+
 void btrfs_close(void)
 {
 	btrfs_chunk_map_exit();
@@ -23,6 +23,7 @@
 #include <common.h>
 #include <ext_common.h>
 #include <ext4fs.h>
+#include <fs.h>
 #include "ext4_common.h"
 #include <div64.h>
 #include <malloc.h>
@@ -225,6 +226,47 @@ int ext4fs_read(char *buf, loff_t offset, loff_t len, loff_t *actread)
 	return ext4fs_read_file(ext4fs_file, offset, len, buf, actread);
 }
 
+int ext4fs_file_open(struct fs_file *file)
+{
+	struct ext2fs_node *node = NULL;
+
+	if (ext4fs_root == NULL)
+		return -ENODEV;
+
+	if (!ext4fs_find_file(file->path, &ext4fs_root->diropen, &node,
+			      FILETYPE_REG)) {
+		ext4fs_free_node(node, &ext4fs_root->diropen);
+		return -ENOENT;
+	}
+	if (!node->inode_read &&
+	    !ext4fs_read_inode(node->data, node->ino, &node->inode)) {
+		free(node);
+		return -EIO;
+	}
+
+	/* The node, unlike ext4fs_file, belongs to the file until closed */
+	file->size = le32_to_cpu(node->inode.size);
+	file->priv = node;
+
+	return 0;
+}
+
+int ext4fs_file_read(struct fs_file *file, void *buf, loff_t offset,
+		     loff_t len, loff_t *actread)
+{
+	if (len == 0)
+		len = file->size;
+
+	return ext4fs_read_file(file->priv, offset, len, buf, actread) ?
+		-EIO : 0;
+}
+
+void ext4fs_file_close(struct fs_file *file)
+{
+	/* A regular file is never the root node, so just free it */
+	free(file->priv);
+}
+
 int ext4fs_probe(struct blk_desc *fs_dev_desc,
 		 disk_partition_t *fs_partition)
 {
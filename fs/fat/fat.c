@@ -301,6 +301,12 @@ get_cluster(fsdata *mydata, __u32 clustnum, __u8 *buffer, unsigned long size)
 	return 0;
 }
 
+/* Position in a file's cluster chain, kept between reads of an open file */
+struct fat_clust_pos {
+	__u32 clust;	/* cluster holding 'pos', 0 if none */
+	loff_t pos;	/* file offset of the start of 'clust' */
+};
+
 /**
  * get_contents() - read from file
  *
@@ -308,22 +314,28 @@ get_cluster(fsdata *mydata, __u32 clustnum, __u8 *buffer, unsigned long size)
  * into 'buffer'. Update the number of bytes read in *gotsize or return -1 on
  * fatal errors.
  *
+ * If 'hint' is given, it is used to skip walking the cluster chain from the
+ * start of the file when reading at or after the position it holds, and is
+ * updated to the last cluster read.
+ *
  * @mydata:	file system description
  * @dentprt:	directory entry pointer
  * @pos:	position from where to read
  * @buffer:	buffer into which to read
  * @maxsize:	maximum number of bytes to read
  * @gotsize:	number of bytes actually read
+ * @hint:	cluster chain position from an earlier read, or NULL
  * Return:	-1 on error, otherwise 0
  */
 static int get_contents(fsdata *mydata, dir_entry *dentptr, loff_t pos,
-			__u8 *buffer, loff_t maxsize, loff_t *gotsize)
+			__u8 *buffer, loff_t maxsize, loff_t *gotsize,
+			struct fat_clust_pos *hint)
 {
 	loff_t filesize = FAT2CPU32(dentptr->size);
 	unsigned int bytesperclust = mydata->clust_size * mydata->sect_size;
 	__u32 curclust = START(dentptr);
 	__u32 endclust, newclust;
-	loff_t actsize;
+	loff_t actsize, clustpos = 0;
 
 	*gotsize = 0;
 	debug("Filesize: %llu bytes\n", filesize);
@@ -338,7 +350,11 @@ static int get_contents(fsdata *mydata, dir_entry *dentptr, loff_t pos,
 
 	debug("%llu bytes\n", filesize);
 
-	actsize = bytesperclust;
+	if (hint && hint->clust && hint->pos <= pos) {
+		curclust = hint->clust;
+		clustpos = hint->pos;
+	}
+	actsize = clustpos + bytesperclust;
 
 	/* go to cluster at pos */
 	while (actsize <= pos) {
@@ -355,6 +371,7 @@ static int get_contents(fsdata *mydata, dir_entry *dentptr, loff_t pos,
 	actsize -= bytesperclust;
 	filesize -= actsize;
 	pos -= actsize;
+	clustpos = actsize;
 
 	/* align to beginning of next cluster if any */
 	if (pos) {
@@ -377,8 +394,13 @@ static int get_contents(fsdata *mydata, dir_entry *dentptr, loff_t pos,
 		memcpy(buffer, tmp_buffer + pos, actsize);
 		free(tmp_buffer);
 		*gotsize += actsize;
-		if (!filesize)
+		if (!filesize) {
+			if (hint) {
+				hint->clust = curclust;
+				hint->pos = clustpos;
+			}
 			return 0;
+		}
 		buffer += actsize;
 
 		curclust = get_fatent(mydata, curclust);
@@ -387,6 +409,7 @@ static int get_contents(fsdata *mydata, dir_entry *dentptr, loff_t pos,
 			printf("Invalid FAT entry\n");
 			return -1;
 		}
+		clustpos += bytesperclust;
 	}
 
 	actsize = bytesperclust;
@@ -407,6 +430,11 @@ static int get_contents(fsdata *mydata, dir_entry *dentptr, loff_t pos,
 			actsize += bytesperclust;
 		}
 
+		if (hint) {
+			hint->clust = endclust;
+			hint->pos = clustpos + actsize - bytesperclust;
+		}
+
 		/* get remaining bytes */
 		actsize = filesize;
 		if (get_cluster(mydata, curclust, buffer, (int)actsize) != 0) {
@@ -423,6 +451,7 @@ getit:
 		*gotsize += (int)actsize;
 		filesize -= actsize;
 		buffer += actsize;
+		clustpos += actsize;
 
 		curclust = get_fatent(mydata, endclust);
 		if (CHECK_CLUST(curclust, mydata->fatsize)) {
@@ -1215,7 +1244,8 @@ int file_fat_read_at(const char *filename, loff_t pos, void *buffer,
 	/* For saving default max clustersize memory allocated to malloc pool */
 	dir_entry *dentptr = itr->dent;
 
-	ret = get_contents(&fsdata, dentptr, pos, buffer, maxsize, actread);
+	ret = get_contents(&fsdata, dentptr, pos, buffer, maxsize, actread,
+			   NULL);
 
 out_free_both:
 	free(fsdata.fatbuf);
@@ -1313,6 +1343,69 @@ void fat_closedir(struct fs_dir_stream *dirs)
 	free(dir);
 }
 
+typedef struct {
+	fsdata fsdata;
+	dir_entry dent;
+	struct fat_clust_pos hint;
+} fat_file;
+
+int fat_file_open(struct fs_file *file)
+{
+	fat_file *ff;
+	fat_itr *itr;
+	int ret;
+
+	ff = calloc(1, sizeof(*ff));
+	itr = malloc_cache_aligned(sizeof(fat_itr));
+	if (!ff || !itr) {
+		ret = -ENOMEM;
+		goto out_free_itr;
+	}
+	ret = fat_itr_root(itr, &ff->fsdata);
+	if (ret)
+		goto out_free_itr;
+
+	ret = fat_itr_resolve(itr, file->path, TYPE_FILE);
+	if (ret) {
+		free(ff->fsdata.fatbuf);
+		goto out_free_itr;
+	}
+
+	/* Keep the FAT buffer and the directory entry until closed */
+	ff->dent = *itr->dent;
+	file->size = FAT2CPU32(ff->dent.size);
+	file->priv = ff;
+	ff = NULL;
+out_free_itr:
+	free(itr);
+	free(ff);
+	return ret;
+}
+
+int fat_file_read(struct fs_file *file, void *buf, loff_t offset, loff_t len,
+		  loff_t *actread)
+{
+	fat_file *ff = file->priv;
+
+	if (get_contents(&ff->fsdata, &ff->dent, offset, buf, len, actread,
+			 &ff->hint)) {
+		/* The hint may be left half updated */
+		ff->hint.clust = 0;
+		return -EIO;
+	}
+
+	return 0;
+}
+
+void fat_file_close(struct fs_file *file)
+{
+	fat_file *ff = file->priv;
+
+	if (ff)
+		free(ff->fsdata.fatbuf);
+	free(ff);
+}
+
 void fat_close(void)
 {
 }
@@ -8,6 +8,7 @@
 #include <common.h>
 #include <env.h>
 #include <mapmem.h>
+#include <malloc.h>
 #include <part.h>
 #include <ext4fs.h>
 #include <fat.h>
@@ -27,6 +28,20 @@ static int fs_dev_part;
 static disk_partition_t fs_partition;
 static int fs_type = FS_TYPE_ANY;
 
+/*
+ * File system kept mounted for open files (see fs_file_open()), and a
+ * generation count bumped each time a file system is unmounted or written
+ * to, after which open files must be looked up again. The device's own
+ * write count is recorded too, so that writes which do not go through this
+ * file (e.g. 'mmc write' or env/fat.c) are noticed.
+ */
+static struct blk_desc *fs_mount_desc;
+static int fs_mount_part;
+static int fs_mount_type = FS_TYPE_ANY;
+static unsigned int fs_mount_write_gen;
+static unsigned int fs_mount_gen;
+static int fs_open_files;
+
 static inline int fs_probe_unsupported(struct blk_desc *fs_dev_desc,
 				      disk_partition_t *fs_partition)
 {
@@ -112,6 +127,15 @@ static inline int fs_opendir_unsupported(const char *filename,
 	return -EACCES;
 }
 
+static inline int fs_file_open_unsupported(struct fs_file *file)
+{
+	return -EACCES;
+}
+
+static inline void fs_file_close_generic(struct fs_file *file)
+{
+}
+
 static inline int fs_unlink_unsupported(const char *filename)
 {
 	return -1;
@@ -159,11 +183,50 @@ struct fstype_info {
 	int (*readdir)(struct fs_dir_stream *dirs, struct fs_dirent **dentp);
 	/* see fs_closedir() */
 	void (*closedir)(struct fs_dir_stream *dirs);
+	/*
+	 * Look up file->path, a regular file, and set up file->size and
+	 * file->priv for reading it. On error return -errno. See
+	 * fs_file_open().
+	 */
+	int (*file_open)(struct fs_file *file);
+	/* see fs_file_read() */
+	int (*file_read)(struct fs_file *file, void *buf, loff_t offset,
+			 loff_t len, loff_t *actread);
+	/*
+	 * Free file->priv. This may be called after the file system has
+	 * been unmounted, so must not access it.
+	 */
+	void (*file_close)(struct fs_file *file);
 	int (*unlink)(const char *filename);
 	int (*mkdir)(const char *dirname);
 	int (*ln)(const char *filename, const char *target);
 };
 
+static struct fstype_info *fs_get_info(int fstype);
+
+/*
+ * generic implementation of open files in terms of size/read, for file
+ * systems which have nothing to keep between reads
+ */
+__maybe_unused
+static int fs_file_open_generic(struct fs_file *file)
+{
+	struct fstype_info *info = fs_get_info(fs_type);
+
+	if (!info->exists(file->path))
+		return -ENOENT;
+
+	return info->size(file->path, &file->size) ? -EIO : 0;
+}
+
+static int fs_file_read_generic(struct fs_file *file, void *buf,
+				loff_t offset, loff_t len, loff_t *actread)
+{
+	struct fstype_info *info = fs_get_info(fs_type);
+
+	return info->read(file->path, buf, offset, len, actread);
+}
+
 static struct fstype_info fstypes[] = {
 #ifdef CONFIG_FS_FAT
 	{
@@ -189,6 +252,9 @@ static struct fstype_info fstypes[] = {
 		.opendir = fat_opendir,
 		.readdir = fat_readdir,
 		.closedir = fat_closedir,
+		.file_open = fat_file_open,
+		.file_read = fat_file_read,
+		.file_close = fat_file_close,
 		.ln = fs_ln_unsupported,
 	},
 #endif
@@ -213,6 +279,9 @@ static struct fstype_info fstypes[] = {
 #endif
 		.uuid = ext4fs_uuid,
 		.opendir = fs_opendir_unsupported,
+		.file_open = ext4fs_file_open,
+		.file_read = ext4fs_file_read,
+		.file_close = ext4fs_file_close,
 		.unlink = fs_unlink_unsupported,
 		.mkdir = fs_mkdir_unsupported,
 	},
@@ -231,6 +300,9 @@ static struct fstype_info fstypes[] = {
 		.write = fs_write_sandbox,
 		.uuid = fs_uuid_unsupported,
 		.opendir = fs_opendir_unsupported,
+		.file_open = fs_file_open_generic,
+		.file_read = fs_file_read_generic,
+		.file_close = fs_file_close_generic,
 		.unlink = fs_unlink_unsupported,
 		.mkdir = fs_mkdir_unsupported,
 		.ln = fs_ln_unsupported,
@@ -250,6 +322,9 @@ static struct fstype_info fstypes[] = {
 		.write = fs_write_unsupported,
 		.uuid = fs_uuid_unsupported,
 		.opendir = fs_opendir_unsupported,
+		.file_open = fs_file_open_generic,
+		.file_read = fs_file_read_generic,
+		.file_close = fs_file_close_generic,
 		.unlink = fs_unlink_unsupported,
 		.mkdir = fs_mkdir_unsupported,
 		.ln = fs_ln_unsupported,
@@ -269,6 +344,9 @@ static struct fstype_info fstypes[] = {
 		.write = fs_write_unsupported,
 		.uuid = btrfs_uuid,
 		.opendir = fs_opendir_unsupported,
+		.file_open = btrfs_file_open,
+		.file_read = btrfs_file_read_at,
+		.file_close = btrfs_file_close,
 		.unlink = fs_unlink_unsupported,
 		.mkdir = fs_mkdir_unsupported,
 		.ln = fs_ln_unsupported,
@@ -287,6 +365,9 @@ static struct fstype_info fstypes[] = {
 		.write = fs_write_unsupported,
 		.uuid = fs_uuid_unsupported,
 		.opendir = fs_opendir_unsupported,
+		.file_open = fs_file_open_unsupported,
+		.file_read = fs_file_read_generic,
+		.file_close = fs_file_close_generic,
 		.unlink = fs_unlink_unsupported,
 		.mkdir = fs_mkdir_unsupported,
 		.ln = fs_ln_unsupported,
@@ -333,9 +414,38 @@ const char *fs_get_type_name(void)
 	return fs_get_info(fs_type)->name;
 }
 
+/* Select the file system kept mounted for open files, if it matches */
+static bool fs_mount_reuse(struct blk_desc *desc, int part, int fstype)
+{
+	if (fs_mount_type == FS_TYPE_ANY || desc != fs_mount_desc ||
+	    part != fs_mount_part || desc->write_gen != fs_mount_write_gen)
+		return false;
+	if (fstype != FS_TYPE_ANY && fstype != fs_mount_type)
+		return false;
+
+	fs_dev_desc = desc;
+	fs_dev_part = part;
+	fs_type = fs_mount_type;
+
+	return true;
+}
+
+/* Unmount the file system kept for open files, they are looked up again */
+static void fs_mount_drop(void)
+{
+	if (fs_mount_type == FS_TYPE_ANY)
+		return;
+
+	fs_get_info(fs_mount_type)->close();
+	fs_mount_type = FS_TYPE_ANY;
+	fs_mount_gen++;
+}
+
 int fs_set_blk_dev(const char *ifname, const char *dev_part_str, int fstype)
 {
 	struct fstype_info *info;
+	struct blk_desc *desc;
+	disk_partition_t part_info;
 	int part, i;
 #ifdef CONFIG_NEEDS_MANUAL_RELOC
 	static int relocated;
@@ -354,11 +464,17 @@ int fs_set_blk_dev(const char *ifname, const char *dev_part_str, int fstype)
 	}
 #endif
 
-	part = blk_get_device_part_str(ifname, dev_part_str, &fs_dev_desc,
-					&fs_partition, 1);
+	part = blk_get_device_part_str(ifname, dev_part_str, &desc,
+					&part_info, 1);
 	if (part < 0)
 		return -1;
 
+	if (fs_mount_reuse(desc, part, fstype))
+		return 0;
+	fs_mount_drop();
+	fs_dev_desc = desc;
+	fs_partition = part_info;
+
 	for (i = 0, info = fstypes; i < ARRAY_SIZE(fstypes); i++, info++) {
 		if (fstype != FS_TYPE_ANY && info->fstype != FS_TYPE_ANY &&
 				fstype != info->fstype)
@@ -383,6 +499,10 @@ int fs_set_blk_dev_with_part(struct blk_desc *desc, int part)
 	struct fstype_info *info;
 	int ret, i;
 
+	if (fs_mount_reuse(desc, part, FS_TYPE_ANY))
+		return 0;
+	fs_mount_drop();
+
 	if (part >= 1)
 		ret = part_get_info(desc, part, &fs_partition);
 	else
@@ -406,7 +526,19 @@ void fs_close(void)
 {
 	struct fstype_info *info = fs_get_info(fs_type);
 
-	info->close();
+	if (fs_type != FS_TYPE_ANY && fs_open_files) {
+		/* Keep it mounted for the open files */
+		fs_mount_desc = fs_dev_desc;
+		fs_mount_part = fs_dev_part;
+		fs_mount_type = fs_type;
+		fs_mount_write_gen = fs_dev_desc->write_gen;
+	} else {
+		info->close();
+		if (fs_type != FS_TYPE_ANY) {
+			fs_mount_type = FS_TYPE_ANY;
+			fs_mount_gen++;
+		}
+	}
 
 	fs_type = FS_TYPE_ANY;
 }
@@ -538,6 +670,7 @@ int fs_write(const char *filename, ulong addr, loff_t offset, loff_t len,
 
 	buf = map_sysmem(addr, len);
 	ret = info->write(filename, buf, offset, len, actwrite);
+	fs_mount_gen++;
 	unmap_sysmem(buf);
 
 	if (ret < 0 && len != *actwrite) {
@@ -601,6 +734,106 @@ void fs_closedir(struct fs_dir_stream *dirs)
 	fs_close();
 }
 
+struct fs_file *fs_file_open(const char *filename)
+{
+	struct fstype_info *info = fs_get_info(fs_type);
+	struct fs_file *file;
+	int ret;
+
+	file = calloc(1, sizeof(*file) + strlen(filename) + 1);
+	if (!file) {
+		ret = -ENOMEM;
+	} else {
+		strcpy(file->path, filename);
+		file->desc = fs_dev_desc;
+		file->part = fs_dev_part;
+		file->fstype = fs_type;
+		file->gen = fs_mount_gen;
+		ret = info->file_open(file);
+		if (!ret)
+			fs_open_files++;
+	}
+	fs_close();
+	if (ret) {
+		free(file);
+		errno = -ret;
+		return NULL;
+	}
+
+	return file;
+}
+
+/* Select the file's file system and look the file up again if needed */
+static int fs_file_get(struct fs_file *file)
+{
+	struct fstype_info *info;
+	int ret;
+
+	ret = fs_set_blk_dev_with_part(file->desc, file->part);
+	if (ret)
+		return -ENODEV;
+	if (file->gen == fs_mount_gen && file->fstype == fs_type)
+		return 0;
+
+	fs_get_info(file->fstype)->file_close(file);
+	file->priv = NULL;
+	file->fstype = fs_type;
+	file->gen = fs_mount_gen;
+	info = fs_get_info(fs_type);
+	ret = info->file_open(file);
+	if (ret) {
+		/* Try again next time */
+		file->fstype = FS_TYPE_ANY;
+		fs_close();
+	}
+
+	return ret;
+}
+
+int fs_file_read(struct fs_file *file, ulong addr, loff_t offset, loff_t len,
+		 loff_t *actread)
+{
+	struct fstype_info *info;
+	void *buf;
+	int ret;
+
+	ret = fs_file_get(file);
+	if (ret)
+		return ret;
+	info = fs_get_info(fs_type);
+
+	buf = map_sysmem(addr, len);
+	ret = info->file_read(file, buf, offset, len, actread);
+	unmap_sysmem(buf);
+	fs_close();
+
+	return ret;
+}
+
+int fs_file_size(struct fs_file *file, loff_t *size)
+{
+	int ret;
+
+	ret = fs_file_get(file);
+	if (ret)
+		return ret;
+	*size = file->size;
+	fs_close();
+
+	return 0;
+}
+
+void fs_file_close(struct fs_file *file)
+{
+	if (!file)
+		return;
+
+	fs_get_info(file->fstype)->file_close(file);
+	free(file);
+	if (!--fs_open_files && fs_type == FS_TYPE_ANY)
+		fs_mount_drop();
+}
+
 int fs_unlink(const char *filename)
 {
 	int ret;
@@ -608,6 +841,7 @@ int fs_unlink(const char *filename)
 	struct fstype_info *info = fs_get_info(fs_type);
 
 	ret = info->unlink(filename);
+	fs_mount_gen++;
 
 	fs_close();
 
@@ -621,6 +855,7 @@ int fs_mkdir(const char *dirname)
 	struct fstype_info *info = fs_get_info(fs_type);
 
 	ret = info->mkdir(dirname);
+	fs_mount_gen++;
 
 	fs_close();
 
@@ -633,6 +868,7 @@ int fs_ln(const char *fname, const char *target)
 	int ret;
 
 	ret = info->ln(fname, target);
+	fs_mount_gen++;
 
 	if (ret < 0) {
 		printf("** Unable to create link %s -> %s **\n", fname, target);
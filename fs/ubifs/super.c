@@ -2282,6 +2282,10 @@ static int ubifs_fill_super(struct super_block *sb, void *data, int silent)
 		goto out_bdi;
 
 	sb->s_bdi = &c->bdi;
+#else
+	/* Loading whole files is what U-Boot does, so read them in bulk */
+	if (IS_ENABLED(CONFIG_UBIFS_BULK_READ))
+		c->bulk_read = 1;
 #endif
 	sb->s_fs_info = c;
 	sb->s_magic = UBIFS_SUPER_MAGIC;
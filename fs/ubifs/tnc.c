@@ -182,6 +182,70 @@ void destroy_old_idx(struct ubifs_info *c)
 	c->old_idx = RB_ROOT;
 }
 
+#ifdef __UBOOT__
+/**
+ * tnc_cache_reset - forget the recently used zero-level znodes.
+ * @c: UBIFS file-system description object
+ *
+ * This has to be called whenever a znode may be freed or replaced by a copy.
+ */
+static void tnc_cache_reset(struct ubifs_info *c)
+{
+	memset(c->zcache, 0, sizeof(c->zcache));
+}
+
+/**
+ * tnc_cache_lookup - find a recently used zero-level znode covering a key.
+ * @c: UBIFS file-system description object
+ * @key: key to lookup
+ *
+ * Keys which are not hashed are unique, so a key between the lowest and the
+ * highest key of a zero-level znode can only be in that znode, and looking
+ * it up from the root would end up there too. Returns the znode or %NULL.
+ */
+static struct ubifs_znode *tnc_cache_lookup(struct ubifs_info *c,
+					    const union ubifs_key *key)
+{
+	struct ubifs_znode *znode;
+	int i;
+
+	if (is_hash_key(c, key))
+		return NULL;
+
+	for (i = 0; i < UBIFS_ZCACHE_SIZE; i++) {
+		znode = c->zcache[i];
+		if (!znode || !znode->child_cnt)
+			continue;
+		if (keys_cmp(c, key, &znode->zbranch[0].key) >= 0 &&
+		    keys_cmp(c, key,
+			     &znode->zbranch[znode->child_cnt - 1].key) <= 0)
+			return znode;
+	}
+
+	return NULL;
+}
+
+/**
+ * tnc_cache_add - remember a zero-level znode.
+ * @c: UBIFS file-system description object
+ * @znode: zero-level znode
+ */
+static void tnc_cache_add(struct ubifs_info *c, struct ubifs_znode *znode)
+{
+	int i;
+
+	for (i = 0; i < UBIFS_ZCACHE_SIZE; i++) {
+		if (c->zcache[i] == znode)
+			return;
+	}
+	c->zcache[c->zcache_next++ % UBIFS_ZCACHE_SIZE] = znode;
+}
+#else
+static inline void tnc_cache_reset(struct ubifs_info *c)
+{
+}
+#endif
+
 /**
  * copy_znode - copy a dirty znode.
  * @c: UBIFS file-system description object
@@ -264,6 +328,7 @@ static struct ubifs_znode *dirty_cow_znode(struct ubifs_info *c,
 		return znode;
 	}
 
+	tnc_cache_reset(c);
 	zn = copy_znode(c, znode);
 	if (IS_ERR(zn))
 		return zn;
@@ -1162,6 +1227,16 @@ int ubifs_lookup_level0(struct ubifs_info *c, const union ubifs_key *key,
 	dbg_tnck(key, "search key ");
 	ubifs_assert(key_type(c, key) < UBIFS_INVALID_KEY);
 
+#ifdef __UBOOT__
+	/* Files are read sequentially, so the last znode usually has the key */
+	znode = tnc_cache_lookup(c, key);
+	if (znode) {
+		exact = ubifs_search_zbranch(c, znode, key, n);
+		*zn = znode;
+		return exact;
+	}
+#endif
+
 	znode = c->zroot.znode;
 	if (unlikely(!znode)) {
 		znode = ubifs_load_znode(c, &c->zroot, NULL, 0);
@@ -1196,6 +1271,10 @@ int ubifs_lookup_level0(struct ubifs_info *c, const union ubifs_key *key,
 	}
 
 	*zn = znode;
+#ifdef __UBOOT__
+	if (!is_hash_key(c, key))
+		tnc_cache_add(c, znode);
+#endif
 	if (exact || !is_hash_key(c, key) || *n != -1) {
 		dbg_tnc("found %d, lvl %d, n %d", exact, znode->level, *n);
 		return exact;
@@ -2381,6 +2460,8 @@ static int tnc_delete(struct ubifs_info *c, struct ubifs_znode *znode, int n)
 	ubifs_assert(znode->level == 0);
 	ubifs_assert(n >= 0 && n < c->fanout);
 	dbg_tnck(&znode->zbranch[n].key, "deleting key ");
+	/* Empty znodes get freed below */
+	tnc_cache_reset(c);
 
 	zbr = &znode->zbranch[n];
 	lnc_free(zbr);
@@ -2857,6 +2938,7 @@ static void tnc_destroy_cnext(struct ubifs_info *c)
  */
 void ubifs_tnc_close(struct ubifs_info *c)
 {
+	tnc_cache_reset(c);
 	tnc_destroy_cnext(c);
 	if (c->zroot.znode) {
 		long n, freed;
@@ -669,23 +669,13 @@ static inline void *kmap(struct page *page)
 	return page->addr;
 }
 
-static int read_block(struct inode *inode, void *addr, unsigned int block,
-		      struct ubifs_data_node *dn)
+static int decode_block(struct inode *inode, void *addr, unsigned int block,
+			struct ubifs_data_node *dn)
 {
 	struct ubifs_info *c = inode->i_sb->s_fs_info;
 	int err, len, out_len;
-	union ubifs_key key;
 	unsigned int dlen;
 
-	data_key_init(c, &key, inode->i_ino, block);
-	err = ubifs_tnc_lookup(c, &key, dn);
-	if (err) {
-		if (err == -ENOENT)
-			/* Not found, so it must be a hole */
-			memset(addr, 0, UBIFS_BLOCK_SIZE);
-		return err;
-	}
-
 	ubifs_assert(le64_to_cpu(dn->ch.sqnum) > ubifs_inode(inode)->creat_sqnum);
 
 	len = le32_to_cpu(dn->size);
@@ -716,6 +706,76 @@ dump:
 	return -EINVAL;
 }
 
+static int read_block(struct inode *inode, void *addr, unsigned int block,
+		      struct ubifs_data_node *dn)
+{
+	struct ubifs_info *c = inode->i_sb->s_fs_info;
+	union ubifs_key key;
+	int err;
+
+	data_key_init(c, &key, inode->i_ino, block);
+	err = ubifs_tnc_lookup(c, &key, dn);
+	if (err) {
+		if (err == -ENOENT)
+			/* Not found, so it must be a hole */
+			memset(addr, 0, UBIFS_BLOCK_SIZE);
+		return err;
+	}
+
+	return decode_block(inode, addr, block, dn);
+}
+
+/*
+ * Read consecutive blocks of a file whose data nodes sit next to each other
+ * in a LEB, as they do when the file was written in one go, with a single
+ * flash read. Returns the number of blocks read, 0 if the blocks are not
+ * worth reading in bulk, or a negative error code.
+ */
+static int read_bulk(struct inode *inode, void *addr, unsigned int block,
+		     unsigned int max)
+{
+	struct ubifs_info *c = inode->i_sb->s_fs_info;
+	struct bu_info *bu = &c->bu;
+	struct ubifs_zbranch *zbr;
+	unsigned int i, n, nn = 0;
+	void *dn;
+	int err;
+
+	if (!c->bulk_read || !bu->buf || !max)
+		return 0;
+
+	data_key_init(c, &bu->key, inode->i_ino, block);
+	bu->buf_len = c->max_bu_buf_len;
+	err = ubifs_tnc_get_bu_keys(c, bu);
+	if (err)
+		return err;
+	if (bu->cnt < 2)
+		return 0;
+
+	err = ubifs_tnc_bulk_read(c, bu);
+	if (err)
+		return err;
+
+	n = min_t(unsigned int, bu->blk_cnt, max);
+	dn = bu->buf;
+	for (i = 0; i < n; i++, addr += UBIFS_BLOCK_SIZE) {
+		zbr = &bu->zbranch[nn];
+		if (nn >= bu->cnt || key_block(c, &zbr->key) != block + i) {
+			/* Not found, so it must be a hole */
+			memset(addr, 0, UBIFS_BLOCK_SIZE);
+			continue;
+		}
+
+		err = decode_block(inode, addr, block + i, dn);
+		if (err)
+			return err;
+		dn += ALIGN(zbr->len, 8);
+		nn++;
+	}
+
+	return n;
+}
+
 static int do_readpage(struct ubifs_info *c, struct inode *inode,
 		       struct page *page, int last_block_size)
 {
@@ -835,7 +895,7 @@ int ubifs_read(const char *filename, void *buf, loff_t offset,
 	struct inode *inode;
 	struct page page;
 	int err = 0;
-	int i;
+	int i, n;
 	int count;
 	int last_block_size = 0;
 
@@ -886,6 +946,25 @@ int ubifs_read(const char *filename, void *buf, loff_t offset,
 	page.index = offset / PAGE_SIZE;
 	page.inode = inode;
 	for (i = 0; i < count; i++) {
+		/*
+		 * Read whole pages in bulk where possible. The last page is
+		 * left to do_readpage(), as it may only be partly requested.
+		 */
+		n = read_bulk(inode, page.addr,
+			      page.index << UBIFS_BLOCKS_PER_PAGE_SHIFT,
+			      (count - 1 - i) << UBIFS_BLOCKS_PER_PAGE_SHIFT);
+		if (n < 0) {
+			err = n;
+			break;
+		}
+		n >>= UBIFS_BLOCKS_PER_PAGE_SHIFT;
+		if (n) {
+			page.addr += n * PAGE_SIZE;
+			page.index += n;
+			i += n - 1;
+			continue;
+		}
+
 		/*
 		 * Make sure to not read beyond the requested size
 		 */
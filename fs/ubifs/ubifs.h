@@ -765,6 +765,11 @@ static inline ino_t parent_ino(struct dentry *dentry)
 /* Maximum number of data nodes to bulk-read */
 #define UBIFS_MAX_BULK_READ 32
 
+#ifdef __UBOOT__
+/* Number of recently used zero-level znodes to remember */
+#define UBIFS_ZCACHE_SIZE 4
+#endif
+
 /*
  * Lockdep classes for UBIFS inode @ui_mutex.
  */
@@ -1647,6 +1652,8 @@ struct ubifs_debug_info;
  * @ileb_nxt: next pre-allocated index LEBs
  * @old_idx: tree of index nodes obsoleted since the last commit start
  * @bottom_up_buf: a buffer which is used by 'dirty_cow_bottom_up()' in tnc.c
+ * @zcache: recently used zero-level znodes, see 'ubifs_lookup_level0()'
+ * @zcache_next: slot in @zcache to be replaced next
  *
  * @mst_node: master node
  * @mst_offs: offset of valid master node
@@ -1889,6 +1896,10 @@ struct ubifs_info {
 	int ileb_nxt;
 	struct rb_root old_idx;
 	int *bottom_up_buf;
+#ifdef __UBOOT__
+	struct ubifs_znode *zcache[UBIFS_ZCACHE_SIZE];
+	unsigned int zcache_next;
+#endif
 
 	struct ubifs_mst_node *mst_node;
 	int mst_offs;
@@ -343,6 +343,21 @@ int bootstage_stash(void *base, int size);
  */
 int bootstage_unstash(const void *base, int size);
 
+/**
+ * bootstage_trace_export() - Export bootstage data as a Chrome trace
+ *
+ * This writes the bootstage records as a trace-event JSON file, as used by
+ * chrome://tracing and the Perfetto UI. Marks become consecutive stages
+ * on one track, each ending at its mark. The intervals recorded by
+ * bootstage_start() / bootstage_accum() go on a second track. Records and
+ * intervals unstashed from SPL / TPL are included.
+ *
+ * @buf:	Buffer to write the JSON to
+ * @size:	Size of buffer
+ * @return number of bytes written, or -ENOSPC if the buffer is too small
+ */
+int bootstage_trace_export(char *buf, int size);
+
 /**
  * bootstage_get_size() - Get the size of the bootstage data
  *
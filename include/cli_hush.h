@@ -20,6 +20,15 @@ int set_local_var(const char *s, int flg_export);
 void unset_local_var(const char *name);
 char *get_local_var(const char *s);
 
+/**
+ * hush_cache_get_stats() - Get statistics for the parsed-script cache
+ *
+ * @hits: Returns number of scripts run from the cache
+ * @misses: Returns number of scripts which had to be parsed
+ * @count: Returns number of scripts in the cache
+ */
+void hush_cache_get_stats(ulong *hits, ulong *misses, int *count);
+
 #if defined(CONFIG_HUSH_INIT_VAR)
 extern int hush_init_var (void);
 #endif
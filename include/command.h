@@ -136,7 +136,21 @@ extern int do_booti(cmd_tbl_t *cmdtp, int flag, int argc, char * const argv[]);
 extern int common_diskboot(cmd_tbl_t *cmdtp, const char *intf, int argc,
 			   char *const argv[]);
 
+/**
+ * do_reset() - Reset the board
+ *
+ * This sends any buffered console output, then calls arch_do_reset().
+ * Everything which resets the board should come through here.
+ */
 extern int do_reset(cmd_tbl_t *cmdtp, int flag, int argc, char * const argv[]);
+
+/**
+ * arch_do_reset() - Reset the board, as implemented by the architecture
+ *
+ * This is provided by the architecture, the board or the sysreset uclass.
+ * It normally does not return.
+ */
+int arch_do_reset(cmd_tbl_t *cmdtp, int flag, int argc, char * const argv[]);
 extern int do_poweroff(cmd_tbl_t *cmdtp, int flag, int argc, char * const argv[]);
 
 extern unsigned long do_go_exec(ulong (*entry)(int, char * const []), int argc,
@@ -182,6 +196,34 @@ int cmd_process(int flag, int argc, char * const argv[],
 
 void fixup_cmdtable(cmd_tbl_t *cmdtp, int size);
 
+/**
+ * struct cmd_stats - Time spent running a command
+ *
+ * @calls: Number of times the command was run
+ * @total_us: Total time taken in microseconds, including any commands it ran
+ * @max_us: Longest time taken by one call, in microseconds
+ */
+struct cmd_stats {
+	ulong calls;
+	u64 total_us;
+	ulong max_us;
+};
+
+/**
+ * cmd_get_stats() - Get the time spent running a command
+ *
+ * This is only available with CONFIG_CMD_STATS
+ *
+ * @cmdtp: Command to check, from the command table
+ * @return statistics for the command, or NULL if no command has been run yet
+ */
+const struct cmd_stats *cmd_get_stats(const cmd_tbl_t *cmdtp);
+
+/**
+ * cmd_reset_stats() - Reset the time spent running each command to zero
+ */
+void cmd_reset_stats(void);
+
 /**
  * board_run_command() - Fallback function to execute a command
  *
@@ -282,6 +282,7 @@ struct efi_loaded_image_obj {
  *
  * @link:		Link to list of all events
  * @queue_link:		Link to the list of queued events
+ * @group_link:		Link to the list of events in an event group
  * @type:		Type of event, see efi_create_event
  * @notify_tpl:		Task priority level of notifications
  * @nofify_function:	Function to call when the event is triggered
@@ -290,11 +291,13 @@ struct efi_loaded_image_obj {
  * @trigger_time:	Period of the timer
  * @trigger_next:	Next time to trigger the timer
  * @trigger_type:	Type of timer, see efi_set_timer
+ * @timer_index:	Position in the heap of armed timers, 0 if not armed
  * @is_signaled:	The event occurred. The event is in the signaled state.
  */
 struct efi_event {
 	struct list_head link;
 	struct list_head queue_link;
+	struct list_head group_link;
 	uint32_t type;
 	efi_uintn_t notify_tpl;
 	void (EFIAPI *notify_function)(struct efi_event *event, void *context);
@@ -303,9 +306,27 @@ struct efi_event {
 	u64 trigger_next;
 	u64 trigger_time;
 	enum efi_timer_delay trigger_type;
+	unsigned int timer_index;
 	bool is_signaled;
 };
 
+/**
+ * struct efi_event_stats - statistics about the event loop
+ *
+ * @loops:		Number of times efi_timer_check() was called
+ * @events:		Number of events
+ * @timers:		Number of timer events
+ * @timers_armed:	Number of timer events which are set to trigger
+ * @queued:		Number of events waiting for notification
+ */
+struct efi_event_stats {
+	u64 loops;
+	unsigned int events;
+	unsigned int timers;
+	unsigned int timers_armed;
+	unsigned int queued;
+};
+
 /* This list contains all UEFI objects we know of */
 extern struct list_head efi_obj_list;
 /* List of all events */
@@ -407,6 +428,8 @@ efi_status_t efi_set_watchdog(unsigned long timeout);
 
 /* Called from places to check whether a timer expired */
 void efi_timer_check(void);
+/* Get statistics about the event loop */
+void efi_get_event_stats(struct efi_event_stats *stats);
 /* PE loader implementation */
 efi_status_t efi_load_pe(struct efi_loaded_image_obj *handle, void *efi,
 			 struct efi_loaded_image *loaded_image_info);
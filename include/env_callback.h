@@ -36,6 +36,12 @@
 #define ENV_DOT_ESCAPE
 #endif
 
+#ifdef CONFIG_HUSH_PARSE_CACHE
+#define HUSH_CACHE_CALLBACK "bootcmd:hushcache,"
+#else
+#define HUSH_CACHE_CALLBACK
+#endif
+
 #ifdef CONFIG_CMD_DNS
 #define DNS_CALLBACK "dnsip:dnsip,"
 #else
@@ -68,6 +74,7 @@
 	"loadaddr:loadaddr," \
 	SILENT_CALLBACK \
 	SPLASHIMAGE_CALLBACK \
+	HUSH_CACHE_CALLBACK \
 	"stdin:console,stdout:console,stderr:console," \
 	"serial#:serialno," \
 	CONFIG_ENV_CALLBACK_LIST_STATIC
@@ -209,6 +209,64 @@ struct env_driver {
 
 extern struct hsearch_data env_htab;
 
+/**
+ * struct env_delta - Access to the environment change log
+ *
+ * This is provided by the environment driver, see CONFIG_ENV_DELTA.
+ * Offsets are relative to the start of the log area.
+ *
+ * @size:	Size of the log area in bytes
+ * @read:	Read from the log area
+ * @write:	Write to the log area
+ * @erase:	Erase the whole log area; NULL if it can be written to
+ *		without erasing
+ * @priv:	Private data for the driver
+ */
+struct env_delta {
+	ulong size;
+	int (*read)(struct env_delta *delta, ulong offset, ulong len,
+		    void *buf);
+	int (*write)(struct env_delta *delta, ulong offset, ulong len,
+		     const void *buf);
+	int (*erase)(struct env_delta *delta);
+	void *priv;
+};
+
+/**
+ * env_delta_load() - Apply the change log to a loaded environment
+ *
+ * This must be called after @base has been imported. Changes logged for
+ * another environment copy are ignored.
+ *
+ * @delta:	Change log
+ * @base:	Environment copy which was imported
+ */
+void env_delta_load(struct env_delta *delta, const env_t *base);
+
+/**
+ * env_delta_save() - Save the environment by appending its changes
+ *
+ * This compares the environment with the one last loaded or saved and
+ * appends the variables which changed to the log.
+ *
+ * @delta:	Change log
+ * @return 0 if OK, -ENOSPC if the log is full, other -ve on error. In
+ * any case of error the whole environment must be saved instead, followed
+ * by a call to env_delta_reset()
+ */
+int env_delta_save(struct env_delta *delta);
+
+/**
+ * env_delta_reset() - Start a new change log
+ *
+ * This must be called after the whole environment has been saved.
+ *
+ * @delta:	Change log
+ * @base:	Environment copy which was saved
+ * @return 0 if OK, -ve on error
+ */
+int env_delta_reset(struct env_delta *delta, const env_t *base);
+
 #endif /* DO_DEPS_ONLY */
 
 #endif /* _ENV_INTERNAL_H_ */
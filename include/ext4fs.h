@@ -141,6 +141,8 @@ int ext4_write_file(const char *filename, void *buf, loff_t offset, loff_t len,
 int ext4fs_create_link(const char *target, const char *fname);
 #endif
 
+struct fs_file;
+
 struct ext_filesystem *get_fs(void);
 int ext4fs_open(const char *filename, loff_t *len);
 int ext4fs_read(char *buf, loff_t offset, loff_t len, loff_t *actread);
@@ -159,6 +161,10 @@ int ext4fs_probe(struct blk_desc *fs_dev_desc,
 		 disk_partition_t *fs_partition);
 int ext4_read_file(const char *filename, void *buf, loff_t offset, loff_t len,
 		   loff_t *actread);
+int ext4fs_file_open(struct fs_file *file);
+int ext4fs_file_read(struct fs_file *file, void *buf, loff_t offset,
+		     loff_t len, loff_t *actread);
+void ext4fs_file_close(struct fs_file *file);
 int ext4_read_superblock(char *buffer);
 int ext4fs_uuid(char *uuid_str);
 void ext_cache_init(struct ext_block_cache *cache);
@@ -63,7 +63,8 @@ int fs_set_blk_dev_with_part(struct blk_desc *desc, int part);
  * fs_close() - Unset current block device and partition
  *
  * fs_close() closes the connection to a file system opened with either
- * fs_set_blk_dev() or fs_set_dev_with_part().
+ * fs_set_blk_dev() or fs_set_dev_with_part(). The file system itself is only
+ * unmounted once no files are open on it, see fs_file_open().
  *
  * Many file functions implicitly call fs_close(), e.g. fs_closedir(),
  * fs_exist(), fs_ln(), fs_ls(), fs_mkdir(), fs_read(), fs_size(), fs_write(),
@@ -202,6 +203,71 @@ struct fs_dirent *fs_readdir(struct fs_dir_stream *dirs);
  */
 void fs_closedir(struct fs_dir_stream *dirs);
 
+/* Note: fs_file should be treated as opaque to the user of fs layer */
+struct fs_file {
+	/* private to fs. layer: */
+	struct blk_desc *desc;
+	int part;
+	int fstype;		/* FS_TYPE_x the driver data belongs to */
+	unsigned int gen;	/* mount generation the driver data belongs to */
+	/* private to fs driver: */
+	loff_t size;
+	void *priv;
+	char path[];
+};
+
+/*
+ * fs_file_open - Open a regular file for reading
+ *
+ * Unlike fs_read(), which looks up the file each time it is called, this
+ * looks up the file once and keeps what the file system driver needs to read
+ * it. While any file is open the file system it lives on also stays mounted
+ * across fs_close(), so that fs_set_blk_dev() and fs_set_blk_dev_with_part()
+ * for the same device and partition do not have to probe it again.
+ *
+ * If the file system is written to or unmounted in the meantime, the file is
+ * looked up again on next use. This includes writes to the device which do
+ * not go through this API, e.g. 'mmc write' or saving the environment to a
+ * FAT file, as long as they use blk_dwrite() or blk_derase().
+ *
+ * Calling a file system driver directly on another device while files are
+ * open, e.g. fat_set_blk_dev(), is not supported: it changes the device the
+ * driver has mounted without this layer knowing.
+ *
+ * @filename: the path to the file to open
+ * @return a pointer to the file or NULL on error and errno set appropriately
+ */
+struct fs_file *fs_file_open(const char *filename);
+
+/*
+ * fs_file_read - Read from an open file
+ *
+ * @file: the file, from fs_file_open()
+ * @addr: address of the buffer to write to
+ * @offset: offset in the file from where to start reading
+ * @len: the number of bytes to read. Use 0 to read to the end of the file.
+ * @actread: returns the actual number of bytes read
+ * @return 0 if OK with valid *actread, negative on error
+ */
+int fs_file_read(struct fs_file *file, ulong addr, loff_t offset, loff_t len,
+		 loff_t *actread);
+
+/*
+ * fs_file_size - Determine the size of an open file
+ *
+ * @file: the file, from fs_file_open()
+ * @size: returns the size of the file
+ * @return 0 if ok with valid *size, negative on error
+ */
+int fs_file_size(struct fs_file *file, loff_t *size);
+
+/*
+ * fs_file_close - Close a file
+ *
+ * @file: the file, from fs_file_open()
+ */
+void fs_file_close(struct fs_file *file);
+
 /*
  * fs_unlink - delete a file or directory
  *
@@ -21,6 +21,91 @@ enum iotrace_flags {
 	IOT_WRITE = 1 << 3,
 };
 
+/* Maximum number of address windows which can be traced at once */
+#define IOTRACE_MAX_REGIONS	8
+
+/**
+ * struct iotrace_region - An address window to trace
+ *
+ * @start: Start address of the window
+ * @size: Size of the window in bytes
+ */
+struct iotrace_region {
+	ulong start;
+	ulong size;
+};
+
+/**
+ * enum iotrace_mode - Flags controlling how records are stored
+ *
+ * @IOTRACE_MODE_COMPACT: Store records in the compact format below rather
+ *	than as struct iotrace_record
+ * @IOTRACE_MODE_RING: Overwrite the oldest records when the buffer is full,
+ *	rather than stopping
+ */
+enum iotrace_mode {
+	IOTRACE_MODE_COMPACT	= 1 << 0,
+	IOTRACE_MODE_RING	= 1 << 1,
+};
+
+/*
+ * Compact buffer format
+ *
+ * The buffer starts with a struct iotrace_hdr and is then divided into
+ * blocks of IOTRACE_BLOCK_SIZE bytes. Each block starts with a struct
+ * iotrace_block and holds as many records as fit. A record is:
+ *
+ *	u8	flags (enum iotrace_flags)
+ *	uleb128	timestamp in microseconds, less the previous timestamp
+ *	sleb128	address, less the previous address
+ *	uleb128	value
+ *	sleb128	caller's link-time address, less the previous caller
+ *
+ * where the 'previous record' values are all 0 at the start of each block,
+ * so that blocks can be decoded on their own. In ring mode the block with
+ * the lowest sequence number is reused once the buffer is full, so blocks
+ * should be decoded in order of sequence number.
+ *
+ * Multi-byte fields of the headers are in the target's byte order.
+ */
+#define IOTRACE_MAGIC		0x52544f49	/* "IOTR" */
+#define IOTRACE_VERSION		1
+#define IOTRACE_BLOCK_SIZE	0x400
+
+/**
+ * struct iotrace_hdr - Header at the start of a compact trace buffer
+ *
+ * @magic: IOTRACE_MAGIC
+ * @version: IOTRACE_VERSION
+ * @mode: Mode used to record the trace (enum iotrace_mode)
+ * @block_size: Size of each block in bytes
+ * @block_count: Number of blocks following the header
+ * @long_size: Size of a long on the target in bytes. Timestamps, addresses
+ *	and callers wrap around at this size.
+ */
+struct iotrace_hdr {
+	uint32_t magic;
+	uint16_t version;
+	uint16_t mode;
+	uint32_t block_size;
+	uint32_t block_count;
+	uint32_t long_size;
+};
+
+/**
+ * struct iotrace_block - Header at the start of each block of records
+ *
+ * @seq: Sequence number of the block, starting at 1; 0 if not used yet
+ * @used: Number of bytes of records following this header
+ * @count: Number of records in the block
+ */
+struct iotrace_block {
+	uint32_t seq;
+	uint16_t used;
+	uint16_t count;
+};
+
+#ifndef USE_HOSTCC
 /**
  * struct iotrace_record - Holds a single I/O trace record
  *
@@ -89,13 +174,27 @@ u32 iotrace_get_checksum(void);
  * iotrace_set_region() - Set whether iotrace is limited to a specific
  * io region.
  *
- * Defines the address and size of the limited region.
+ * Defines the address and size of the limited region, replacing any regions
+ * added previously.
  *
  * @start: address of the beginning of the region
  * @size: size of the region in bytes.
  */
 void iotrace_set_region(ulong start, ulong size);
 
+/**
+ * iotrace_add_region() - Add a region to trace
+ *
+ * Accesses are traced if they fall within any of the regions added. If there
+ * are no regions, all accesses are traced.
+ *
+ * @start: address of the beginning of the region
+ * @size: size of the region in bytes
+ * @return 0 if OK, -EINVAL if @size is 0, -ENOSPC if there are already
+ *	IOTRACE_MAX_REGIONS regions
+ */
+int iotrace_add_region(ulong start, ulong size);
+
 /**
  * iotrace_reset_region() - Reset the region limit
  */
@@ -104,11 +203,19 @@ void iotrace_reset_region(void);
 /**
  * iotrace_get_region() - Get region information
  *
- * @start: Returns start address of region
- * @size: Returns size of region in bytes
+ * @start: Returns start address of the first region
+ * @size: Returns size of the first region in bytes, 0 if none
  */
 void iotrace_get_region(ulong *start, ulong *size);
 
+/**
+ * iotrace_get_regions() - Get all the regions being traced
+ *
+ * @regionp: Returns a pointer to the list of regions
+ * @return number of regions in the list
+ */
+int iotrace_get_regions(const struct iotrace_region **regionp);
+
 /**
  * iotrace_set_enabled() - Set whether iotracing is enabled or not
  *
@@ -141,6 +248,46 @@ int iotrace_get_enabled(void);
  */
 void iotrace_set_buffer(ulong start, ulong size);
 
+/**
+ * iotrace_set_mode() - Set how trace records are stored
+ *
+ * This resets the trace buffer, since the records in it may no longer be in
+ * the right format.
+ *
+ * @mode: Mode flags (enum iotrace_mode)
+ */
+void iotrace_set_mode(uint mode);
+
+/**
+ * iotrace_get_mode() - Get how trace records are stored
+ *
+ * @return mode flags (enum iotrace_mode)
+ */
+uint iotrace_get_mode(void);
+
+/**
+ * iotrace_get_overwritten() - Get the number of records lost in ring mode
+ *
+ * @return number of records overwritten since the buffer was set
+ */
+ulong iotrace_get_overwritten(void);
+
+/**
+ * iotrace_walk() - Call a function for each record in the trace buffer
+ *
+ * Records are passed oldest first, decoding them from the compact format if
+ * needed, so the trace can be shown without making a copy of it.
+ *
+ * @func: Function to call for each record. It is passed the record, the
+ *	link-time address of the code which made the access (0 if not known)
+ *	and @priv. It should return 0 to continue, or non-zero to stop.
+ * @priv: Private data for @func
+ * @return 0 if all records were processed, else the non-zero value returned
+ *	by @func
+ */
+int iotrace_walk(int (*func)(struct iotrace_record *rec, ulong caller,
+			     void *priv), void *priv);
+
 /**
  * iotrace_get_buffer() - Get buffer information
  *
@@ -148,9 +295,10 @@ void iotrace_set_buffer(ulong start, ulong size);
  * @size: Returns actual size of buffer in bytes
  * @needed_size: Returns needed size of buffer in bytes
  * @offset: Returns the byte offset where the next output trace record will
- * @count: Returns the number of trace records recorded
  * be written (or would be if the buffer was large enough)
+ * @count: Returns the number of trace records in the buffer
  */
 void iotrace_get_buffer(ulong *start, ulong *size, ulong *needed_size, ulong *offset, ulong *count);
+#endif /* USE_HOSTCC */
 
 #endif /* __IOTRACE_H */
@@ -99,6 +99,8 @@ void nand_wait_ready(struct mtd_info *mtd);
 
 /* Extended commands for large page devices */
 #define NAND_CMD_READSTART	0x30
+#define NAND_CMD_READCACHESEQ	0x31
+#define NAND_CMD_READCACHEEND	0x3f
 #define NAND_CMD_RNDOUTSTART	0xE0
 #define NAND_CMD_CACHEDPROG	0x15
 
@@ -249,6 +251,14 @@ enum nand_ecc_algo {
  * kmap'ed, vmalloc'ed highmem buffers being passed from upper layers
  */
 #define NAND_USE_BOUNCE_BUFFER	0x00100000
+/*
+ * This option could be defined by controller drivers whose ->cmdfunc() can
+ * send NAND_CMD_READCACHESEQ and NAND_CMD_READCACHEEND (as nand_command_lp()
+ * does) and whose ECC read_page methods only read the page data and OOB in
+ * order, so that the core can use cached sequential reads when the chip
+ * supports them.
+ */
+#define NAND_CACHE_READ		0x00200000
 
 /* Options set by nand scan */
 /* bbt has already been read */
@@ -283,7 +293,8 @@ enum nand_ecc_algo {
 /* ONFI subfeature parameters length */
 #define ONFI_SUBFEATURE_PARAM_LEN	4
 
-/* ONFI optional commands SET/GET FEATURES supported? */
+/* ONFI optional commands READ CACHE and SET/GET FEATURES supported? */
+#define ONFI_OPT_CMD_READ_CACHE		(1 << 1)
 #define ONFI_OPT_CMD_SET_GET_FEATURES	(1 << 2)
 
 struct nand_onfi_params {
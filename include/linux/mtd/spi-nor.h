@@ -248,11 +248,41 @@ enum spi_nor_option_flags {
 	SNOR_F_BROKEN_RESET	= BIT(6),
 };
 
+#define SNOR_ERASE_TYPE_MAX	4
+
+/**
+ * struct spi_nor_erase_type - Structure to describe a SPI NOR erase type
+ * @size:		the size of the sector/block erased by the erase type,
+ *			0 if the erase type is not usable
+ * @opcode:		the SPI command op code to erase the sector/block
+ */
+struct spi_nor_erase_type {
+	u32	size;
+	u8	opcode;
+};
+
+/**
+ * struct spi_nor_erase_stats - Erase statistics of a SPI NOR
+ * @erased:		number of bytes erased
+ * @skipped:		number of bytes which were already blank
+ * @ops:		number of erase commands sent
+ * @skipped_ops:	number of erase commands saved by skipping blank areas
+ * @time:		time spent erasing, in milliseconds
+ */
+struct spi_nor_erase_stats {
+	u64	erased;
+	u64	skipped;
+	u32	ops;
+	u32	skipped_ops;
+	ulong	time;
+};
+
 /**
  * struct flash_info - Forward declaration of a structure used internally by
  *		       spi_nor_scan()
  */
 struct flash_info;
+struct spi_mem_dirmap_desc;
 
 /*
  * TODO: Remove, once all users of spi_flash interface are moved to MTD
@@ -273,6 +303,10 @@ struct flash_info;
  * @page_size:		the page size of the SPI NOR
  * @addr_width:		number of address bytes
  * @erase_opcode:	the opcode for erasing a sector
+ * @erase_types:	erase types larger than the erase size, from the
+ *			largest to the smallest, which spi_nor_erase() uses to
+ *			erase large aligned areas with fewer commands
+ * @erase_stats:	erase statistics
  * @read_opcode:	the read opcode
  * @read_dummy:		the dummy needed by the read operation
  * @program_opcode:	the program opcode
@@ -301,6 +335,8 @@ struct flash_info;
  * @flash_is_locked:	[FLASH-SPECIFIC] check if a region of the SPI NOR is
  * @quad_enable:	[FLASH-SPECIFIC] enables SPI NOR quad mode
  *			completely locked
+ * @dirmap:		direct mapping of the flash, used for reads when the
+ *			SPI controller supports it
  * @priv:		the private data
  */
 struct spi_nor {
@@ -312,6 +348,8 @@ struct spi_nor {
 	u32			page_size;
 	u8			addr_width;
 	u8			erase_opcode;
+	struct spi_nor_erase_type erase_types[SNOR_ERASE_TYPE_MAX];
+	struct spi_nor_erase_stats erase_stats;
 	u8			read_opcode;
 	u8			read_dummy;
 	u8			program_opcode;
@@ -343,6 +381,12 @@ struct spi_nor {
 	int (*flash_is_locked)(struct spi_nor *nor, loff_t ofs, uint64_t len);
 	int (*quad_enable)(struct spi_nor *nor);
 
+#if CONFIG_IS_ENABLED(SPI_DIRMAP)
+	struct {
+		struct spi_mem_dirmap_desc *rdesc;
+	} dirmap;
+#endif
+
 	void *priv;
 /* Compatibility for spi_flash, remove once sf layer is merged with mtd */
 	const char *name;
@@ -436,4 +480,10 @@ struct spi_nor_hwcaps {
  */
 int spi_nor_scan(struct spi_nor *nor);
 
+/**
+ * spi_nor_remove() - release the resources set up by spi_nor_scan()
+ * @nor:	the spi_nor structure
+ */
+void spi_nor_remove(struct spi_nor *nor);
+
 #endif
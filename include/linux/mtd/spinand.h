@@ -69,6 +69,18 @@
 		   SPI_MEM_OP_NO_DUMMY,					\
 		   SPI_MEM_OP_NO_DATA)
 
+#define SPINAND_PAGE_READ_CACHE_SEQ_OP					\
+	SPI_MEM_OP(SPI_MEM_OP_CMD(0x31, 1),				\
+		   SPI_MEM_OP_NO_ADDR,					\
+		   SPI_MEM_OP_NO_DUMMY,					\
+		   SPI_MEM_OP_NO_DATA)
+
+#define SPINAND_PAGE_READ_CACHE_LAST_OP					\
+	SPI_MEM_OP(SPI_MEM_OP_CMD(0x3f, 1),				\
+		   SPI_MEM_OP_NO_ADDR,					\
+		   SPI_MEM_OP_NO_DUMMY,					\
+		   SPI_MEM_OP_NO_DATA)
+
 #define SPINAND_PAGE_READ_FROM_CACHE_OP(fast, addr, ndummy, buf, len)	\
 	SPI_MEM_OP(SPI_MEM_OP_CMD(fast ? 0x0b : 0x03, 1),		\
 		   SPI_MEM_OP_ADDR(2, addr, 1),				\
@@ -245,6 +257,25 @@ struct spinand_ecc_info {
 };
 
 #define SPINAND_HAS_QE_BIT		BIT(0)
+#define SPINAND_HAS_READ_CACHE_SEQ	BIT(1)
+
+/**
+ * enum spinand_read_mode - how consecutive pages are read
+ * @SPINAND_READ_PAGE: PAGE READ, wait for tR, then READ FROM CACHE, for each
+ *		       page
+ * @SPINAND_READ_CACHE_SEQ: READ PAGE CACHE SEQUENTIAL, which loads the next
+ *			    page into the data register while the current one
+ *			    is read from the cache
+ * @SPINAND_READ_CONT: continuous read, where a single READ FROM CACHE
+ *		       streams the main area of consecutive pages
+ * @SPINAND_READ_MODES: number of read modes
+ */
+enum spinand_read_mode {
+	SPINAND_READ_PAGE,
+	SPINAND_READ_CACHE_SEQ,
+	SPINAND_READ_CONT,
+	SPINAND_READ_MODES,
+};
 
 /**
  * struct spinand_info - Structure used to describe SPI NAND chips
@@ -260,6 +291,10 @@ struct spinand_ecc_info {
  * @op_variants.update_cache: variants of the update-cache operation
  * @select_target: function used to select a target/die. Required only for
  *		   multi-die chips
+ * @set_cont_read: function used to enter or leave continuous read mode.
+ *		   Required only for chips supporting it
+ * @cont_read_variants: variants of the read-from-cache operation in
+ *			continuous read mode. Required with @set_cont_read
  *
  * Each SPI NAND manufacturer driver should have a spinand_info table
  * describing all the chips supported by the driver.
@@ -278,6 +313,8 @@ struct spinand_info {
 	} op_variants;
 	int (*select_target)(struct spinand_device *spinand,
 			     unsigned int target);
+	int (*set_cont_read)(struct spinand_device *spinand, bool enable);
+	const struct spinand_op_variants *cont_read_variants;
 };
 
 #define SPINAND_INFO_OP_VARIANTS(__read, __write, __update)		\
@@ -296,6 +333,10 @@ struct spinand_info {
 #define SPINAND_SELECT_TARGET(__func)					\
 	.select_target = __func,
 
+#define SPINAND_CONT_READ(__func, __variants)				\
+	.set_cont_read = __func,					\
+	.cont_read_variants = __variants,
+
 #define SPINAND_INFO(__model, __id, __memorg, __eccreq, __op_variants,	\
 		     __flags, ...)					\
 	{								\
@@ -319,10 +360,14 @@ struct spinand_info {
  * @op_templates.read_cache: read cache op template
  * @op_templates.write_cache: write cache op template
  * @op_templates.update_cache: update cache op template
+ * @op_templates.cont_read: read cache op template in continuous read mode
  * @select_target: select a specific target/die. Usually called before sending
  *		   a command addressing a page or an eraseblock embedded in
  *		   this die. Only required if your chip exposes several dies
  * @cur_target: currently selected target/die
+ * @set_cont_read: enter or leave continuous read mode, NULL if the chip or
+ *		   the controller does not support it
+ * @read_mode: how consecutive pages are read
  * @eccinfo: on-die ECC information
  * @cfg_cache: config register cache. One entry per die
  * @databuf: bounce buffer for data
@@ -349,11 +394,14 @@ struct spinand_device {
 		const struct spi_mem_op *read_cache;
 		const struct spi_mem_op *write_cache;
 		const struct spi_mem_op *update_cache;
+		const struct spi_mem_op *cont_read;
 	} op_templates;
 
 	int (*select_target)(struct spinand_device *spinand,
 			     unsigned int target);
 	unsigned int cur_target;
+	int (*set_cont_read)(struct spinand_device *spinand, bool enable);
+	enum spinand_read_mode read_mode;
 
 	struct spinand_ecc_info eccinfo;
 
@@ -429,5 +477,7 @@ int spinand_match_and_init(struct spinand_device *dev,
 
 int spinand_upd_cfg(struct spinand_device *spinand, u8 mask, u8 val);
 int spinand_select_target(struct spinand_device *spinand, unsigned int target);
+int spinand_mtd_set_read_mode(struct mtd_info *mtd,
+			      enum spinand_read_mode mode);
 
 #endif /* __LINUX_MTD_SPINAND_H */
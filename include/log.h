@@ -10,6 +10,7 @@
 #define __LOG_H
 
 #include <command.h>
+#include <stdarg.h>
 #include <dm/uclass-id.h>
 #include <linux/list.h>
 
@@ -278,7 +279,10 @@ void __assert_fail(const char *assertion, const char *file, unsigned int line,
  * @file: Name of file where the log record was generated (not allocated)
  * @line: Line number where the log record was generated
  * @func: Function where the log record was generated (not allocated)
- * @msg: Log message (allocated)
+ * @msg: Log message (allocated). This is only set up for drivers which do not
+ *	have LOGDF_RAW
+ * @fmt: printf()-style format string for the message (not allocated)
+ * @args: Arguments for @fmt. Drivers must use va_copy() to access these
  */
 struct log_rec {
 	enum log_category_t cat;
@@ -287,6 +291,14 @@ struct log_rec {
 	int line;
 	const char *func;
 	const char *msg;
+	const char *fmt;
+	va_list *args;
+};
+
+/* Log driver flags */
+enum log_driver_flags {
+	/* Driver uses @fmt and @args itself, so @msg need not be formatted */
+	LOGDF_RAW	= 1 << 0,
 };
 
 struct log_device;
@@ -295,9 +307,11 @@ struct log_device;
  * struct log_driver - a driver which accepts and processes log records
  *
  * @name: Name of driver
+ * @flags: Flags for this driver (LOGDF_...)
  */
 struct log_driver {
 	const char *name;
+	unsigned short flags;
 	/**
 	 * emit() - emit a log record
 	 *
@@ -441,6 +455,32 @@ int log_add_filter(const char *drv_name, enum log_category_t cat_list[],
  */
 int log_remove_filter(const char *drv_name, int filter_num);
 
+#if CONFIG_IS_ENABLED(LOG_BINARY)
+/**
+ * log_binary_dump() - Print the records held by the binary log driver
+ *
+ * The records are formatted now, according to gd->log_fmt, and preceded by
+ * the time they were logged.
+ */
+void log_binary_dump(void);
+
+/**
+ * log_binary_export() - Pass the binary log on to the next stage
+ *
+ * This formats the records held by the binary log driver into a
+ * NUL-terminated string in a BLOBLISTT_LOG blob, so that they can be read
+ * by the OS. It does nothing if bloblist support is not enabled.
+ *
+ * @return 0 if OK, -ENOSPC if there is no space in the bloblist
+ */
+int log_binary_export(void);
+#else
+static inline int log_binary_export(void)
+{
+	return 0;
+}
+#endif
+
 #if CONFIG_IS_ENABLED(LOG)
 /**
  * log_init() - Set up the log system ready for use
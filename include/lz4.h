@@ -21,4 +21,34 @@
  */
 int ulz4fn(const void *src, size_t srcn, void *dst, size_t *dstn);
 
+/**
+ * ulz4fn_range() - Decompress part of an LZ4 frame
+ *
+ * This decompresses up to @dstn bytes of the uncompressed data, starting at
+ * @offset. Blocks before the range are skipped without being decompressed,
+ * and decompression stops once the range is complete, so only the blocks
+ * covering the range are decompressed. A block which is only partly wanted is
+ * decompressed into a temporary buffer allocated with malloc().
+ *
+ * Skipping relies on every block except the last one holding exactly the
+ * frame's maximum block size of uncompressed data. A frame which breaks this
+ * rule is rejected with -EPROTO.
+ *
+ * Neither block nor content checksums are verified, by this function or by
+ * ulz4fn(). Callers which need integrity checking should rely on a hash over
+ * the compressed data, such as the one in a FIT image.
+ *
+ * @src: Source data to decompress
+ * @srcn: Length of source data
+ * @offset: Offset within the uncompressed data of the first byte to return
+ * @dst: Destination for uncompressed data
+ * @dstn: Number of bytes to decompress; returns the number of bytes actually
+ *	written, which is less if the uncompressed data ends first
+ * @return 0 if OK, -ENOMEM if a temporary buffer could not be allocated,
+ *	-EPROTO if a block other than the last is short, or another -ve error
+ *	code as for ulz4fn()
+ */
+int ulz4fn_range(const void *src, size_t srcn, size_t offset, void *dst,
+		 size_t *dstn);
+
 #endif
@@ -978,6 +978,71 @@ extern ulong mem_malloc_brk;
 
 void mem_malloc_init(ulong start, ulong size);
 
+/* Largest chunk size, in bytes, kept in a size class by the fast bins */
+#define MALLOC_FAST_MAX		256
+
+/**
+ * struct malloc_class_stats - Counters for one small-allocation size class
+ *
+ * Entry n of the array returned by malloc_get_class_stats() covers chunks of
+ * n * 8 bytes, which includes malloc()'s own overhead. Chunks are a multiple
+ * of twice the size of size_t, so on 64-bit machines only the even entries
+ * are used.
+ *
+ * @allocs: Number of allocations which fell in this class
+ * @hits: Number of those which were satisfied from the class's free list
+ * @frees: Number of chunks put on the class's free list
+ * @cached: Number of chunks currently on the class's free list
+ */
+struct malloc_class_stats {
+	ulong allocs;
+	ulong hits;
+	ulong frees;
+	ulong cached;
+};
+
+/**
+ * struct malloc_heap_info - Summary of the state of the malloc() heap
+ *
+ * @total: Size of the malloc() area in bytes
+ * @brk: Bytes of the area currently used by the heap
+ * @brk_peak: High-water mark of @brk
+ * @inuse: Bytes in allocated chunks
+ * @free: Bytes in free chunks, including the top chunk
+ * @free_chunks: Number of free chunks, including the top chunk
+ * @largest_free: Size of the largest free chunk in bytes
+ * @cached: Bytes in chunks held on size-class free lists
+ */
+struct malloc_heap_info {
+	ulong total;
+	ulong brk;
+	ulong brk_peak;
+	ulong inuse;
+	ulong free;
+	ulong free_chunks;
+	ulong largest_free;
+	ulong cached;
+};
+
+/**
+ * malloc_get_heap_info() - Get a summary of the malloc() heap
+ *
+ * This walks the free lists, so it takes time proportional to the number of
+ * free chunks.
+ *
+ * @info: Returns the heap summary
+ */
+void malloc_get_heap_info(struct malloc_heap_info *info);
+
+/**
+ * malloc_get_class_stats() - Get the small-allocation size class counters
+ *
+ * @statsp: Returns a pointer to the array of counters
+ * @return number of entries in the array, or 0 if size classes are not
+ *	enabled (CONFIG_SYS_MALLOC_FAST_BINS)
+ */
+int malloc_get_class_stats(const struct malloc_class_stats **statsp);
+
 #ifdef __cplusplus
 };  /* end of extern "C" */
 #endif
@@ -45,6 +45,17 @@ struct hsearch_data {
 	struct env_entry_node *table;
 	unsigned int size;
 	unsigned int filled;
+	unsigned int deleted;		/* deleted slots in table */
+	/* old table while resizing, with the next slot to move over */
+	struct env_entry_node *old_table;
+	unsigned int old_size;
+	unsigned int rehash_idx;
+	/* entries in key order, see hexport_r() */
+	struct env_entry **sorted;
+	unsigned int nsorted;
+	unsigned int sorted_ok;		/* leading entries known to be sorted */
+	unsigned int sorted_max;
+	unsigned int mark;		/* generation of the last import */
 /*
  * Callback function which will check whether the given change for variable
  * "item" to "newval" may be applied or not, and possibly apply such change.
@@ -96,6 +107,19 @@ int himport_r(struct hsearch_data *htab, const char *env, size_t size,
 int hwalk_r(struct hsearch_data *htab,
 	    int (*callback)(struct env_entry *entry));
 
+/** struct hsearch_stat - Hash table statistics, see hstat_r() */
+struct hsearch_stat {
+	unsigned int size;		/* number of slots */
+	unsigned int filled;		/* number of entries */
+	unsigned int deleted;		/* number of deleted slots */
+	unsigned int old_size;		/* slots of old table while resizing */
+	unsigned int probe_max;		/* longest probe sequence of an entry */
+	unsigned long probe_total;	/* total probe length of all entries */
+};
+
+/* Collect statistics about the table, e.g. the probe lengths */
+void hstat_r(struct hsearch_data *htab, struct hsearch_stat *stat);
+
 /* Flags for himport_r(), hexport_r(), hdelete_r(), and hsearch_r() */
 #define H_NOCLEAR	(1 << 0) /* do not clear hash table before importing */
 #define H_FORCE		(1 << 1) /* overwrite read-only/write-once variables */
@@ -191,6 +191,22 @@ struct dm_serial_ops {
 	 * @return 0 if OK, -ve on error
 	 */
 	int (*putc)(struct udevice *dev, const char ch);
+	/**
+	 * puts() - Write a string
+	 *
+	 * This writes as many characters as the UART can take without
+	 * waiting, e.g. by filling the TX FIFO. It is optional and only worth
+	 * implementing if that is faster than calling putc() for each
+	 * character. The string does not contain newlines which need to be
+	 * expanded: the uclass takes care of that.
+	 *
+	 * @dev: Device pointer
+	 * @s: String to write
+	 * @len: Number of characters to write (at least 1)
+	 * @return number of characters written, which may be fewer than
+	 * @len, or 0 or -EAGAIN if there is no room yet, other -ve on error
+	 */
+	ssize_t (*puts)(struct udevice *dev, const char *s, size_t len);
 	/**
 	 * pending() - Check if input/output characters are waiting
 	 *
@@ -270,6 +286,11 @@ struct dm_serial_ops {
  * @buf:	Pointer to the RX buffer
  * @rd_ptr:	Read pointer in the RX buffer
  * @wr_ptr:	Write pointer in the RX buffer
+ *
+ * @tx_buf:	Pointer to the TX buffer
+ * @tx_rd_ptr:	Number of characters sent from the TX buffer
+ * @tx_wr_ptr:	Number of characters added to the TX buffer
+ * @tx_stopped:	true if output goes directly to the UART, after serial_flush()
  */
 struct serial_dev_priv {
 	struct stdio_dev *sdev;
@@ -277,6 +298,11 @@ struct serial_dev_priv {
 	char *buf;
 	int rd_ptr;
 	int wr_ptr;
+
+	char *tx_buf;
+	uint tx_rd_ptr;
+	uint tx_wr_ptr;
+	bool tx_stopped;
 };
 
 /* Access the serial operations for a device */
@@ -315,6 +341,36 @@ int serial_setconfig(struct udevice *dev, uint config);
  */
 int serial_getinfo(struct udevice *dev, struct serial_device_info *info);
 
+#if CONFIG_IS_ENABLED(SERIAL_TX_BUFFER)
+/**
+ * serial_flush() - Send all buffered output and stop buffering
+ *
+ * With CONFIG_SERIAL_TX_BUFFER output is queued while the UART is busy and
+ * sent whenever the console is used or polled. This sends what is left and
+ * makes later output wait for the UART again, so that nothing is left
+ * behind when U-Boot hands over control, e.g. to an OS, or resets.
+ *
+ * Call serial_resume_buffer() if control comes back to U-Boot.
+ */
+void serial_flush(void);
+
+/**
+ * serial_resume_buffer() - Start buffering output again
+ *
+ * This undoes serial_flush(), e.g. when a booted image returns or fails to
+ * start.
+ */
+void serial_resume_buffer(void);
+#else
+static inline void serial_flush(void)
+{
+}
+
+static inline void serial_resume_buffer(void)
+{
+}
+#endif
+
 void atmel_serial_initialize(void);
 void mcf_serial_initialize(void);
 void mpc85xx_serial_initialize(void);
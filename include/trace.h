@@ -28,6 +28,7 @@ enum {
 enum trace_chunk_type {
 	TRACE_CHUNK_FUNCS,
 	TRACE_CHUNK_CALLS,
+	TRACE_CHUNK_TIMEBASE,	/* rec_count is the timestamp rate in Hz */
 };
 
 /* A trace record for a function, as written to the profile output file */
@@ -70,15 +71,71 @@ enum ftrace_flags {
 
 #define TRACE_CALL_TYPE(call)	((call)->flags & 0xc0000000UL)
 
+/* Get the full timestamp of a call, in units of the trace timebase */
+#define TRACE_CALL_TIME(call)	((uint64_t)(call)->time_hi << 30 | \
+				 ((call)->flags & FUNCF_TIMESTAMP_MASK))
+
 /* Information about a single function entry/exit */
 struct trace_call {
 	uint32_t func;		/* Function offset */
 	uint32_t caller;	/* Caller function offset */
-	uint32_t flags;		/* Flags and timestamp */
+	uint32_t flags;		/* Flags and timestamp bits 29:0 */
+	uint32_t time_hi;	/* Timestamp bits 61:30 */
 };
 
+/**
+ * trace_list_calls() - Dump the list of function calls into a buffer
+ *
+ * This writes a TRACE_CHUNK_TIMEBASE header giving the rate of the
+ * timestamps, followed by a TRACE_CHUNK_CALLS header and the call records in
+ * the order they were made.
+ *
+ * @buff:	Buffer in which to place data, or NULL to count size
+ * @buff_size:	Size of buffer
+ * @needed:	Returns number of bytes used / needed
+ * Return: 0 if ok, -ENOSPC if the buffer is too small
+ */
 int trace_list_calls(void *buff, size_t buff_size, size_t *needed);
 
+/**
+ * trace_get_timestamp() - Get the timestamp for a trace record
+ *
+ * This defaults to timer_get_us(). Architectures with a cheap free-running
+ * counter may override it, along with trace_get_timestamp_rate(), if
+ * CONFIG_TRACE_TIMESTAMP_COUNTER is enabled. It must not be instrumented.
+ *
+ * Return: current timestamp
+ */
+uint64_t trace_get_timestamp(void);
+
+/**
+ * trace_get_timestamp_rate() - Get the rate of trace_get_timestamp()
+ *
+ * Return: number of timestamp units per second
+ */
+ulong trace_get_timestamp_rate(void);
+
+/**
+ * trace_add_filter() - Add a range of functions to the trace filter
+ *
+ * Function calls are only added to the call list if they are within one of
+ * the allowed ranges (or there are none), and not within any denied range.
+ * Calls are still counted in the function list either way.
+ *
+ * @start:	Start address of range (as in System.map)
+ * @end:	End address of range (exclusive)
+ * @allow:	1 to allow this range, 0 to deny it
+ * Return: 0 if ok, -ENOENT if trace is not set up, -ENOSPC if there are too
+ *	many ranges already, -EINVAL if the range is empty
+ */
+int trace_add_filter(ulong start, ulong end, int allow);
+
+/* Remove all ranges from the trace filter */
+void trace_clear_filter(void);
+
+/* Print the trace filter ranges */
+void trace_print_filter(void);
+
 /**
  * Turn function tracing on and off
  *
@@ -73,6 +73,14 @@ enum video_log2_bpp {
  * @cmap:	Colour map for 8-bit-per-pixel displays
  * @fg_col_idx:	Foreground color code (bit 3 = bold, bit 0-2 = color)
  * @bg_col_idx:	Background color code (bit 3 = bold, bit 0-2 = color)
+ * @damage:	Area of the frame buffer written since the last sync, in
+ *		pixels. xend and yend are exclusive; the area is empty if
+ *		xstart >= xend. This is set up by video_damage() and used
+ *		(then reset) by video_sync()
+ * @fb_exposed:	true if other software, such as an EFI application using the
+ *		GOP frame buffer, may write to the frame buffer directly. Such
+ *		writes are not reported as damage, so video_sync() then always
+ *		syncs the whole frame buffer
  */
 struct video_priv {
 	/* Things set up by the driver: */
@@ -96,10 +104,28 @@ struct video_priv {
 	ushort *cmap;
 	u8 fg_col_idx;
 	u8 bg_col_idx;
+#ifdef CONFIG_VIDEO_DAMAGE
+	struct {
+		int xstart;
+		int ystart;
+		int xend;
+		int yend;
+	} damage;
+	bool fb_exposed;
+#endif
 };
 
-/* Placeholder - there are no video operations at present */
+/**
+ * struct video_ops - Video operations
+ *
+ * @video_sync:	Optional. Update the display from the frame buffer, e.g. by
+ *		sending the damaged area (see &video_priv.damage, which is
+ *		still valid when this is called) to the panel. Called by
+ *		video_sync() after any cache flush. Returns 0 if OK, -ve on
+ *		error
+ */
 struct video_ops {
+	int (*video_sync)(struct udevice *vid);
 };
 
 #define video_get_ops(dev)        ((struct video_ops *)(dev)->driver->ops)
@@ -130,6 +156,27 @@ int video_reserve(ulong *addrp);
  */
 int video_clear(struct udevice *dev);
 
+#ifdef CONFIG_VIDEO_DAMAGE
+/**
+ * video_damage() - Note that part of the frame buffer has been written
+ *
+ * This grows the device's damage area to include the given rectangle, so that
+ * the next video_sync() flushes it. The rectangle is clipped to the display.
+ *
+ * @vid:	Video device
+ * @x:		X position of the rectangle in pixels from the left
+ * @y:		Y position of the rectangle in pixels from the top
+ * @width:	Width of the rectangle in pixels
+ * @height:	Height of the rectangle in pixels
+ */
+void video_damage(struct udevice *vid, int x, int y, int width, int height);
+#else
+static inline void video_damage(struct udevice *vid, int x, int y, int width,
+				int height)
+{
+}
+#endif
+
 /**
  * video_sync() - Sync a device's frame buffer with its hardware
  *
@@ -137,6 +184,10 @@ int video_clear(struct udevice *dev);
  * function syncs these up so that the current contents of the U-Boot frame
  * buffer are displayed to the user.
  *
+ * With CONFIG_VIDEO_DAMAGE only the area passed to video_damage() since the
+ * last sync is flushed, unless the frame buffer is exposed (see
+ * &video_priv.fb_exposed).
+ *
  * @dev:	Device to sync
  * @force:	True to force a sync even if there was one recently (this is
  *		very expensive on sandbox)
@@ -84,6 +84,23 @@ struct vidconsole_priv {
 	char escape_buf[32];
 };
 
+/**
+ * struct vidconsole_cache_stats - Glyph cache statistics
+ *
+ * @hits:	Number of characters drawn from the cache
+ * @misses:	Number of characters which had to be rendered
+ * @entries:	Number of glyphs in the cache
+ * @max_entries:	Maximum number of glyphs in the cache
+ * @bytes:	Memory used by cached glyph images, in bytes
+ */
+struct vidconsole_cache_stats {
+	ulong hits;
+	ulong misses;
+	uint entries;
+	uint max_entries;
+	ulong bytes;
+};
+
 /**
  * struct vidconsole_ops - Video console operations
  *
@@ -155,6 +172,19 @@ struct vidconsole_ops {
 	 * characters.
 	 */
 	int (*backspace)(struct udevice *dev);
+
+	/**
+	 * get_cache_stats() - Get glyph cache statistics
+	 *
+	 * This optional method is implemented by consoles which keep a
+	 * cache of rendered characters.
+	 *
+	 * @dev:	Device to check
+	 * @stats:	Returns the statistics
+	 * @return 0 if OK, -ve on error
+	 */
+	int (*get_cache_stats)(struct udevice *dev,
+			       struct vidconsole_cache_stats *stats);
 };
 
 /* Get a pointer to the driver operations for a video console device */
@@ -198,6 +228,17 @@ int vidconsole_move_rows(struct udevice *dev, uint rowdst, uint rowsrc,
  */
 int vidconsole_set_row(struct udevice *dev, uint row, int clr);
 
+/**
+ * vidconsole_get_cache_stats() - Get glyph cache statistics
+ *
+ * @dev:	Device to check
+ * @stats:	Returns the statistics
+ * @return 0 if OK, -ENOSYS if the console does not cache glyphs, other -ve
+ * on error
+ */
+int vidconsole_get_cache_stats(struct udevice *dev,
+			       struct vidconsole_cache_stats *stats);
+
 /**
  * vidconsole_put_char() - Output a character to the current console position
  *
@@ -15,6 +15,7 @@
 #include <u-boot/crc.h>
 #include <bootm.h>
 #include <pe.h>
+#include <serial.h>
 #include <u-boot/crc.h>
 #include <watchdog.h>
 
@@ -29,8 +30,38 @@ LIST_HEAD(efi_obj_list);
 /* List of all events */
 __efi_runtime_data LIST_HEAD(efi_events);
 
-/* List of queued events */
-LIST_HEAD(efi_event_queue);
+/* Events which belong to an event group */
+static LIST_HEAD(efi_group_events);
+
+/*
+ * Queues of signaled events waiting for their notification function to be
+ * called, one per task priority level (see efi_tpl_queue())
+ */
+#define EFI_TPL_QUEUES	4
+static struct list_head efi_event_queue[EFI_TPL_QUEUES] = {
+	LIST_HEAD_INIT(efi_event_queue[0]),
+	LIST_HEAD_INIT(efi_event_queue[1]),
+	LIST_HEAD_INIT(efi_event_queue[2]),
+	LIST_HEAD_INIT(efi_event_queue[3]),
+};
+
+/*
+ * Armed timer events, as a binary min-heap ordered by trigger time. The
+ * heap is stored from index 1, so that event->timer_index is 0 for an
+ * event which is not armed.
+ */
+static struct efi_event **efi_timer_heap;
+static unsigned int efi_timer_count;
+/* Number of timer events, for which room is kept in the heap */
+static unsigned int efi_timer_events;
+static unsigned int efi_timer_max;
+
+/* Recently validated events, see efi_is_event() */
+static const struct efi_event *efi_event_cache[4];
+static unsigned int efi_event_cache_next;
+
+/* Number of times efi_timer_check() was called */
+static u64 efi_event_loops;
 
 /* Flag to disable timer activity in ExitBootServices() */
 static bool timers_enabled = true;
@@ -171,16 +202,41 @@ static bool efi_event_is_queued(struct efi_event *event)
 	return !!event->queue_link.next;
 }
 
+/**
+ * efi_tpl_queue() - get the event queue for a task priority level
+ *
+ * @tpl:	task priority level
+ * Return:	index into efi_event_queue[]
+ */
+static int efi_tpl_queue(efi_uintn_t tpl)
+{
+	if (tpl >= TPL_HIGH_LEVEL)
+		return 3;
+	if (tpl >= TPL_NOTIFY)
+		return 2;
+	if (tpl >= TPL_CALLBACK)
+		return 1;
+	return 0;
+}
+
 /**
  * efi_process_event_queue() - process event queue
  */
 static void efi_process_event_queue(void)
 {
-	while (!list_empty(&efi_event_queue)) {
+	for (;;) {
 		struct efi_event *event;
 		efi_uintn_t old_tpl;
+		int i;
 
-		event = list_first_entry(&efi_event_queue, struct efi_event,
+		/* Take the first event of the highest task priority level */
+		for (i = EFI_TPL_QUEUES - 1; i >= 0; i--) {
+			if (!list_empty(&efi_event_queue[i]))
+				break;
+		}
+		if (i < 0)
+			return;
+		event = list_first_entry(&efi_event_queue[i], struct efi_event,
 					 queue_link);
 		if (efi_tpl >= event->notify_tpl)
 			return;
@@ -208,30 +264,98 @@ static void efi_process_event_queue(void)
  */
 static void efi_queue_event(struct efi_event *event)
 {
-	struct efi_event *item;
-
 	if (!event->notify_function)
 		return;
 
-	if (!efi_event_is_queued(event)) {
-		/*
-		 * Events must be notified in order of decreasing task priority
-		 * level. Insert the new event accordingly.
-		 */
-		list_for_each_entry(item, &efi_event_queue, queue_link) {
-			if (item->notify_tpl < event->notify_tpl) {
-				list_add_tail(&event->queue_link,
-					      &item->queue_link);
-				event = NULL;
-				break;
-			}
-		}
-		if (event)
-			list_add_tail(&event->queue_link, &efi_event_queue);
-	}
+	/*
+	 * Events must be notified in order of decreasing task priority
+	 * level, so each level has its own queue.
+	 */
+	if (!efi_event_is_queued(event))
+		list_add_tail(&event->queue_link,
+			      &efi_event_queue[efi_tpl_queue(event->notify_tpl)]);
 	efi_process_event_queue();
 }
 
+/**
+ * efi_timer_place() - put a timer event at a position in the timer heap
+ *
+ * @event:	timer event
+ * @idx:	position in the heap
+ */
+static void efi_timer_place(struct efi_event *event, unsigned int idx)
+{
+	efi_timer_heap[idx] = event;
+	event->timer_index = idx;
+}
+
+/**
+ * efi_timer_fix() - restore the heap order after a trigger time changed
+ *
+ * @idx:	position in the heap of the timer event whose trigger time
+ *		changed
+ */
+static void efi_timer_fix(unsigned int idx)
+{
+	struct efi_event *event = efi_timer_heap[idx];
+	unsigned int child;
+
+	/* Move up while due before the parent */
+	while (idx > 1 &&
+	       event->trigger_next < efi_timer_heap[idx / 2]->trigger_next) {
+		efi_timer_place(efi_timer_heap[idx / 2], idx);
+		idx /= 2;
+	}
+
+	/* Move down while due after a child */
+	while ((child = 2 * idx) <= efi_timer_count) {
+		if (child < efi_timer_count &&
+		    efi_timer_heap[child + 1]->trigger_next <
+		    efi_timer_heap[child]->trigger_next)
+			child++;
+		if (event->trigger_next <= efi_timer_heap[child]->trigger_next)
+			break;
+		efi_timer_place(efi_timer_heap[child], idx);
+		idx = child;
+	}
+	efi_timer_place(event, idx);
+}
+
+/**
+ * efi_timer_arm() - add a timer event to the timer heap
+ *
+ * If the event is armed already, only its position is updated for its new
+ * trigger time.
+ *
+ * @event:	timer event
+ */
+static void efi_timer_arm(struct efi_event *event)
+{
+	if (!event->timer_index)
+		efi_timer_place(event, ++efi_timer_count);
+	efi_timer_fix(event->timer_index);
+}
+
+/**
+ * efi_timer_disarm() - remove a timer event from the timer heap
+ *
+ * @event:	timer event
+ */
+static void efi_timer_disarm(struct efi_event *event)
+{
+	unsigned int idx = event->timer_index;
+	struct efi_event *last;
+
+	if (!idx)
+		return;
+	event->timer_index = 0;
+	last = efi_timer_heap[efi_timer_count--];
+	if (idx <= efi_timer_count) {
+		efi_timer_place(last, idx);
+		efi_timer_fix(idx);
+	}
+}
+
 /**
  * is_valid_tpl() - check if the task priority level is valid
  *
@@ -272,15 +396,15 @@ void efi_signal_event(struct efi_event *event)
 		 * The signaled state has to set before executing any
 		 * notification function
 		 */
-		list_for_each_entry(evt, &efi_events, link) {
-			if (!evt->group || guidcmp(evt->group, event->group))
+		list_for_each_entry(evt, &efi_group_events, group_link) {
+			if (guidcmp(evt->group, event->group))
 				continue;
 			if (evt->is_signaled)
 				continue;
 			evt->is_signaled = true;
 		}
-		list_for_each_entry(evt, &efi_events, link) {
-			if (!evt->group || guidcmp(evt->group, event->group))
+		list_for_each_entry(evt, &efi_group_events, group_link) {
+			if (guidcmp(evt->group, event->group))
 				continue;
 			efi_queue_event(evt);
 		}
@@ -610,12 +734,23 @@ void efi_delete_handle(efi_handle_t handle)
 static efi_status_t efi_is_event(const struct efi_event *event)
 {
 	const struct efi_event *evt;
+	int i;
 
 	if (!event)
 		return EFI_INVALID_PARAMETER;
+
+	/* Applications tend to poll the same few events over and over */
+	for (i = 0; i < ARRAY_SIZE(efi_event_cache); i++) {
+		if (efi_event_cache[i] == event)
+			return EFI_SUCCESS;
+	}
+
 	list_for_each_entry(evt, &efi_events, link) {
-		if (evt == event)
+		if (evt == event) {
+			efi_event_cache[efi_event_cache_next++ %
+					ARRAY_SIZE(efi_event_cache)] = event;
 			return EFI_SUCCESS;
+		}
 	}
 	return EFI_INVALID_PARAMETER;
 }
@@ -672,6 +807,18 @@ efi_status_t efi_create_event(uint32_t type, efi_uintn_t notify_tpl,
 	    (!notify_function || is_valid_tpl(notify_tpl) != EFI_SUCCESS))
 		return EFI_INVALID_PARAMETER;
 
+	/* Keep room in the timer heap so that arming a timer cannot fail */
+	if ((type & EVT_TIMER) && efi_timer_events == efi_timer_max) {
+		unsigned int max = efi_timer_max ? 2 * efi_timer_max : 16;
+		struct efi_event **heap;
+
+		heap = realloc(efi_timer_heap, (max + 1) * sizeof(*heap));
+		if (!heap)
+			return EFI_OUT_OF_RESOURCES;
+		efi_timer_heap = heap;
+		efi_timer_max = max;
+	}
+
 	ret = efi_allocate_pool(pool_type, sizeof(struct efi_event),
 				(void **)&evt);
 	if (ret != EFI_SUCCESS)
@@ -685,6 +832,10 @@ efi_status_t efi_create_event(uint32_t type, efi_uintn_t notify_tpl,
 	/* Disable timers on boot up */
 	evt->trigger_next = -1ULL;
 	list_add_tail(&evt->link, &efi_events);
+	if (group)
+		list_add_tail(&evt->group_link, &efi_group_events);
+	if (type & EVT_TIMER)
+		efi_timer_events++;
 	*event = evt;
 	return EFI_SUCCESS;
 }
@@ -775,30 +926,58 @@ static efi_status_t EFIAPI efi_create_event_ext(
 void efi_timer_check(void)
 {
 	struct efi_event *evt;
-	u64 now = timer_get_us();
-
-	list_for_each_entry(evt, &efi_events, link) {
-		if (!timers_enabled)
-			continue;
-		if (!(evt->type & EVT_TIMER) || now < evt->trigger_next)
-			continue;
-		switch (evt->trigger_type) {
-		case EFI_TIMER_RELATIVE:
-			evt->trigger_type = EFI_TIMER_STOP;
-			break;
-		case EFI_TIMER_PERIODIC:
-			evt->trigger_next += evt->trigger_time;
-			break;
-		default:
-			continue;
+	u64 now;
+
+	efi_event_loops++;
+
+	/* Only the timer due first needs to be looked at */
+	if (timers_enabled && efi_timer_count) {
+		now = timer_get_us();
+		while (efi_timer_count &&
+		       efi_timer_heap[1]->trigger_next <= now) {
+			evt = efi_timer_heap[1];
+			if (evt->trigger_type == EFI_TIMER_PERIODIC) {
+				evt->trigger_next += evt->trigger_time;
+				/* Do not catch up on periods missed */
+				if (evt->trigger_next <= now)
+					evt->trigger_next = now + 1;
+				efi_timer_fix(1);
+			} else {
+				evt->trigger_type = EFI_TIMER_STOP;
+				efi_timer_disarm(evt);
+			}
+			evt->is_signaled = false;
+			efi_signal_event(evt);
 		}
-		evt->is_signaled = false;
-		efi_signal_event(evt);
 	}
 	efi_process_event_queue();
 	WATCHDOG_RESET();
 }
 
+/**
+ * efi_get_event_stats() - get statistics about the event loop
+ *
+ * @stats:	returns the statistics
+ */
+void efi_get_event_stats(struct efi_event_stats *stats)
+{
+	struct efi_event *evt;
+	int i;
+
+	memset(stats, '\0', sizeof(*stats));
+	stats->loops = efi_event_loops;
+	stats->timers_armed = efi_timer_count;
+	list_for_each_entry(evt, &efi_events, link) {
+		stats->events++;
+		if (evt->type & EVT_TIMER)
+			stats->timers++;
+	}
+	for (i = 0; i < EFI_TPL_QUEUES; i++) {
+		list_for_each_entry(evt, &efi_event_queue[i], queue_link)
+			stats->queued++;
+	}
+}
+
 /**
  * efi_set_timer() - set the trigger time for a timer event or stop the event
  * @event:        event for which the timer is set
@@ -826,10 +1005,12 @@ efi_status_t efi_set_timer(struct efi_event *event, enum efi_timer_delay type,
 	switch (type) {
 	case EFI_TIMER_STOP:
 		event->trigger_next = -1ULL;
+		efi_timer_disarm(event);
 		break;
 	case EFI_TIMER_PERIODIC:
 	case EFI_TIMER_RELATIVE:
 		event->trigger_next = timer_get_us() + trigger_time;
+		efi_timer_arm(event);
 		break;
 	default:
 		return EFI_INVALID_PARAMETER;
@@ -958,6 +1139,7 @@ static efi_status_t EFIAPI efi_signal_event_ext(struct efi_event *event)
 static efi_status_t EFIAPI efi_close_event(struct efi_event *event)
 {
 	struct efi_register_notify_event *item, *next;
+	int i;
 
 	EFI_ENTRY("%p", event);
 	if (efi_is_event(event) != EFI_SUCCESS)
@@ -983,6 +1165,16 @@ static efi_status_t EFIAPI efi_close_event(struct efi_event *event)
 	if (efi_event_is_queued(event))
 		list_del(&event->queue_link);
 
+	if (event->type & EVT_TIMER) {
+		efi_timer_disarm(event);
+		efi_timer_events--;
+	}
+	for (i = 0; i < ARRAY_SIZE(efi_event_cache); i++) {
+		if (efi_event_cache[i] == event)
+			efi_event_cache[i] = NULL;
+	}
+	if (event->group)
+		list_del(&event->group_link);
 	list_del(&event->link);
 	efi_free_pool(event);
 	return EFI_EXIT(EFI_SUCCESS);
@@ -1641,8 +1833,8 @@ out:
 	efi_update_table_header_crc32(&systab.hdr);
 
 	/* Notify that the configuration table was changed */
-	list_for_each_entry(evt, &efi_events, link) {
-		if (evt->group && !guidcmp(evt->group, guid)) {
+	list_for_each_entry(evt, &efi_group_events, group_link) {
+		if (!guidcmp(evt->group, guid)) {
 			efi_signal_event(evt);
 			break;
 		}
@@ -1962,8 +2154,11 @@ static efi_status_t EFIAPI efi_exit_boot_services(efi_handle_t image_handle,
 
 	/* Add related events to the event group */
 	list_for_each_entry(evt, &efi_events, link) {
-		if (evt->type == EVT_SIGNAL_EXIT_BOOT_SERVICES)
-			evt->group = &efi_guid_event_group_exit_boot_services;
+		if (evt->type != EVT_SIGNAL_EXIT_BOOT_SERVICES)
+			continue;
+		if (!evt->group)
+			list_add_tail(&evt->group_link, &efi_group_events);
+		evt->group = &efi_guid_event_group_exit_boot_services;
 	}
 	/* Notify that ExitBootServices is invoked. */
 	list_for_each_entry(evt, &efi_events, link) {
@@ -1983,9 +2178,16 @@ static efi_status_t EFIAPI efi_exit_boot_services(efi_handle_t image_handle,
 
 	/* Remove all events except EVT_SIGNAL_VIRTUAL_ADDRESS_CHANGE */
 	list_for_each_entry_safe(evt, next_event, &efi_events, link) {
-		if (evt->type != EVT_SIGNAL_VIRTUAL_ADDRESS_CHANGE)
-			list_del(&evt->link);
+		if (evt->type == EVT_SIGNAL_VIRTUAL_ADDRESS_CHANGE)
+			continue;
+		if (evt->group)
+			list_del(&evt->group_link);
+		list_del(&evt->link);
 	}
+	memset(efi_event_cache, '\0', sizeof(efi_event_cache));
+
+	/* The payload takes over the console */
+	serial_flush();
 
 	board_quiesce_devices();
 
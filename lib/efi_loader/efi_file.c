@@ -33,6 +33,9 @@ struct file_handle {
 	int isdir;
 	u64 open_mode;
 
+	/* for reading a file, opened on first use: */
+	struct fs_file *file;
+
 	/* for reading a directory: */
 	struct fs_dir_stream *dirs;
 	struct fs_dirent *dent;
@@ -56,6 +59,29 @@ static int set_blk_dev(struct file_handle *fh)
 	return fs_set_blk_dev_with_part(fh->fs->desc, fh->fs->part);
 }
 
+/**
+ * open_fs_file() - open the file for reading unless it is open already
+ *
+ * Keeping the file open saves looking up its path and probing the file
+ * system again on each read.
+ *
+ * @fh:		file handle
+ * Return:	0 for success
+ */
+static int open_fs_file(struct file_handle *fh)
+{
+	if (fh->file)
+		return 0;
+
+	if (set_blk_dev(fh))
+		return -ENODEV;
+	fh->file = fs_file_open(fh->path);
+	if (!fh->file)
+		return -errno;
+
+	return 0;
+}
+
 /**
  * is_dir() - check if file handle points to directory
  *
@@ -295,6 +321,7 @@ out:
 
 static efi_status_t file_close(struct file_handle *fh)
 {
+	fs_file_close(fh->file);
 	fs_closedir(fh->dirs);
 	free(fh);
 	return EFI_SUCCESS;
@@ -314,6 +341,8 @@ static efi_status_t EFIAPI efi_file_delete(struct efi_file_handle *file)
 
 	EFI_ENTRY("%p", file);
 
+	fs_file_close(fh->file);
+	fh->file = NULL;
 	if (set_blk_dev(fh) || fs_unlink(fh->path))
 		ret = EFI_WARN_DELETE_FAILURE;
 
@@ -331,6 +360,12 @@ static efi_status_t EFIAPI efi_file_delete(struct efi_file_handle *file)
 static efi_status_t efi_get_file_size(struct file_handle *fh,
 				      loff_t *file_size)
 {
+	if (!fh->isdir) {
+		if (open_fs_file(fh) || fs_file_size(fh->file, file_size))
+			return EFI_DEVICE_ERROR;
+		return EFI_SUCCESS;
+	}
+
 	if (set_blk_dev(fh))
 		return EFI_DEVICE_ERROR;
 
@@ -355,10 +390,8 @@ static efi_status_t file_read(struct file_handle *fh, u64 *buffer_size,
 		return ret;
 	}
 
-	if (set_blk_dev(fh))
-		return EFI_DEVICE_ERROR;
-	if (fs_read(fh->path, map_to_sysmem(buffer), fh->offset,
-		    *buffer_size, &actread))
+	if (fs_file_read(fh->file, map_to_sysmem(buffer), fh->offset,
+			 *buffer_size, &actread))
 		return EFI_DEVICE_ERROR;
 
 	*buffer_size = actread;
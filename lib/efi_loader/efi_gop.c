@@ -525,6 +525,10 @@ efi_status_t efi_gop_register(void)
 	gopobj->info.pixels_per_scanline = col;
 	gopobj->bpix = bpix;
 	gopobj->fb = fb;
+#if defined(CONFIG_DM_VIDEO) && defined(CONFIG_VIDEO_DAMAGE)
+	/* Applications may draw straight into the frame buffer */
+	priv->fb_exposed = true;
+#endif
 
 	return EFI_SUCCESS;
 }
@@ -13,10 +13,23 @@
 #include <search.h>
 #include <u-boot/crc.h>
 
+#include <env.h>
+#include <fs.h>
+#include <mapmem.h>
+
 #define READ_ONLY BIT(31)
 
 /*
- * Mapping between EFI variables and u-boot variables:
+ * UEFI variables are kept in memory, in an array sorted by vendor GUID and
+ * name. This allows looking them up with a binary search and enumerating
+ * them in a stable order, even while variables are added or deleted.
+ *
+ * Non-volatile variables are made persistent by one of these stores:
+ *
+ * U-Boot environment (CONFIG_EFI_VARIABLE_ENV_STORE):
+ *
+ * Each non-volatile variable is mirrored to a U-Boot variable, which is
+ * written by 'saveenv':
  *
  *   efi_$guid_$varname = {attributes}(type)value
  *
@@ -31,12 +44,10 @@
  * attributes:
  *
  *   + ro   - read-only
+ *   + nv   - non-volatile
  *   + boot - boot-services access
  *   + run  - runtime access
  *
- * NOTE: with current implementation, no variables are available after
- * ExitBootServices, and all are persisted (if possible).
- *
  * If not specified, the attributes default to "{boot}".
  *
  * The required type is one of:
@@ -44,12 +55,80 @@
  *   + utf8 - raw utf8 string
  *   + blob - arbitrary length hex string
  *
- * Maybe a utf16 type would be useful to for a string value to be auto
- * converted to utf16?
+ * File (CONFIG_EFI_VARIABLE_FILE_STORE):
+ *
+ * All non-volatile variables are written to a file each time one of them
+ * changes, in the binary format described by struct efi_var_file.
+ *
+ * In both cases, U-Boot variables in the format above are imported when the
+ * variable services are initialized.
+ *
+ * NOTE: with current implementation, no variables are available after
+ * ExitBootServices.
  */
 
 #define PREFIX_LEN (strlen("efi_xxxxxxxx-xxxx-xxxx-xxxx-xxxxxxxxxxxx_"))
 
+/**
+ * struct efi_var - UEFI variable in memory
+ *
+ * @guid:	vendor GUID
+ * @attr:	attributes, EFI_VARIABLE_* and READ_ONLY
+ * @size:	size of the value
+ * @data:	value
+ * @name:	variable name
+ */
+struct efi_var {
+	efi_guid_t guid;
+	u32 attr;
+	efi_uintn_t size;
+	u8 *data;
+	u16 name[];
+};
+
+/* Variables sorted by vendor GUID and name */
+static struct efi_var **efi_vars;
+static int efi_var_count;
+static int efi_var_max;
+
+/* Index of the variable last returned by efi_get_next_variable_name() */
+static int efi_var_cursor = -1;
+
+#define EFI_VAR_FILE_MAGIC	0x5241564946454255ULL	/* "UBEFIVAR" */
+
+/**
+ * struct efi_var_entry - UEFI variable in the file store
+ *
+ * The name is followed by the value. Each entry is padded to a multiple of
+ * 8 bytes.
+ *
+ * @length:	size of the value
+ * @attr:	attributes
+ * @guid:	vendor GUID
+ * @name:	variable name
+ */
+struct efi_var_entry {
+	u32 length;
+	u32 attr;
+	efi_guid_t guid;
+	u16 name[];
+};
+
+/**
+ * struct efi_var_file - file store for non-volatile UEFI variables
+ *
+ * @magic:	EFI_VAR_FILE_MAGIC
+ * @length:	size of the file, including this header
+ * @crc32:	CRC32 of the entries
+ * @var:	the variables
+ */
+struct efi_var_file {
+	u64 magic;
+	u32 length;
+	u32 crc32;
+	struct efi_var_entry var[];
+};
+
 /**
  * efi_to_native() - convert the UEFI variable name and vendor GUID to U-Boot
  *		     variable name
@@ -63,6 +142,7 @@
  * @vendor:		vendor GUID
  * Return:		status code
  */
+__maybe_unused
 static efi_status_t efi_to_native(char **native, const u16 *variable_name,
 				  const efi_guid_t *vendor)
 {
@@ -148,170 +228,498 @@ static const char *parse_attr(const char *str, u32 *attrp)
 }
 
 /**
- * efi_get_variable() - retrieve value of a UEFI variable
- *
- * This function implements the GetVariable runtime service.
+ * efi_var_find() - look up a variable in the variable store
  *
- * See the Unified Extensible Firmware Interface (UEFI) specification for
- * details.
+ * @variable_name:	name of the variable
+ * @vendor:		vendor GUID
+ * @idxp:		returns the index of the variable, or where it would
+ *			have to be inserted if not found
+ * Return:		variable or NULL if not found
+ */
+static struct efi_var *efi_var_find(const u16 *variable_name,
+				    const efi_guid_t *vendor, int *idxp)
+{
+	int low = 0, high = efi_var_count;
+
+	while (low < high) {
+		int mid = (low + high) / 2;
+		struct efi_var *var = efi_vars[mid];
+		int cmp;
+
+		cmp = guidcmp(vendor, &var->guid);
+		if (!cmp)
+			cmp = u16_strcmp(variable_name, var->name);
+		if (!cmp) {
+			*idxp = mid;
+			return var;
+		}
+		if (cmp < 0)
+			high = mid;
+		else
+			low = mid + 1;
+	}
+	*idxp = low;
+
+	return NULL;
+}
+
+/**
+ * efi_var_add() - add a variable to the variable store
  *
+ * @idx:		index from efi_var_find()
  * @variable_name:	name of the variable
  * @vendor:		vendor GUID
- * @attributes:		attributes of the variable
- * @data_size:		size of the buffer to which the variable value is copied
- * @data:		buffer to which the variable value is copied
+ * @attr:		attributes
+ * @data:		value, allocated with malloc(), owned by the store
+ *			on success
+ * @size:		size of the value
  * Return:		status code
  */
-efi_status_t EFIAPI efi_get_variable(u16 *variable_name,
-				     const efi_guid_t *vendor, u32 *attributes,
-				     efi_uintn_t *data_size, void *data)
+static efi_status_t efi_var_add(int idx, const u16 *variable_name,
+				const efi_guid_t *vendor, u32 attr, u8 *data,
+				efi_uintn_t size)
 {
-	char *native_name;
-	efi_status_t ret;
-	unsigned long in_size;
-	const char *val, *s;
-	u32 attr;
+	struct efi_var *var;
 
-	EFI_ENTRY("\"%ls\" %pUl %p %p %p", variable_name, vendor, attributes,
-		  data_size, data);
+	if (efi_var_count == efi_var_max) {
+		int max = efi_var_max ? efi_var_max * 2 : 32;
+		struct efi_var **vars;
 
-	if (!variable_name || !vendor || !data_size)
-		return EFI_EXIT(EFI_INVALID_PARAMETER);
-
-	ret = efi_to_native(&native_name, variable_name, vendor);
-	if (ret)
-		return EFI_EXIT(ret);
+		vars = realloc(efi_vars, max * sizeof(*vars));
+		if (!vars)
+			return EFI_OUT_OF_RESOURCES;
+		efi_vars = vars;
+		efi_var_max = max;
+	}
 
-	EFI_PRINT("get '%s'\n", native_name);
+	var = malloc(sizeof(*var) + (u16_strlen(variable_name) + 1) *
+		     sizeof(u16));
+	if (!var)
+		return EFI_OUT_OF_RESOURCES;
+	guidcpy(&var->guid, vendor);
+	var->attr = attr;
+	var->size = size;
+	var->data = data;
+	u16_strcpy(var->name, variable_name);
+
+	memmove(&efi_vars[idx + 1], &efi_vars[idx],
+		(efi_var_count - idx) * sizeof(*efi_vars));
+	efi_vars[idx] = var;
+	efi_var_count++;
+	if (efi_var_cursor >= idx)
+		efi_var_cursor++;
 
-	val = env_get(native_name);
-	free(native_name);
-	if (!val)
-		return EFI_EXIT(EFI_NOT_FOUND);
+	return EFI_SUCCESS;
+}
 
-	val = parse_attr(val, &attr);
+/**
+ * efi_var_del() - delete a variable from the variable store
+ *
+ * @idx:	index of the variable
+ */
+static void efi_var_del(int idx)
+{
+	free(efi_vars[idx]->data);
+	free(efi_vars[idx]);
+
+	efi_var_count--;
+	memmove(&efi_vars[idx], &efi_vars[idx + 1],
+		(efi_var_count - idx) * sizeof(*efi_vars));
+	if (efi_var_cursor > idx)
+		efi_var_cursor--;
+	else if (efi_var_cursor == idx)
+		efi_var_cursor = -1;
+}
 
-	in_size = *data_size;
+/**
+ * efi_var_from_env_entry() - import a U-Boot variable into the variable store
+ *
+ * @variable:	U-Boot variable as "efi_$guid_$varname=value"
+ */
+static void efi_var_from_env_entry(char *variable)
+{
+	char *guid, *name, *end;
+	const char *val, *s;
+	efi_guid_t vendor;
+	u16 *name16, *p;
+	u8 *data = NULL;
+	size_t len;
+	u32 attr;
+	int idx;
+
+	guid = variable + strlen("efi_");
+	if (strlen(guid) <= UUID_STR_LEN)
+		return;
+	name = guid + UUID_STR_LEN;
+	if (*name != '_')
+		return;
+	*name++ = '\0';
+	end = strchr(name, '=');
+	if (!end)
+		return;
+	*end = '\0';
+	if (uuid_str_to_bin(guid, vendor.b, UUID_STR_FORMAT_GUID))
+		return;
 
+	val = parse_attr(end + 1, &attr);
 	if ((s = prefix(val, "(blob)"))) {
-		size_t len = strlen(s);
-
 		/* number of hexadecimal digits must be even */
+		len = strlen(s);
 		if (len & 1)
-			return EFI_EXIT(EFI_DEVICE_ERROR);
-
-		/* two characters per byte: */
+			return;
 		len /= 2;
-		*data_size = len;
+		data = malloc(len);
+		if (!data || hex2bin(data, s, len))
+			goto err;
+	} else if ((s = prefix(val, "(utf8)"))) {
+		len = strlen(s) + 1;
+		data = malloc(len);
+		if (!data)
+			return;
+		memcpy(data, s, len);
+	} else {
+		printf("invalid value: '%s'\n", val);
+		return;
+	}
 
-		if (in_size < len) {
-			ret = EFI_BUFFER_TOO_SMALL;
-			goto out;
-		}
+	name16 = calloc(utf8_utf16_strlen(name) + 1, sizeof(u16));
+	if (!name16)
+		goto err;
+	p = name16;
+	utf8_utf16_strcpy(&p, name);
+	if (efi_var_find(name16, &vendor, &idx) ||
+	    efi_var_add(idx, name16, &vendor, attr, data, len) != EFI_SUCCESS) {
+		free(name16);
+		goto err;
+	}
+	free(name16);
 
-		if (!data)
-			return EFI_EXIT(EFI_INVALID_PARAMETER);
+	return;
+err:
+	free(data);
+}
 
-		if (hex2bin(data, s, len))
-			return EFI_EXIT(EFI_DEVICE_ERROR);
+/**
+ * efi_var_from_env() - import all U-Boot variables holding UEFI variables
+ */
+static void efi_var_from_env(void)
+{
+	char regex[] = "efi_.*-.*-.*-.*-.*_.*";
+	char * const regexlist[] = {regex};
+	char *list = NULL, *variable, *s, *d;
 
-		EFI_PRINT("got value: \"%s\"\n", s);
-	} else if ((s = prefix(val, "(utf8)"))) {
-		unsigned len = strlen(s) + 1;
+	if (hexport_r(&env_htab, '\n', H_MATCH_REGEX | H_MATCH_KEY, &list, 0,
+		      1, regexlist) > 1) {
+		/*
+		 * hexport_r() escapes '\\' and the separator in values with a
+		 * backslash. Remove the escapes while splitting the list.
+		 */
+		for (s = list; *s;) {
+			for (variable = d = s; *s && *s != '\n'; s++) {
+				if (*s == '\\' && s[1])
+					s++;
+				*d++ = *s;
+			}
+			if (*s)
+				s++;
+			*d = '\0';
+			efi_var_from_env_entry(variable);
+		}
+	}
+	free(list);
+}
 
-		*data_size = len;
+#if CONFIG_IS_ENABLED(EFI_VARIABLE_FILE_STORE)
+/**
+ * efi_var_entry_size() - size of a variable in the file store
+ *
+ * @var:	variable
+ * Return:	size in bytes, including padding
+ */
+static size_t efi_var_entry_size(const struct efi_var *var)
+{
+	return ALIGN(sizeof(struct efi_var_entry) +
+		     (u16_strlen(var->name) + 1) * sizeof(u16) + var->size, 8);
+}
 
-		if (in_size < len) {
-			ret = EFI_BUFFER_TOO_SMALL;
-			goto out;
+/**
+ * efi_var_set_blk_dev() - select the device holding the file store
+ *
+ * @file:	returns the path of the file
+ * Return:	0 for success
+ */
+static int efi_var_set_blk_dev(const char **file)
+{
+	static char filespec[] = CONFIG_EFI_VARIABLE_FILESPEC;
+	static char *dev, *part, *path;
+
+	/* expect something like 'mmc 0:1 ubootefi.var' */
+	if (!path) {
+		char *s = filespec;
+
+		dev = strsep(&s, " ");
+		part = strsep(&s, " ");
+		path = strsep(&s, " ");
+		if (!part || !path) {
+			printf("EFI: invalid variable file '%s'\n",
+			       CONFIG_EFI_VARIABLE_FILESPEC);
+			return -EINVAL;
 		}
+	}
+	*file = path;
+
+	return fs_set_blk_dev(dev, part, FS_TYPE_ANY);
+}
+
+/**
+ * efi_var_to_storage() - write the non-volatile variables to the file store
+ *
+ * Return:	status code
+ */
+static efi_status_t efi_var_to_storage(void)
+{
+	struct efi_var_file *buf;
+	struct efi_var_entry *entry;
+	const char *file;
+	efi_status_t ret;
+	loff_t actwrite;
+	size_t len;
+	int i;
+
+	len = sizeof(*buf);
+	for (i = 0; i < efi_var_count; i++) {
+		if (efi_vars[i]->attr & EFI_VARIABLE_NON_VOLATILE)
+			len += efi_var_entry_size(efi_vars[i]);
+	}
+	buf = calloc(1, len);
+	if (!buf)
+		return EFI_OUT_OF_RESOURCES;
+
+	entry = buf->var;
+	for (i = 0; i < efi_var_count; i++) {
+		struct efi_var *var = efi_vars[i];
+		u16 *name = entry->name;
+
+		if (!(var->attr & EFI_VARIABLE_NON_VOLATILE))
+			continue;
+		entry->length = var->size;
+		entry->attr = var->attr;
+		guidcpy(&entry->guid, &var->guid);
+		u16_strcpy(name, var->name);
+		memcpy(name + u16_strlen(name) + 1, var->data, var->size);
+		entry = (void *)entry + efi_var_entry_size(var);
+	}
+	buf->magic = EFI_VAR_FILE_MAGIC;
+	buf->length = len;
+	buf->crc32 = crc32(0, (u8 *)buf->var, len - sizeof(*buf));
+
+	ret = EFI_DEVICE_ERROR;
+	if (!efi_var_set_blk_dev(&file) &&
+	    !fs_write(file, map_to_sysmem(buf), 0, len, &actwrite))
+		ret = EFI_SUCCESS;
+	free(buf);
+
+	return ret;
+}
+
+/**
+ * efi_var_update_storage() - update the store after a variable changed
+ *
+ * @var:	variable as it is now, or NULL if deleted
+ * @name:	name of the variable
+ * @vendor:	vendor GUID
+ * @nv:		true if the variable was or is non-volatile
+ * Return:	status code
+ */
+static efi_status_t efi_var_update_storage(const struct efi_var *var,
+					   const u16 *name,
+					   const efi_guid_t *vendor, bool nv)
+{
+	return nv ? efi_var_to_storage() : EFI_SUCCESS;
+}
+
+/**
+ * efi_var_from_storage() - read the non-volatile variables from the file store
+ */
+static void efi_var_from_storage(void)
+{
+	struct efi_var_file *buf = NULL;
+	struct efi_var_entry *entry;
+	const char *file;
+	loff_t size, len;
+	void *end;
+
+	if (efi_var_set_blk_dev(&file) || fs_size(file, &size) ||
+	    size < sizeof(*buf))
+		return;
+	buf = malloc(size);
+	if (!buf || efi_var_set_blk_dev(&file) ||
+	    fs_read(file, map_to_sysmem(buf), 0, size, &len) ||
+	    len != size || buf->magic != EFI_VAR_FILE_MAGIC ||
+	    buf->length > size || buf->length < sizeof(*buf) ||
+	    buf->crc32 != crc32(0, (u8 *)buf->var,
+				buf->length - sizeof(*buf))) {
+		printf("EFI: cannot read variable file\n");
+		goto out;
+	}
+
+	end = (void *)buf + buf->length;
+	for (entry = buf->var; (void *)(entry + 1) <= end;) {
+		size_t name_len, left = end - (void *)entry->name;
+		u8 *data;
+		int idx;
 
+		name_len = u16_strnlen(entry->name, left / sizeof(u16));
+		if ((name_len + 1) * sizeof(u16) + entry->length > left)
+			break;
+		data = malloc(entry->length);
 		if (!data)
-			return EFI_EXIT(EFI_INVALID_PARAMETER);
+			break;
+		memcpy(data, entry->name + name_len + 1, entry->length);
+		if (efi_var_find(entry->name, &entry->guid, &idx))
+			efi_var_del(idx);
+		if (efi_var_add(idx, entry->name, &entry->guid, entry->attr,
+				data, entry->length) != EFI_SUCCESS) {
+			free(data);
+			break;
+		}
+		entry = (void *)entry + ALIGN(sizeof(*entry) +
+				(name_len + 1) * sizeof(u16) + entry->length, 8);
+	}
+out:
+	free(buf);
+}
+#else
+/**
+ * efi_var_update_storage() - update the store after a variable changed
+ *
+ * Mirror a non-volatile variable to a U-Boot variable, see above. Any other
+ * U-Boot variable for it, e.g. imported from an older environment, is
+ * deleted.
+ *
+ * @var:	variable as it is now, or NULL if deleted
+ * @name:	name of the variable
+ * @vendor:	vendor GUID
+ * @nv:		true if the variable was or is non-volatile
+ * Return:	status code
+ */
+static efi_status_t efi_var_update_storage(const struct efi_var *var,
+					   const u16 *name,
+					   const efi_guid_t *vendor, bool nv)
+{
+	char *native_name, *val = NULL, *s;
+	efi_status_t ret;
+	u32 attributes;
 
-		memcpy(data, s, len);
-		((char *)data)[len] = '\0';
+	ret = efi_to_native(&native_name, name, vendor);
+	if (ret)
+		return ret;
 
-		EFI_PRINT("got value: \"%s\"\n", (char *)data);
-	} else {
-		EFI_PRINT("invalid value: '%s'\n", val);
-		return EFI_EXIT(EFI_DEVICE_ERROR);
+	if (!var || !(var->attr & EFI_VARIABLE_NON_VOLATILE)) {
+		env_set(native_name, NULL);
+		goto out;
+	}
+
+	val = malloc(2 * var->size + strlen("{ro,run,boot,nv}(blob)") + 1);
+	if (!val) {
+		ret = EFI_OUT_OF_RESOURCES;
+		goto out;
+	}
+
+	s = val;
+
+	/* store attributes */
+	attributes = var->attr & (EFI_VARIABLE_NON_VOLATILE |
+				  EFI_VARIABLE_BOOTSERVICE_ACCESS |
+				  EFI_VARIABLE_RUNTIME_ACCESS);
+	s += sprintf(s, "{");
+	while (attributes) {
+		u32 attr = 1 << (ffs(attributes) - 1);
+
+		if (attr == EFI_VARIABLE_NON_VOLATILE)
+			s += sprintf(s, "nv");
+		else if (attr == EFI_VARIABLE_BOOTSERVICE_ACCESS)
+			s += sprintf(s, "boot");
+		else if (attr == EFI_VARIABLE_RUNTIME_ACCESS)
+			s += sprintf(s, "run");
+
+		attributes &= ~attr;
+		if (attributes)
+			s += sprintf(s, ",");
 	}
+	s += sprintf(s, "}(blob)");
+
+	/* store payload: */
+	s = bin2hex(s, var->data, var->size);
+	*s = '\0';
 
+	EFI_PRINT("setting: %s=%s\n", native_name, val);
+
+	if (env_set(native_name, val))
+		ret = EFI_DEVICE_ERROR;
 out:
-	if (attributes)
-		*attributes = attr & EFI_VARIABLE_MASK;
+	free(native_name);
+	free(val);
 
-	return EFI_EXIT(ret);
+	return ret;
 }
 
-static char *efi_variables_list;
-static char *efi_cur_variable;
+static void efi_var_from_storage(void)
+{
+}
+#endif /* EFI_VARIABLE_FILE_STORE */
 
 /**
- * parse_uboot_variable() - parse a u-boot variable and get uefi-related
- *			    information
- * @variable:		whole data of u-boot variable (ie. name=value)
- * @variable_name_size: size of variable_name buffer in byte
- * @variable_name:	name of uefi variable in u16, null-terminated
- * @vendor:		vendor's guid
- * @attributes:		attributes
+ * efi_get_variable() - retrieve value of a UEFI variable
  *
- * A uefi variable is encoded into a u-boot variable as described above.
- * This function parses such a u-boot variable and retrieve uefi-related
- * information into respective parameters. In return, variable_name_size
- * is the size of variable name including NULL.
+ * This function implements the GetVariable runtime service.
  *
- * Return:		EFI_SUCCESS if parsing is OK, EFI_NOT_FOUND when
- *			the entire variable list has been returned,
- *			otherwise non-zero status code
+ * See the Unified Extensible Firmware Interface (UEFI) specification for
+ * details.
+ *
+ * @variable_name:	name of the variable
+ * @vendor:		vendor GUID
+ * @attributes:		attributes of the variable
+ * @data_size:		size of the buffer to which the variable value is copied
+ * @data:		buffer to which the variable value is copied
+ * Return:		status code
  */
-static efi_status_t parse_uboot_variable(char *variable,
-					 efi_uintn_t *variable_name_size,
-					 u16 *variable_name,
-					 const efi_guid_t *vendor,
-					 u32 *attributes)
+efi_status_t EFIAPI efi_get_variable(u16 *variable_name,
+				     const efi_guid_t *vendor, u32 *attributes,
+				     efi_uintn_t *data_size, void *data)
 {
-	char *guid, *name, *end, c;
-	size_t name_len;
-	efi_uintn_t old_variable_name_size;
-	u16 *p;
-
-	guid = strchr(variable, '_');
-	if (!guid)
-		return EFI_INVALID_PARAMETER;
-	guid++;
-	name = strchr(guid, '_');
-	if (!name)
-		return EFI_INVALID_PARAMETER;
-	name++;
-	end = strchr(name, '=');
-	if (!end)
-		return EFI_INVALID_PARAMETER;
+	struct efi_var *var;
+	efi_status_t ret = EFI_SUCCESS;
+	efi_uintn_t in_size;
+	int idx;
 
-	name_len = end - name;
-	old_variable_name_size = *variable_name_size;
-	*variable_name_size = sizeof(u16) * (name_len + 1);
-	if (old_variable_name_size < *variable_name_size)
-		return EFI_BUFFER_TOO_SMALL;
+	EFI_ENTRY("\"%ls\" %pUl %p %p %p", variable_name, vendor, attributes,
+		  data_size, data);
 
-	end++; /* point to value */
+	if (!variable_name || !vendor || !data_size)
+		return EFI_EXIT(EFI_INVALID_PARAMETER);
 
-	/* variable name */
-	p = variable_name;
-	utf8_utf16_strncpy(&p, name, name_len);
-	variable_name[name_len] = 0;
+	var = efi_var_find(variable_name, vendor, &idx);
+	if (!var)
+		return EFI_EXIT(EFI_NOT_FOUND);
 
-	/* guid */
-	c = *(name - 1);
-	*(name - 1) = '\0'; /* guid need be null-terminated here */
-	uuid_str_to_bin(guid, (unsigned char *)vendor, UUID_STR_FORMAT_GUID);
-	*(name - 1) = c;
+	in_size = *data_size;
+	*data_size = var->size;
+	if (in_size < var->size) {
+		ret = EFI_BUFFER_TOO_SMALL;
+		goto out;
+	}
 
-	/* attributes */
-	parse_attr(end, attributes);
+	if (!data)
+		return EFI_EXIT(EFI_INVALID_PARAMETER);
 
-	return EFI_SUCCESS;
+	memcpy(data, var->data, var->size);
+
+out:
+	if (attributes)
+		*attributes = var->attr & EFI_VARIABLE_MASK;
+
+	return EFI_EXIT(ret);
 }
 
 /**
@@ -332,13 +740,9 @@ efi_status_t EFIAPI efi_get_next_variable_name(efi_uintn_t *variable_name_size,
 					       u16 *variable_name,
 					       efi_guid_t *vendor)
 {
-	char *native_name, *variable;
-	ssize_t name_len, list_len;
-	char regex[256];
-	char * const regexlist[] = {regex};
-	u32 attributes;
-	int i;
-	efi_status_t ret;
+	struct efi_var *var;
+	efi_uintn_t size;
+	int i, idx;
 
 	EFI_ENTRY("%p \"%ls\" %pUl", variable_name_size, variable_name, vendor);
 
@@ -353,55 +757,32 @@ efi_status_t EFIAPI efi_get_next_variable_name(efi_uintn_t *variable_name_size,
 		if (i >= *variable_name_size)
 			return EFI_EXIT(EFI_INVALID_PARAMETER);
 
-		/* search for the last-returned variable */
-		ret = efi_to_native(&native_name, variable_name, vendor);
-		if (ret)
-			return EFI_EXIT(ret);
-
-		name_len = strlen(native_name);
-		for (variable = efi_variables_list; variable && *variable;) {
-			if (!strncmp(variable, native_name, name_len) &&
-			    variable[name_len] == '=')
-				break;
-
-			variable = strchr(variable, '\n');
-			if (variable)
-				variable++;
+		/* find the last-returned variable, usually the cursor */
+		idx = efi_var_cursor;
+		if (idx < 0 || guidcmp(vendor, &efi_vars[idx]->guid) ||
+		    u16_strcmp(variable_name, efi_vars[idx]->name)) {
+			if (!efi_var_find(variable_name, vendor, &idx))
+				return EFI_EXIT(EFI_INVALID_PARAMETER);
 		}
-
-		free(native_name);
-		if (!(variable && *variable))
-			return EFI_EXIT(EFI_INVALID_PARAMETER);
-
-		/* next variable */
-		variable = strchr(variable, '\n');
-		if (variable)
-			variable++;
-		if (!(variable && *variable))
-			return EFI_EXIT(EFI_NOT_FOUND);
+		idx++;
 	} else {
-		/*
-		 *new search: free a list used in the previous search
-		 */
-		free(efi_variables_list);
-		efi_variables_list = NULL;
-		efi_cur_variable = NULL;
-
-		snprintf(regex, 256, "efi_.*-.*-.*-.*-.*_.*");
-		list_len = hexport_r(&env_htab, '\n',
-				     H_MATCH_REGEX | H_MATCH_KEY,
-				     &efi_variables_list, 0, 1, regexlist);
-		/* 1 indicates that no match was found */
-		if (list_len <= 1)
-			return EFI_EXIT(EFI_NOT_FOUND);
-
-		variable = efi_variables_list;
+		idx = 0;
 	}
+	if (idx >= efi_var_count)
+		return EFI_EXIT(EFI_NOT_FOUND);
 
-	ret = parse_uboot_variable(variable, variable_name_size, variable_name,
-				   vendor, &attributes);
+	var = efi_vars[idx];
+	size = (u16_strlen(var->name) + 1) * sizeof(u16);
+	if (*variable_name_size < size) {
+		*variable_name_size = size;
+		return EFI_EXIT(EFI_BUFFER_TOO_SMALL);
+	}
+	*variable_name_size = size;
+	u16_strcpy(variable_name, var->name);
+	guidcpy(vendor, &var->guid);
+	efi_var_cursor = idx;
 
-	return EFI_EXIT(ret);
+	return EFI_EXIT(EFI_SUCCESS);
 }
 
 /**
@@ -423,11 +804,12 @@ efi_status_t EFIAPI efi_set_variable(u16 *variable_name,
 				     const efi_guid_t *vendor, u32 attributes,
 				     efi_uintn_t data_size, const void *data)
 {
-	char *native_name = NULL, *val = NULL, *s;
-	const char *old_val;
-	size_t old_size;
+	struct efi_var *var;
 	efi_status_t ret = EFI_SUCCESS;
-	u32 attr;
+	efi_uintn_t old_size = 0;
+	u8 *val;
+	bool nv;
+	int idx;
 
 	EFI_ENTRY("\"%ls\" %pUl %x %zu %p", variable_name, vendor, attributes,
 		  data_size, data);
@@ -439,44 +821,33 @@ efi_status_t EFIAPI efi_set_variable(u16 *variable_name,
 		goto out;
 	}
 
-	ret = efi_to_native(&native_name, variable_name, vendor);
-	if (ret)
-		goto out;
-
-	old_val = env_get(native_name);
-	if (old_val) {
-		old_val = parse_attr(old_val, &attr);
-
+	var = efi_var_find(variable_name, vendor, &idx);
+	if (var) {
 		/* check read-only first */
-		if (attr & READ_ONLY) {
+		if (var->attr & READ_ONLY) {
 			ret = EFI_WRITE_PROTECTED;
 			goto out;
 		}
 
+		nv = var->attr & EFI_VARIABLE_NON_VOLATILE;
 		if ((data_size == 0 &&
 		     !(attributes & EFI_VARIABLE_APPEND_WRITE)) ||
 		    !attributes) {
 			/* delete the variable: */
-			env_set(native_name, NULL);
-			ret = EFI_SUCCESS;
+			efi_var_del(idx);
+			ret = efi_var_update_storage(NULL, variable_name,
+						     vendor, nv);
 			goto out;
 		}
 
 		/* attributes won't be changed */
-		if (attr != (attributes & ~EFI_VARIABLE_APPEND_WRITE)) {
+		if (var->attr != (attributes & ~EFI_VARIABLE_APPEND_WRITE)) {
 			ret = EFI_INVALID_PARAMETER;
 			goto out;
 		}
 
-		if (attributes & EFI_VARIABLE_APPEND_WRITE) {
-			if (!prefix(old_val, "(blob)")) {
-				ret = EFI_DEVICE_ERROR;
-				goto out;
-			}
-			old_size = strlen(old_val);
-		} else {
-			old_size = 0;
-		}
+		if (attributes & EFI_VARIABLE_APPEND_WRITE)
+			old_size = var->size;
 	} else {
 		if (data_size == 0 || !attributes ||
 		    (attributes & EFI_VARIABLE_APPEND_WRITE)) {
@@ -487,59 +858,39 @@ efi_status_t EFIAPI efi_set_variable(u16 *variable_name,
 			ret = EFI_NOT_FOUND;
 			goto out;
 		}
-
-		old_size = 0;
 	}
 
-	val = malloc(old_size + 2 * data_size
-		     + strlen("{ro,run,boot,nv}(blob)") + 1);
+	val = malloc(old_size + data_size);
 	if (!val) {
 		ret = EFI_OUT_OF_RESOURCES;
 		goto out;
 	}
-
-	s = val;
-
-	/* store attributes */
-	attributes &= (EFI_VARIABLE_NON_VOLATILE |
-		       EFI_VARIABLE_BOOTSERVICE_ACCESS |
-		       EFI_VARIABLE_RUNTIME_ACCESS);
-	s += sprintf(s, "{");
-	while (attributes) {
-		u32 attr = 1 << (ffs(attributes) - 1);
-
-		if (attr == EFI_VARIABLE_NON_VOLATILE)
-			s += sprintf(s, "nv");
-		else if (attr == EFI_VARIABLE_BOOTSERVICE_ACCESS)
-			s += sprintf(s, "boot");
-		else if (attr == EFI_VARIABLE_RUNTIME_ACCESS)
-			s += sprintf(s, "run");
-
-		attributes &= ~attr;
-		if (attributes)
-			s += sprintf(s, ",");
-	}
-	s += sprintf(s, "}");
-
 	if (old_size)
 		/* APPEND_WRITE */
-		s += sprintf(s, old_val);
-	else
-		s += sprintf(s, "(blob)");
+		memcpy(val, var->data, old_size);
+	memcpy(val + old_size, data, data_size);
 
-	/* store payload: */
-	s = bin2hex(s, data, data_size);
-	*s = '\0';
-
-	EFI_PRINT("setting: %s=%s\n", native_name, val);
+	if (var) {
+		free(var->data);
+		var->data = val;
+		var->size = old_size + data_size;
+	} else {
+		attributes &= (EFI_VARIABLE_NON_VOLATILE |
+			       EFI_VARIABLE_BOOTSERVICE_ACCESS |
+			       EFI_VARIABLE_RUNTIME_ACCESS);
+		ret = efi_var_add(idx, variable_name, vendor, attributes, val,
+				  data_size);
+		if (ret != EFI_SUCCESS) {
+			free(val);
+			goto out;
+		}
+		var = efi_vars[idx];
+	}
 
-	if (env_set(native_name, val))
-		ret = EFI_DEVICE_ERROR;
+	nv = var->attr & EFI_VARIABLE_NON_VOLATILE;
+	ret = efi_var_update_storage(var, variable_name, vendor, nv);
 
 out:
-	free(native_name);
-	free(val);
-
 	return EFI_EXIT(ret);
 }
 
@@ -640,5 +991,8 @@ void efi_variables_boot_exit_notify(void)
  */
 efi_status_t efi_init_variables(void)
 {
+	efi_var_from_env();
+	efi_var_from_storage();
+
 	return EFI_SUCCESS;
 }
@@ -60,14 +60,34 @@
  * which describes the current status.
  */
 
+/*
+ * Entries are allocated separately from the table, together with their
+ * key, so that they do not move when the table is resized. The entry must
+ * come first so that a struct env_entry pointer can be converted back.
+ */
+struct env_node {
+	struct env_entry entry;
+	unsigned int mark;	/* generation of the last import, see himport_r() */
+	char key[];
+};
+
 struct env_entry_node {
 	int used;
-	struct env_entry entry;
+	struct env_node *node;
 };
 
+/*
+ * The table is grown once it is more than 3/4 full (counting deleted
+ * slots). Entries are then moved over to the new table a few at a time
+ * on each update, so that no single call pays for the whole rehash.
+ */
+#define HLOAD_MAX(size)	((size) / 4 * 3)
+#define HREHASH_STEP	16
 
 static void _hdelete(const char *key, struct hsearch_data *htab,
-		     struct env_entry *ep, int idx);
+		     struct env_entry *ep);
+static void hsort_add(struct hsearch_data *htab, struct env_entry *ep);
+static void hsort_del(struct hsearch_data *htab, struct env_entry *ep);
 
 /*
  * hcreate()
@@ -91,6 +111,18 @@ static int isprime(unsigned int number)
 	return number % div != 0;
 }
 
+/* Return the first prime number not smaller than nel (and at least 3) */
+static unsigned int hprime(size_t nel)
+{
+	if (nel < 3)
+		nel = 3;
+	nel |= 1;		/* make odd */
+	while (!isprime(nel))
+		nel += 2;
+
+	return nel;
+}
+
 /*
  * Before using the hash table we must allocate memory for it.
  * Test for an existing table are done. We allocate one element
@@ -98,6 +130,8 @@ static int isprime(unsigned int number)
  * indexing as explained in the comment for the hsearch function.
  * The contents of the table is zeroed, especially the field used
  * becomes zero.
+ *
+ * The table grows as needed, so nel is only the initial size.
  */
 
 int hcreate_r(size_t nel, struct hsearch_data *htab)
@@ -113,12 +147,11 @@ int hcreate_r(size_t nel, struct hsearch_data *htab)
 		return 0;
 
 	/* Change nel to the first prime number not smaller as nel. */
-	nel |= 1;		/* make odd */
-	while (!isprime(nel))
-		nel += 2;
-
-	htab->size = nel;
+	htab->size = hprime(nel);
 	htab->filled = 0;
+	htab->deleted = 0;
+	htab->old_table = NULL;
+	htab->old_size = 0;
 
 	/* allocate memory and zero out */
 	htab->table = (struct env_entry_node *)calloc(htab->size + 1,
@@ -140,10 +173,21 @@ int hcreate_r(size_t nel, struct hsearch_data *htab)
  * be freed and the local static variable can be marked as not used.
  */
 
-void hdestroy_r(struct hsearch_data *htab)
+static void hfree_table(struct env_entry_node *table, unsigned int size)
 {
 	int i;
 
+	for (i = 1; i <= size; ++i) {
+		if (table[i].used > 0) {
+			free(table[i].node->entry.data);
+			free(table[i].node);
+		}
+	}
+	free(table);
+}
+
+void hdestroy_r(struct hsearch_data *htab)
+{
 	/* Test for correct arguments.  */
 	if (htab == NULL) {
 		__set_errno(EINVAL);
@@ -151,18 +195,19 @@ void hdestroy_r(struct hsearch_data *htab)
 	}
 
 	/* free used memory */
-	for (i = 1; i <= htab->size; ++i) {
-		if (htab->table[i].used > 0) {
-			struct env_entry *ep = &htab->table[i].entry;
-
-			free((void *)ep->key);
-			free(ep->data);
-		}
-	}
-	free(htab->table);
+	if (htab->old_table)
+		hfree_table(htab->old_table, htab->old_size);
+	if (htab->table)
+		hfree_table(htab->table, htab->size);
+	free(htab->sorted);
 
 	/* the sign for an existing table is an value != NULL in htable */
 	htab->table = NULL;
+	htab->old_table = NULL;
+	htab->sorted = NULL;
+	htab->nsorted = 0;
+	htab->sorted_ok = 0;
+	htab->sorted_max = 0;
 }
 
 /*
@@ -172,17 +217,21 @@ void hdestroy_r(struct hsearch_data *htab)
 /*
  * This is the search function. It uses double hashing with open addressing.
  * The argument item.key has to be a pointer to an zero terminated, most
- * probably strings of chars. The function for generating a number of the
- * strings is simple but fast. It can be replaced by a more complex function
- * like ajw (see [Aho,Sethi,Ullman]) if the needs are shown.
+ * probably strings of chars. The hash of the string is computed with
+ * FNV-1a, which mixes in every character so that keys with a long common
+ * prefix (e.g. "board_serial_0", "board_serial_1") still spread well.
  *
  * We use an trick to speed up the lookup. The table is created by hcreate
  * with one more element available. This enables us to use the index zero
- * special. This index will never be used because we store the first hash
- * index in the field used where zero means not used. Every other value
- * means used. The used field can be used as a first fast comparison for
- * equality of the stored and the parameter value. This helps to prevent
- * unnecessary expensive calls of strcmp.
+ * special. This index will never be used because we store the hash
+ * value (which is never zero) in the field used where zero means not used.
+ * Every other positive value means used. The used field can be used as a
+ * first fast comparison for equality of the stored and the parameter
+ * value. This helps to prevent unnecessary expensive calls of strcmp.
+ *
+ * While the table is being resized there are two tables: entries are
+ * looked up in the new table first and then in the old one. Indices
+ * above htab->size refer to the old table.
  *
  * This implementation differs from the standard library version of
  * this function in a number of ways:
@@ -202,17 +251,177 @@ void hdestroy_r(struct hsearch_data *htab)
  *   example for functions like hdelete().
  */
 
+static int hkey(const char *key)
+{
+	unsigned int hash = 2166136261U;
+
+	while (*key) {
+		hash ^= (unsigned char)*key++;
+		hash *= 16777619;
+	}
+	hash &= 0x7fffffff;
+
+	return hash ? hash : 1;
+}
+
+/* Next index in the probe sequence of a table of the given size */
+static inline unsigned int hnext(unsigned int idx, unsigned int step,
+				 unsigned int size)
+{
+	/*
+	 * Because SIZE is prime this guarantees to
+	 * step through all available indices.
+	 */
+	return idx <= step ? size + idx - step : idx - step;
+}
+
+/*
+ * Look up key in a table. Returns the index of the entry, or 0 if it is
+ * not there. In that case *freep (if not NULL) is set to the slot a new
+ * entry should go in: the first deleted slot seen or else the empty slot
+ * which ended the search, or 0 if the table is full.
+ */
+static unsigned int hprobe(struct env_entry_node *table, unsigned int size,
+			   const char *key, int hval, unsigned int *freep)
+{
+	unsigned int first = 1 + hval % size;
+	unsigned int step = 1 + hval % (size - 2);
+	unsigned int idx = first;
+	unsigned int free_idx = 0;
+
+	do {
+		struct env_entry_node *slot = &table[idx];
+
+		if (slot->used == USED_FREE) {
+			if (!free_idx)
+				free_idx = idx;
+			break;
+		}
+		if (slot->used == USED_DELETED) {
+			if (!free_idx)
+				free_idx = idx;
+		} else if (slot->used == hval &&
+			   !strcmp(key, slot->node->entry.key)) {
+			return idx;
+		}
+		idx = hnext(idx, step, size);
+	} while (idx != first);
+
+	if (freep)
+		*freep = free_idx;
+
+	return 0;
+}
+
+/* Number of slots looked at to find the entry at idx */
+static unsigned int hprobe_len(unsigned int size, int hval, unsigned int idx)
+{
+	unsigned int pos = 1 + hval % size;
+	unsigned int step = 1 + hval % (size - 2);
+	unsigned int len = 1;
+
+	for (; pos != idx; len++)
+		pos = hnext(pos, step, size);
+
+	return len;
+}
+
+/* Get the slot for an index as returned by hsearch_r() */
+static struct env_entry_node *hslot(struct hsearch_data *htab,
+				    unsigned int idx)
+{
+	if (idx > htab->size)
+		return &htab->old_table[idx - htab->size];
+
+	return &htab->table[idx];
+}
+
+/* Look up key in the new table and then the old one, see hprobe() */
+static unsigned int hfind(struct hsearch_data *htab, const char *key, int hval,
+			  unsigned int *freep)
+{
+	unsigned int idx;
+
+	idx = hprobe(htab->table, htab->size, key, hval, freep);
+	if (!idx && htab->old_table) {
+		idx = hprobe(htab->old_table, htab->old_size, key, hval, NULL);
+		if (idx)
+			idx += htab->size;
+	}
+
+	return idx;
+}
+
+/* Move up to count slots of the old table over to the new one */
+static void hrehash(struct hsearch_data *htab, unsigned int count)
+{
+	while (htab->old_table && count--) {
+		struct env_entry_node *slot = &htab->old_table[htab->rehash_idx];
+
+		if (slot->used > 0) {
+			unsigned int idx;
+
+			hprobe(htab->table, htab->size, slot->node->entry.key,
+			       slot->used, &idx);
+			if (htab->table[idx].used == USED_DELETED)
+				--htab->deleted;
+			htab->table[idx] = *slot;
+			slot->used = USED_DELETED;
+			slot->node = NULL;
+		}
+
+		if (++htab->rehash_idx > htab->old_size) {
+			free(htab->old_table);
+			htab->old_table = NULL;
+			htab->old_size = 0;
+		}
+	}
+}
+
+/*
+ * Start moving the entries to a new table, big enough to be at most half
+ * full. If the table is mostly filled with deleted slots it keeps its size
+ * and is just cleaned up.
+ */
+static int hresize(struct hsearch_data *htab)
+{
+	struct env_entry_node *table;
+	unsigned int size;
+
+	/* Finish any previous resize first */
+	hrehash(htab, -1U);
+
+	size = hprime(max(htab->filled * 2, htab->size));
+	table = calloc(size + 1, sizeof(struct env_entry_node));
+	if (!table)
+		return -ENOMEM;
+
+	debug("hresize: %u -> %u, filled %u, deleted %u\n", htab->size, size,
+	      htab->filled, htab->deleted);
+	htab->old_table = htab->table;
+	htab->old_size = htab->size;
+	htab->rehash_idx = 1;
+	htab->table = table;
+	htab->size = size;
+	htab->deleted = 0;
+
+	return 0;
+}
+
 int hmatch_r(const char *match, int last_idx, struct env_entry **retval,
 	     struct hsearch_data *htab)
 {
 	unsigned int idx;
+	unsigned int end = htab->size + htab->old_size;
 	size_t key_len = strlen(match);
 
-	for (idx = last_idx + 1; idx < htab->size; ++idx) {
-		if (htab->table[idx].used <= 0)
+	for (idx = last_idx + 1; idx <= end; ++idx) {
+		struct env_entry_node *slot = hslot(htab, idx);
+
+		if (slot->used <= 0)
 			continue;
-		if (!strncmp(match, htab->table[idx].entry.key, key_len)) {
-			*retval = &htab->table[idx].entry;
+		if (!strncmp(match, slot->node->entry.key, key_len)) {
+			*retval = &slot->node->entry;
 			return idx;
 		}
 	}
@@ -223,144 +432,84 @@ int hmatch_r(const char *match, int last_idx, struct env_entry **retval,
 }
 
 /*
- * Compare an existing entry with the desired key, and overwrite if the action
- * is ENV_ENTER.  This is simply a helper function for hsearch_r().
+ * Overwrite an existing entry if the action is ENV_ENTER.  This is simply
+ * a helper function for hsearch_r().
  */
-static inline int _compare_and_overwrite_entry(struct env_entry item,
+static inline int _overwrite_entry(struct env_entry item,
 		enum env_action action, struct env_entry **retval,
-		struct hsearch_data *htab, int flag, unsigned int hval,
-		unsigned int idx)
-{
-	if (htab->table[idx].used == hval
-	    && strcmp(item.key, htab->table[idx].entry.key) == 0) {
-		/* Overwrite existing value? */
-		if (action == ENV_ENTER && item.data) {
-			/* check for permission */
-			if (htab->change_ok != NULL && htab->change_ok(
-			    &htab->table[idx].entry, item.data,
-			    env_op_overwrite, flag)) {
-				debug("change_ok() rejected setting variable "
-					"%s, skipping it!\n", item.key);
-				__set_errno(EPERM);
-				*retval = NULL;
-				return 0;
-			}
+		struct hsearch_data *htab, int flag, unsigned int idx)
+{
+	struct env_entry *ep = &hslot(htab, idx)->node->entry;
 
-			/* If there is a callback, call it */
-			if (htab->table[idx].entry.callback &&
-			    htab->table[idx].entry.callback(item.key,
-			    item.data, env_op_overwrite, flag)) {
-				debug("callback() rejected setting variable "
-					"%s, skipping it!\n", item.key);
-				__set_errno(EINVAL);
-				*retval = NULL;
-				return 0;
-			}
+	/* Overwrite existing value? */
+	if (action == ENV_ENTER && item.data) {
+		char *data;
 
-			free(htab->table[idx].entry.data);
-			htab->table[idx].entry.data = strdup(item.data);
-			if (!htab->table[idx].entry.data) {
-				__set_errno(ENOMEM);
-				*retval = NULL;
-				return 0;
-			}
+		/* check for permission */
+		if (htab->change_ok != NULL && htab->change_ok(
+		    ep, item.data, env_op_overwrite, flag)) {
+			debug("change_ok() rejected setting variable "
+				"%s, skipping it!\n", item.key);
+			__set_errno(EPERM);
+			*retval = NULL;
+			return 0;
+		}
+
+		/* If there is a callback, call it */
+		if (ep->callback &&
+		    ep->callback(item.key, item.data, env_op_overwrite, flag)) {
+			debug("callback() rejected setting variable "
+				"%s, skipping it!\n", item.key);
+			__set_errno(EINVAL);
+			*retval = NULL;
+			return 0;
 		}
-		/* return found entry */
-		*retval = &htab->table[idx].entry;
-		return idx;
+
+		data = strdup(item.data);
+		if (!data) {
+			__set_errno(ENOMEM);
+			*retval = NULL;
+			return 0;
+		}
+		free(ep->data);
+		ep->data = data;
 	}
-	/* keep searching */
-	return -1;
+	/* return found entry */
+	*retval = ep;
+	return idx;
 }
 
 int hsearch_r(struct env_entry item, enum env_action action,
 	      struct env_entry **retval, struct hsearch_data *htab, int flag)
 {
-	unsigned int hval;
-	unsigned int count;
-	unsigned int len = strlen(item.key);
-	unsigned int idx;
-	unsigned int first_deleted = 0;
-	int ret;
-
-	/* Compute an value for the given string. Perhaps use a better method. */
-	hval = len;
-	count = len;
-	while (count-- > 0) {
-		hval <<= 4;
-		hval += item.key[count];
-	}
+	struct env_node *node;
+	unsigned int idx, free_idx;
+	size_t len;
+	int hval;
 
-	/*
-	 * First hash function:
-	 * simply take the modul but prevent zero.
-	 */
-	hval %= htab->size;
-	if (hval == 0)
-		++hval;
+	hval = hkey(item.key);
 
-	/* The first index tried. */
-	idx = hval;
-
-	if (htab->table[idx].used) {
-		/*
-		 * Further action might be required according to the
-		 * action value.
-		 */
-		unsigned hval2;
-
-		if (htab->table[idx].used == USED_DELETED
-		    && !first_deleted)
-			first_deleted = idx;
-
-		ret = _compare_and_overwrite_entry(item, action, retval, htab,
-			flag, hval, idx);
-		if (ret != -1)
-			return ret;
-
-		/*
-		 * Second hash function:
-		 * as suggested in [Knuth]
-		 */
-		hval2 = 1 + hval % (htab->size - 2);
-
-		do {
-			/*
-			 * Because SIZE is prime this guarantees to
-			 * step through all available indices.
-			 */
-			if (idx <= hval2)
-				idx = htab->size + idx - hval2;
-			else
-				idx -= hval2;
+	/* Updates do a little of any pending resize */
+	if (action == ENV_ENTER)
+		hrehash(htab, HREHASH_STEP);
 
-			/*
-			 * If we visited all entries leave the loop
-			 * unsuccessfully.
-			 */
-			if (idx == hval)
-				break;
-
-			if (htab->table[idx].used == USED_DELETED
-			    && !first_deleted)
-				first_deleted = idx;
-
-			/* If entry is found use it. */
-			ret = _compare_and_overwrite_entry(item, action, retval,
-				htab, flag, hval, idx);
-			if (ret != -1)
-				return ret;
-		}
-		while (htab->table[idx].used != USED_FREE);
-	}
+	idx = hfind(htab, item.key, hval, &free_idx);
+	if (idx)
+		return _overwrite_entry(item, action, retval, htab, flag, idx);
 
 	/* An empty bucket has been found. */
 	if (action == ENV_ENTER) {
+		/* Grow the table if it is getting full */
+		if (htab->filled + htab->deleted >= HLOAD_MAX(htab->size) &&
+		    !hresize(htab))
+			hprobe(htab->table, htab->size, item.key, hval,
+			       &free_idx);
+
 		/*
 		 * If table is full and another entry should be
 		 * entered return with error.
 		 */
-		if (htab->filled == htab->size) {
+		if (!free_idx) {
 			__set_errno(ENOMEM);
 			*retval = NULL;
 			return 0;
@@ -370,51 +519,62 @@ int hsearch_r(struct env_entry item, enum env_action action,
 		 * Create new entry;
 		 * create copies of item.key and item.data
 		 */
-		if (first_deleted)
-			idx = first_deleted;
-
-		htab->table[idx].used = hval;
-		htab->table[idx].entry.key = strdup(item.key);
-		htab->table[idx].entry.data = strdup(item.data);
-		if (!htab->table[idx].entry.key ||
-		    !htab->table[idx].entry.data) {
+		len = strlen(item.key) + 1;
+		node = malloc(sizeof(*node) + len);
+		item.data = strdup(item.data);
+		if (!node || !item.data) {
+			free(node);
+			free(item.data);
 			__set_errno(ENOMEM);
 			*retval = NULL;
 			return 0;
 		}
+		memcpy(node->key, item.key, len);
+		node->entry.key = node->key;
+		node->entry.data = item.data;
+		node->entry.callback = NULL;
+		node->entry.flags = 0;
+		node->mark = htab->mark;
+
+		idx = free_idx;
+		if (htab->table[idx].used == USED_DELETED)
+			--htab->deleted;
+		htab->table[idx].used = hval;
+		htab->table[idx].node = node;
 
 		++htab->filled;
+		hsort_add(htab, &node->entry);
 
 		/* This is a new entry, so look up a possible callback */
-		env_callback_init(&htab->table[idx].entry);
+		env_callback_init(&node->entry);
 		/* Also look for flags */
-		env_flags_init(&htab->table[idx].entry);
+		env_flags_init(&node->entry);
 
 		/* check for permission */
 		if (htab->change_ok != NULL && htab->change_ok(
-		    &htab->table[idx].entry, item.data, env_op_create, flag)) {
+		    &node->entry, item.data, env_op_create, flag)) {
 			debug("change_ok() rejected setting variable "
 				"%s, skipping it!\n", item.key);
-			_hdelete(item.key, htab, &htab->table[idx].entry, idx);
+			_hdelete(item.key, htab, &node->entry);
 			__set_errno(EPERM);
 			*retval = NULL;
 			return 0;
 		}
 
 		/* If there is a callback, call it */
-		if (htab->table[idx].entry.callback &&
-		    htab->table[idx].entry.callback(item.key, item.data,
+		if (node->entry.callback &&
+		    node->entry.callback(item.key, item.data,
 		    env_op_create, flag)) {
 			debug("callback() rejected setting variable "
 				"%s, skipping it!\n", item.key);
-			_hdelete(item.key, htab, &htab->table[idx].entry, idx);
+			_hdelete(item.key, htab, &node->entry);
 			__set_errno(EINVAL);
 			*retval = NULL;
 			return 0;
 		}
 
 		/* return new entry */
-		*retval = &htab->table[idx].entry;
+		*retval = &node->entry;
 		return 1;
 	}
 
@@ -434,16 +594,33 @@ int hsearch_r(struct env_entry item, enum env_action action,
  * do that.
  */
 
+/*
+ * The entry is looked up again rather than using an index from earlier:
+ * change_ok() and callbacks may set or delete other variables, which can
+ * resize the table or move entries between the old and new tables.
+ */
 static void _hdelete(const char *key, struct hsearch_data *htab,
-		     struct env_entry *ep, int idx)
+		     struct env_entry *ep)
 {
+	struct env_entry_node *slot;
+	unsigned int idx;
+
+	idx = hfind(htab, key, hkey(key), NULL);
+	if (!idx)
+		return;		/* already deleted, e.g. by its callback */
+	slot = hslot(htab, idx);
+	if (&slot->node->entry != ep)
+		return;
+
 	/* free used entry */
 	debug("hdelete: DELETING key \"%s\"\n", key);
-	free((void *)ep->key);
+	hsort_del(htab, ep);
 	free(ep->data);
-	ep->callback = NULL;
-	ep->flags = 0;
-	htab->table[idx].used = USED_DELETED;
+	free(slot->node);
+	slot->node = NULL;
+	slot->used = USED_DELETED;
+	if (idx <= htab->size)
+		++htab->deleted;
 
 	--htab->filled;
 }
@@ -473,19 +650,47 @@ int hdelete_r(const char *key, struct hsearch_data *htab, int flag)
 	}
 
 	/* If there is a callback, call it */
-	if (htab->table[idx].entry.callback &&
-	    htab->table[idx].entry.callback(key, NULL, env_op_delete, flag)) {
+	if (ep->callback && ep->callback(key, NULL, env_op_delete, flag)) {
 		debug("callback() rejected deleting variable "
 			"%s, skipping it!\n", key);
 		__set_errno(EINVAL);
 		return 0;
 	}
 
-	_hdelete(key, htab, ep, idx);
+	_hdelete(key, htab, ep);
 
 	return 1;
 }
 
+/*
+ * hstat()
+ */
+
+void hstat_r(struct hsearch_data *htab, struct hsearch_stat *stat)
+{
+	unsigned int i, len;
+
+	memset(stat, '\0', sizeof(*stat));
+	stat->size = htab->size;
+	stat->filled = htab->filled;
+	stat->deleted = htab->deleted;
+	stat->old_size = htab->old_size;
+
+	for (i = 1; i <= htab->size + htab->old_size; ++i) {
+		struct env_entry_node *slot = hslot(htab, i);
+
+		if (slot->used <= 0)
+			continue;
+		if (i > htab->size)
+			len = hprobe_len(htab->old_size, slot->used,
+					 i - htab->size);
+		else
+			len = hprobe_len(htab->size, slot->used, i);
+		stat->probe_total += len;
+		stat->probe_max = max(stat->probe_max, len);
+	}
+}
+
 #if !(defined(CONFIG_SPL_BUILD) && !defined(CONFIG_SPL_SAVEENV))
 /*
  * hexport()
@@ -537,6 +742,124 @@ static int cmpkey(const void *p1, const void *p2)
 	return (strcmp(e1->key, e2->key));
 }
 
+/*
+ * The entries are kept in key order in htab->sorted[] so that exporting
+ * does not have to sort the whole table each time. New entries are
+ * appended: they extend the sorted part (the first htab->sorted_ok
+ * entries) as long as they come in order, as they do when importing an
+ * exported environment, and are otherwise sorted and merged in by the
+ * next export. The array never holds deleted entries, so if it has fewer
+ * than htab->filled entries (e.g. after running out of memory) it is
+ * simply rebuilt.
+ */
+static void hsort_add(struct hsearch_data *htab, struct env_entry *ep)
+{
+	struct env_entry **sorted;
+	unsigned int n = htab->nsorted;
+
+	if (n == htab->sorted_max) {
+		unsigned int max = n ? n * 2 : 64;
+
+		sorted = realloc(htab->sorted, max * sizeof(*sorted));
+		if (!sorted)
+			return;
+		htab->sorted = sorted;
+		htab->sorted_max = max;
+	}
+	if (htab->sorted_ok == n &&
+	    (!n || strcmp(htab->sorted[n - 1]->key, ep->key) < 0))
+		htab->sorted_ok++;
+	htab->sorted[htab->nsorted++] = ep;
+}
+
+static void hsort_del(struct hsearch_data *htab, struct env_entry *ep)
+{
+	struct env_entry **sorted = htab->sorted;
+	unsigned int lo = 0, hi = htab->sorted_ok, i;
+	int cmp;
+
+	/* The sorted part can be searched by key, the rest only linearly */
+	while (lo < hi) {
+		i = (lo + hi) / 2;
+		cmp = strcmp(ep->key, sorted[i]->key);
+		if (!cmp) {
+			memmove(&sorted[i], &sorted[i + 1],
+				(htab->nsorted - i - 1) * sizeof(*sorted));
+			htab->sorted_ok--;
+			htab->nsorted--;
+			return;
+		}
+		if (cmp < 0)
+			hi = i;
+		else
+			lo = i + 1;
+	}
+	for (i = htab->sorted_ok; i < htab->nsorted; i++) {
+		if (sorted[i] == ep) {
+			sorted[i] = sorted[--htab->nsorted];
+			return;
+		}
+	}
+}
+
+/* Bring htab->sorted[] up to date, so that it lists all entries in order */
+static int hsort_update(struct hsearch_data *htab)
+{
+	struct env_entry **sorted;
+	unsigned int i, j, k, n;
+
+	if (htab->nsorted != htab->filled) {
+		debug("hexport: rebuilding sorted list\n");
+		if (htab->sorted_max < htab->filled) {
+			n = max(htab->filled, 64U);
+			sorted = realloc(htab->sorted, n * sizeof(*sorted));
+			if (!sorted)
+				return -ENOMEM;
+			htab->sorted = sorted;
+			htab->sorted_max = n;
+		}
+		for (i = 1, n = 0; i <= htab->size + htab->old_size; ++i) {
+			struct env_entry_node *slot = hslot(htab, i);
+
+			if (slot->used > 0)
+				htab->sorted[n++] = &slot->node->entry;
+		}
+		htab->nsorted = n;
+		htab->sorted_ok = 0;
+	}
+
+	n = htab->nsorted - htab->sorted_ok;
+	if (!n)
+		return 0;
+
+	/* Sort the new entries and merge them with the sorted part */
+	debug("hexport: sorting %u of %u entries\n", n, htab->nsorted);
+	qsort(&htab->sorted[htab->sorted_ok], n, sizeof(*sorted), cmpkey);
+	if (htab->sorted_ok) {
+		sorted = malloc(htab->sorted_max * sizeof(*sorted));
+		if (!sorted) {
+			qsort(htab->sorted, htab->nsorted, sizeof(*sorted),
+			      cmpkey);
+		} else {
+			for (i = 0, j = htab->sorted_ok, k = 0;
+			     k < htab->nsorted; k++) {
+				if (j == htab->nsorted ||
+				    (i < htab->sorted_ok &&
+				     cmpkey(&htab->sorted[i],
+					    &htab->sorted[j]) < 0))
+					sorted[k] = htab->sorted[i++];
+				else
+					sorted[k] = htab->sorted[j++];
+			}
+			free(htab->sorted);
+			htab->sorted = sorted;
+		}
+	}
+	htab->sorted_ok = htab->nsorted;
+
+	return 0;
+}
+
 static int match_string(int flag, const char *str, const char *pat, void *priv)
 {
 	switch (flag & H_MATCH_METHOD) {
@@ -595,11 +918,24 @@ static int match_entry(struct env_entry *ep, int flag, int argc,
 	return 0;
 }
 
+/* Check whether an entry should be exported */
+static int hexport_wanted(struct env_entry *ep, int flag, int argc,
+			  char *const argv[])
+{
+	if (argc > 0 && !match_entry(ep, flag, argc, argv))
+		return 0;
+
+	if ((flag & H_HIDE_DOT) && ep->key[0] == '.')
+		return 0;
+
+	return 1;
+}
+
 ssize_t hexport_r(struct hsearch_data *htab, const char sep, int flag,
 		 char **resp, size_t size,
 		 int argc, char * const argv[])
 {
-	struct env_entry *list[htab->size];
+	struct env_entry **list;
 	char *res, *p;
 	size_t totlen;
 	int i, n;
@@ -612,56 +948,43 @@ ssize_t hexport_r(struct hsearch_data *htab, const char sep, int flag,
 
 	debug("EXPORT  table = %p, htab.size = %d, htab.filled = %d, size = %lu\n",
 	      htab, htab->size, htab->filled, (ulong)size);
+
+	/* Get the list of entries sorted by keys */
+	if (hsort_update(htab)) {
+		__set_errno(ENOMEM);
+		return (-1);
+	}
+	list = htab->sorted;
+	n = htab->nsorted;
+
 	/*
 	 * Pass 1:
-	 * search used entries,
-	 * save addresses and compute total length
+	 * compute total length of the entries to export
 	 */
-	for (i = 1, n = 0, totlen = 0; i <= htab->size; ++i) {
+	for (i = 0, totlen = 0; i < n; ++i) {
+		struct env_entry *ep = list[i];
 
-		if (htab->table[i].used > 0) {
-			struct env_entry *ep = &htab->table[i].entry;
-			int found = match_entry(ep, flag, argc, argv);
-
-			if ((argc > 0) && (found == 0))
-				continue;
-
-			if ((flag & H_HIDE_DOT) && ep->key[0] == '.')
-				continue;
-
-			list[n++] = ep;
+		if (!hexport_wanted(ep, flag, argc, argv))
+			continue;
 
-			totlen += strlen(ep->key);
+		totlen += strlen(ep->key);
 
-			if (sep == '\0') {
-				totlen += strlen(ep->data);
-			} else {	/* check if escapes are needed */
-				char *s = ep->data;
+		if (sep == '\0') {
+			totlen += strlen(ep->data);
+		} else {	/* check if escapes are needed */
+			char *s = ep->data;
 
-				while (*s) {
+			while (*s) {
+				++totlen;
+				/* add room for needed escape chars */
+				if ((*s == sep) || (*s == '\\'))
 					++totlen;
-					/* add room for needed escape chars */
-					if ((*s == sep) || (*s == '\\'))
-						++totlen;
-					++s;
-				}
+				++s;
 			}
-			totlen += 2;	/* for '=' and 'sep' char */
 		}
+		totlen += 2;	/* for '=' and 'sep' char */
 	}
 
-#ifdef DEBUG
-	/* Pass 1a: print unsorted list */
-	printf("Unsorted: n=%d\n", n);
-	for (i = 0; i < n; ++i) {
-		printf("\t%3d: %p ==> %-10s => %s\n",
-		       i, list[i], list[i]->key, list[i]->data);
-	}
-#endif
-
-	/* Sort list by keys */
-	qsort(list, n, sizeof(struct env_entry *), cmpkey);
-
 	/* Check if the user supplied buffer size is sufficient */
 	if (size) {
 		if (size < totlen + 1) {	/* provided buffer too small */
@@ -694,6 +1017,9 @@ ssize_t hexport_r(struct hsearch_data *htab, const char sep, int flag,
 	for (i = 0, p = res; i < n; ++i) {
 		const char *s;
 
+		if (!hexport_wanted(list[i], flag, argc, argv))
+			continue;
+
 		s = list[i]->key;
 		while (*s)
 			*p++ = *s++;
@@ -712,6 +1038,14 @@ ssize_t hexport_r(struct hsearch_data *htab, const char sep, int flag,
 
 	return size;
 }
+#else
+static void hsort_add(struct hsearch_data *htab, struct env_entry *ep)
+{
+}
+
+static void hsort_del(struct hsearch_data *htab, struct env_entry *ep)
+{
+}
 #endif
 
 
@@ -747,6 +1081,77 @@ static int drop_var_from_set(const char *name, int nvars, char * vars[])
 	return res;
 }
 
+/*
+ * Handle an imported variable which exists already, when old data is
+ * to be discarded. If its value is unchanged the variable is marked as
+ * imported; otherwise it is removed so that it is created afresh.
+ * Returns 1 if nothing else needs to be done.
+ */
+static int himport_existing(struct hsearch_data *htab, char *name,
+			    const char *value, int flag)
+{
+	struct env_entry e, *ep;
+	struct env_node *node;
+	int idx;
+
+	e.key = name;
+	e.data = NULL;
+	idx = hsearch_r(e, ENV_FIND, &ep, htab, 0);
+	if (!idx)
+		return 0;
+
+	/* Already imported this time: just update it */
+	node = (struct env_node *)ep;
+	if (node->mark == htab->mark)
+		return 0;
+
+	if (strcmp(ep->data, value)) {
+		_hdelete(name, htab, ep);
+		return 0;
+	}
+
+	debug("KEEP: \"%s\"\n", name);
+	node->mark = htab->mark;
+	if (ep->callback)
+		ep->callback(name, value, env_op_create, flag);
+
+	return 1;
+}
+
+/* Remove all variables which are not marked as imported */
+static void himport_sweep(struct hsearch_data *htab)
+{
+	unsigned int i, j, ok;
+
+	/* Drop them from the sorted list in a single pass */
+	for (i = 0, j = 0, ok = htab->sorted_ok; i < htab->nsorted; ++i) {
+		struct env_node *node = (struct env_node *)htab->sorted[i];
+
+		if (node->mark == htab->mark)
+			htab->sorted[j++] = &node->entry;
+		else if (i < htab->sorted_ok)
+			--ok;
+	}
+	htab->nsorted = j;
+	htab->sorted_ok = ok;
+
+	for (i = 1; i <= htab->size + htab->old_size; ++i) {
+		struct env_entry_node *slot = hslot(htab, i);
+
+		if (slot->used <= 0 || slot->node->mark == htab->mark)
+			continue;
+
+		debug("DELETE STALE: \"%s\"\n", slot->node->entry.key);
+		free(slot->node->entry.data);
+		free(slot->node);
+		slot->node = NULL;
+		slot->used = USED_DELETED;
+		if (i <= htab->size)
+			++htab->deleted;
+		--htab->filled;
+	}
+}
+
 /*
  * Import linearized data into hash table.
  *
@@ -759,10 +1164,14 @@ static int drop_var_from_set(const char *name, int nvars, char * vars[])
  * The "flag" argument can be used to control the behaviour: when the
  * H_NOCLEAR bit is set, then an existing hash table will kept, i. e.
  * new data will be added to an existing hash table; otherwise, if no
- * vars are passed, old data will be discarded and a new hash table
- * will be created. If vars are passed, passed vars that are not in
- * the linear list of "name=value" pairs will be removed from the
- * current hash table.
+ * vars are passed, old data will be discarded. If vars are passed,
+ * passed vars that are not in the linear list of "name=value" pairs
+ * will be removed from the current hash table.
+ *
+ * Discarding old data does not rebuild the hash table: variables whose
+ * value does not change are kept as they are (only their callback is
+ * run again), changed ones are replaced and all variables which are
+ * not in the imported data are removed at the end.
  *
  * The separator character for the "name=value" pairs can be selected,
  * so we both support importing from externally stored environment
@@ -791,6 +1200,7 @@ int himport_r(struct hsearch_data *htab,
 {
 	char *data, *sp, *dp, *name, *value;
 	char *localvars[nvars];
+	int delta;
 	int i;
 
 	/* Test for correct arguments.  */
@@ -813,13 +1223,10 @@ int himport_r(struct hsearch_data *htab,
 	if (nvars)
 		memcpy(localvars, vars, sizeof(vars[0]) * nvars);
 
-	if ((flag & H_NOCLEAR) == 0 && !nvars) {
-		/* Destroy old hash table if one exists */
-		debug("Destroy Hash Table: %p table = %p\n", htab,
-		       htab->table);
-		if (htab->table)
-			hdestroy_r(htab);
-	}
+	/* Discard old data by only applying the differences, see above */
+	delta = (flag & H_NOCLEAR) == 0 && !nvars && htab->table;
+	if (delta)
+		++htab->mark;
 
 	/*
 	 * Create new hash table (if needed).  The computation of the hash
@@ -836,7 +1243,8 @@ int himport_r(struct hsearch_data *htab,
 	 * environment size), so we clip it to a reasonable value.
 	 * On the other hand we need to add some more entries for free
 	 * space when importing very small buffers. Both boundaries can
-	 * be overwritten in the board config file if needed.
+	 * be overwritten in the board config file if needed. As the table
+	 * grows when it fills up, this is only its initial size.
 	 */
 
 	if (!htab->table) {
@@ -901,6 +1309,16 @@ int himport_r(struct hsearch_data *htab,
 			if (!drop_var_from_set(name, nvars, localvars))
 				continue;
 
+			/* Old variables are removed at the end anyway */
+			if (delta) {
+				e.key = name;
+				e.data = NULL;
+				hsearch_r(e, ENV_FIND, &rv, htab, 0);
+				if (!rv ||
+				    ((struct env_node *)rv)->mark != htab->mark)
+					continue;
+			}
+
 			if (hdelete_r(name, htab, flag) == 0)
 				debug("DELETE ERROR ##############################\n");
 
@@ -928,6 +1346,9 @@ int himport_r(struct hsearch_data *htab,
 		if (!drop_var_from_set(name, nvars, localvars))
 			continue;
 
+		if (delta && himport_existing(htab, name, value, flag))
+			continue;
+
 		/* enter into hash table */
 		e.key = name;
 		e.data = value;
@@ -945,6 +1366,9 @@ int himport_r(struct hsearch_data *htab,
 	debug("INSERT: free(data = %p)\n", data);
 	free(data);
 
+	if (delta)
+		himport_sweep(htab);
+
 	if (flag & H_NOCLEAR)
 		goto end;
 
@@ -984,9 +1408,11 @@ int hwalk_r(struct hsearch_data *htab, int (*callback)(struct env_entry *entry))
 	int i;
 	int retval;
 
-	for (i = 1; i <= htab->size; ++i) {
-		if (htab->table[i].used > 0) {
-			retval = callback(&htab->table[i].entry);
+	for (i = 1; i <= htab->size + htab->old_size; ++i) {
+		struct env_entry_node *slot = hslot(htab, i);
+
+		if (slot->used > 0) {
+			retval = callback(&slot->node->entry);
 			if (retval)
 				return retval;
 		}
@@ -96,6 +96,10 @@ FORCE_INLINE int LZ4_decompress_generic(
     const int safeDecode = (endOnInput==endOnInputSize);
     const int checkOffset = ((safeDecode) && (dictSize < (int)(64 KB)));
 
+    /* U-Boot: limits for the short sequence fast path, see below */
+    const BYTE* const shortiend = iend - 14 /*maxLL*/ - 2 /*offset*/;
+    BYTE* const shortoend = oend - 14 /*maxLL*/ - 18 /*maxML*/;
+
 
     /* Special cases */
     if ((partialDecoding) && (oexit> oend-MFLIMIT)) oexit = oend-MFLIMIT;                         /* targetOutputSize too high => decode everything */
@@ -112,7 +116,43 @@ FORCE_INLINE int LZ4_decompress_generic(
 
         /* get literal length */
         token = *ip++;
-        if ((length=(token>>ML_BITS)) == RUN_MASK)
+
+        /*
+         * U-Boot: two-stage shortcut for the most common case, backported
+         * from upstream LZ4 v1.8.3:
+         * 1) If the literal length is 0..14 and there is enough space, copy
+         *    16 bytes on behalf of the literals.
+         * 2) If the match length is then 4..18 and the offset is at least 8,
+         *    copy 18 bytes on behalf of the match. The space for this is
+         *    checked on entering the shortcut.
+         * Otherwise the decoded offset is handed on to the normal path.
+         */
+        length = token >> ML_BITS;
+        if ((endOnInput) && (!partialDecoding) && (length != RUN_MASK)
+            && likely((ip < shortiend) & (op <= shortoend)))
+        {
+            /* copy the literals */
+            LZ4_copy8(op, ip);
+            LZ4_copy8(op+8, ip+8);
+            op += length; ip += length;
+
+            /* decode the offset, which is needed by both paths */
+            match = op - LZ4_readLE16(ip); ip+=2;
+            length = token & ML_MASK;
+            if ((length != ML_MASK) && (op-match >= 8)
+                && (dict==withPrefix64k || match >= lowPrefix))
+            {
+                LZ4_copy8(op, match);
+                LZ4_copy8(op+8, match+8);
+                op[16] = match[16];
+                op[17] = match[17];
+                op += length + MINMATCH;
+                continue;
+            }
+            goto _copy_match;
+        }
+
+        if (length == RUN_MASK)
         {
             unsigned s;
             do
@@ -150,6 +190,7 @@ FORCE_INLINE int LZ4_decompress_generic(
 
         /* get offset */
         match = cpy - LZ4_readLE16(ip); ip+=2;
+_copy_match:
         if ((checkOffset) && (unlikely(match < lowLimit))) goto _output_error;   /* Error : offset outside destination buffer */
 
         /* get matchlength */
@@ -7,6 +7,7 @@
 #include <compiler.h>
 #include <image.h>
 #include <lz4.h>
+#include <malloc.h>
 #include <linux/kernel.h>
 #include <linux/types.h>
 
@@ -62,35 +63,61 @@ struct lz4_block_header {
 	/* + u32 block_checksum iff has_block_checksum is set */
 } __packed;
 
+/**
+ * lz4_parse_frame() - Check an LZ4 frame header and find the first block
+ *
+ * @src: Start of the frame
+ * @srcn: Length of the frame
+ * @blocks: Returns a pointer to the first block header
+ * @block_max: Returns the maximum uncompressed size of a block
+ * @has_block_checksum: Returns true if each block is followed by a checksum
+ * @return 0 if OK, or -ve error code as for ulz4fn()
+ */
+static int lz4_parse_frame(const void *src, size_t srcn, const void **blocks,
+			   size_t *block_max, int *has_block_checksum)
+{
+	const struct lz4_frame_header *h = src;
+	const void *in = src;
+
+	if (srcn < sizeof(*h) + sizeof(u64) + sizeof(u8))
+		return -EINVAL;	/* input overrun */
+
+	/* We assume there's always only a single, standard frame. */
+	if (le32_to_cpu(h->magic) != LZ4F_MAGIC || h->version != 1)
+		return -EPROTONOSUPPORT;	/* unknown format */
+	if (h->reserved0 || h->reserved1 || h->reserved2)
+		return -EINVAL;	/* reserved must be zero */
+	if (!h->independent_blocks)
+		return -EPROTONOSUPPORT; /* we can't support this yet */
+	if (h->max_block_size < 4)
+		return -EINVAL;	/* values 0-3 are reserved */
+	*has_block_checksum = h->has_block_checksum;
+	/* 4 = 64KiB, 5 = 256KiB, 6 = 1MiB, 7 = 4MiB */
+	*block_max = 1 << (2 * h->max_block_size + 8);
+
+	in += sizeof(*h);
+	if (h->has_content_size)
+		in += sizeof(u64);
+	in += sizeof(u8);
+	*blocks = in;
+
+	return 0;
+}
+
 int ulz4fn(const void *src, size_t srcn, void *dst, size_t *dstn)
 {
 	const void *end = dst + *dstn;
-	const void *in = src;
+	const void *in;
 	void *out = dst;
 	int has_block_checksum;
+	size_t block_max;
 	int ret;
 	*dstn = 0;
 
-	{ /* With in-place decompression the header may become invalid later. */
-		const struct lz4_frame_header *h = in;
-
-		if (srcn < sizeof(*h) + sizeof(u64) + sizeof(u8))
-			return -EINVAL;	/* input overrun */
-
-		/* We assume there's always only a single, standard frame. */
-		if (le32_to_cpu(h->magic) != LZ4F_MAGIC || h->version != 1)
-			return -EPROTONOSUPPORT;	/* unknown format */
-		if (h->reserved0 || h->reserved1 || h->reserved2)
-			return -EINVAL;	/* reserved must be zero */
-		if (!h->independent_blocks)
-			return -EPROTONOSUPPORT; /* we can't support this yet */
-		has_block_checksum = h->has_block_checksum;
-
-		in += sizeof(*h);
-		if (h->has_content_size)
-			in += sizeof(u64);
-		in += sizeof(u8);
-	}
+	/* With in-place decompression the header may become invalid later. */
+	ret = lz4_parse_frame(src, srcn, &in, &block_max, &has_block_checksum);
+	if (ret)
+		return ret;
 
 	while (1) {
 		struct lz4_block_header b;
@@ -136,3 +163,169 @@ int ulz4fn(const void *src, size_t srcn, void *dst, size_t *dstn)
 	*dstn = out - dst;
 	return ret;
 }
+
+/**
+ * lz4_block_size() - Get the uncompressed size of a compressed block
+ *
+ * This walks the sequences of the block without copying any data
+ *
+ * @in: Compressed data of the block
+ * @size: Size of the compressed data
+ * @return uncompressed size, or -EPROTO if the block is malformed
+ */
+static int lz4_block_size(const u8 *in, size_t size)
+{
+	const u8 *end = in + size;
+	size_t out = 0;
+
+	while (in < end) {
+		u8 token = *in++;
+		size_t len;
+		u8 extra;
+
+		/* literals */
+		len = token >> ML_BITS;
+		if (len == RUN_MASK) {
+			do {
+				if (in >= end)
+					return -EPROTO;
+				extra = *in++;
+				len += extra;
+			} while (extra == 255);
+		}
+		in += len;
+		out += len;
+		if (in >= end)
+			break;		/* the last sequence has no match */
+
+		/* match offset and length */
+		in += 2;
+		len = token & ML_MASK;
+		if (len == ML_MASK) {
+			do {
+				if (in >= end)
+					return -EPROTO;
+				extra = *in++;
+				len += extra;
+			} while (extra == 255);
+		}
+		out += len + MINMATCH;
+	}
+	if (in != end || out > INT_MAX)
+		return -EPROTO;
+
+	return out;
+}
+
+int ulz4fn_range(const void *src, size_t srcn, size_t offset, void *dst,
+		 size_t *dstn)
+{
+	const void *in;
+	void *out = dst;
+	void *scratch = NULL;
+	size_t left = *dstn;
+	size_t block_max, pos;
+	int has_block_checksum;
+	int ret;
+
+	*dstn = 0;
+	ret = lz4_parse_frame(src, srcn, &in, &block_max, &has_block_checksum);
+	if (ret)
+		return ret;
+
+	/*
+	 * Blocks before the range are skipped by their size, which is found
+	 * without decompressing them. This relies on every block except the
+	 * last one decompressing to exactly block_max bytes, which is checked.
+	 */
+	for (pos = 0; left; pos += block_max) {
+		struct lz4_block_header b, next;
+		size_t skip, size;
+		const void *next_in;
+		bool last;
+
+		b.raw = le32_to_cpu(*(u32 *)in);
+		in += sizeof(struct lz4_block_header);
+
+		if (in - src + b.size > srcn) {
+			ret = -EINVAL;		/* input overrun */
+			break;
+		}
+		if (!b.size)
+			break;			/* end of frame */
+
+		next_in = in + b.size;
+		if (has_block_checksum)
+			next_in += sizeof(u32);
+		next.raw = 0;
+		if (next_in - src + sizeof(next) <= srcn)
+			next.raw = le32_to_cpu(*(u32 *)next_in);
+		last = !next.size;
+
+		if (pos + block_max <= offset) {
+			/* the whole block comes before the range */
+			if (!last) {
+				ret = b.not_compressed ? b.size :
+					lz4_block_size(in, b.size);
+				if (ret != block_max) {
+					ret = -EPROTO;
+					break;
+				}
+			}
+		} else {
+			skip = offset > pos ? offset - pos : 0;
+			if (b.not_compressed) {
+				ret = b.size;
+				if (!last && ret != block_max) {
+					ret = -EPROTO;
+					break;
+				}
+				if (skip >= b.size)
+					break;	/* short last block */
+				size = min(b.size - skip, left);
+				memcpy(out, in + skip, size);
+			} else if (!skip && left >= block_max) {
+				/* the whole block fits, decompress in place */
+				ret = LZ4_decompress_generic(in, out, b.size,
+						block_max, endOnInputSize,
+						full, 0, noDict, out, NULL, 0);
+				if (ret < 0 || (!last && ret != block_max)) {
+					ret = -EPROTO;
+					break;
+				}
+				size = ret;
+			} else {
+				/* only part of the block is wanted */
+				if (!scratch) {
+					scratch = malloc(block_max);
+					if (!scratch) {
+						ret = -ENOMEM;
+						break;
+					}
+				}
+				ret = LZ4_decompress_generic(in, scratch,
+						b.size, block_max,
+						endOnInputSize, full, 0,
+						noDict, scratch, NULL, 0);
+				if (ret < 0 || (!last && ret != block_max)) {
+					ret = -EPROTO;
+					break;
+				}
+				if (skip >= (size_t)ret)
+					break;	/* short last block */
+				size = min(ret - skip, left);
+				memcpy(out, scratch + skip, size);
+			}
+			out += size;
+			left -= size;
+		}
+
+		in = next_in;
+	}
+	free(scratch);
+	if (ret > 0)
+		ret = 0;
+
+	*dstn = out - dst;
+	return ret;
+}
@@ -11,6 +11,7 @@
 
 #include <common.h>
 #include <hang.h>
+#include <serial.h>
 #if !defined(CONFIG_PANIC_HANG)
 #include <command.h>
 #endif
@@ -20,6 +21,7 @@ static void panic_finish(void) __attribute__ ((noreturn));
 static void panic_finish(void)
 {
 	putc('\n');
+	serial_flush();
 #if defined(CONFIG_PANIC_HANG)
 	hang();
 #else
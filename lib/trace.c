@@ -12,9 +12,19 @@
 
 DECLARE_GLOBAL_DATA_PTR;
 
+/* Maximum number of address ranges in the trace filter */
+#define TRACE_FILTER_MAX	8
+
 static char trace_enabled __attribute__((section(".data")));
 static char trace_inited __attribute__((section(".data")));
 
+/* A range of functions to allow / deny in the call list */
+struct trace_filter {
+	u32 start;		/* First function site in range */
+	u32 end;		/* Function site after the end of the range */
+	bool allow;		/* true to allow, false to deny */
+};
+
 /* The header block at the start of the trace memory area */
 struct trace_hdr {
 	int func_count;		/* Total number of function call sites */
@@ -32,7 +42,14 @@ struct trace_hdr {
 	struct trace_call *ftrace;	/* The function call records */
 	ulong ftrace_size;	/* Num. of ftrace records we have space for */
 	ulong ftrace_count;	/* Num. of ftrace records written */
+	ulong ftrace_used;	/* Num. of ftrace records held in the list */
+	ulong ftrace_pos;	/* Index of the next ftrace record to write */
 	ulong ftrace_too_deep_count;	/* Functions that were too deep */
+	ulong ftrace_filtered_count;	/* Functions excluded by the filter */
+
+	struct trace_filter filter[TRACE_FILTER_MAX];
+	int filter_count;	/* Number of ranges in filter[] */
+	int filter_allow_count;	/* Number of those which allow functions */
 
 	int depth;
 	int depth_limit;
@@ -100,33 +117,114 @@ static void __attribute__((no_instrument_function)) trace_swap_gd(void)
 
 #endif
 
+/**
+ * trace_get_timestamp() - get the timestamp for a trace record
+ *
+ * Architectures with a cycle counter can provide their own version of this
+ * and trace_get_timestamp_rate(), for finer timestamps and lower overhead.
+ *
+ * Return:	current time in microseconds
+ */
+uint64_t __weak __attribute__((no_instrument_function))
+		trace_get_timestamp(void)
+{
+	return timer_get_us();
+}
+
+ulong __weak __attribute__((no_instrument_function))
+		trace_get_timestamp_rate(void)
+{
+	return 1000000;
+}
+
+/**
+ * trace_filter_match() - check whether a function passes the trace filter
+ *
+ * @func:	function site number, as returned by func_ptr_to_num()
+ * Return:	true if calls to the function should be recorded
+ */
+static bool __attribute__((no_instrument_function))
+		trace_filter_match(ulong func)
+{
+	bool allow = !hdr->filter_allow_count;
+	int i;
+
+	for (i = 0; i < hdr->filter_count; i++) {
+		struct trace_filter *filt = &hdr->filter[i];
+
+		if (func >= filt->start && func < filt->end) {
+			if (!filt->allow)
+				return false;
+			allow = true;
+		}
+	}
+
+	return allow;
+}
+
+/**
+ * next_ftrace() - get the next record in the function call list
+ *
+ * Once the list is full this returns the oldest record with
+ * CONFIG_TRACE_RING, so that the list holds the most recent calls.
+ * Otherwise later calls are only counted.
+ *
+ * Return:	record to fill in, or NULL if there is no space
+ */
+static struct trace_call *__attribute__((no_instrument_function))
+		next_ftrace(void)
+{
+	struct trace_call *rec;
+
+	hdr->ftrace_count++;
+	if (hdr->ftrace_used < hdr->ftrace_size)
+		hdr->ftrace_used++;
+	else if (!IS_ENABLED(CONFIG_TRACE_RING) || !hdr->ftrace_size)
+		return NULL;
+
+	rec = &hdr->ftrace[hdr->ftrace_pos];
+	if (++hdr->ftrace_pos == hdr->ftrace_size)
+		hdr->ftrace_pos = 0;
+
+	return rec;
+}
+
 static void __attribute__((no_instrument_function)) add_ftrace(void *func_ptr,
 				void *caller, ulong flags)
 {
+	struct trace_call *rec;
+	ulong func;
+	u64 time;
+
 	if (hdr->depth > hdr->depth_limit) {
 		hdr->ftrace_too_deep_count++;
 		return;
 	}
-	if (hdr->ftrace_count < hdr->ftrace_size) {
-		struct trace_call *rec = &hdr->ftrace[hdr->ftrace_count];
-
-		rec->func = func_ptr_to_num(func_ptr);
+	func = func_ptr_to_num(func_ptr);
+	if (hdr->filter_count && !trace_filter_match(func)) {
+		hdr->ftrace_filtered_count++;
+		return;
+	}
+	rec = next_ftrace();
+	if (rec) {
+		time = trace_get_timestamp();
+		rec->func = func;
 		rec->caller = func_ptr_to_num(caller);
-		rec->flags = flags | (timer_get_us() & FUNCF_TIMESTAMP_MASK);
+		rec->flags = flags | (time & FUNCF_TIMESTAMP_MASK);
+		rec->time_hi = time >> 30;
 	}
-	hdr->ftrace_count++;
 }
 
 static void __attribute__((no_instrument_function)) add_textbase(void)
 {
-	if (hdr->ftrace_count < hdr->ftrace_size) {
-		struct trace_call *rec = &hdr->ftrace[hdr->ftrace_count];
+	struct trace_call *rec = next_ftrace();
 
+	if (rec) {
 		rec->func = CONFIG_SYS_TEXT_BASE;
 		rec->caller = 0;
 		rec->flags = FUNCF_TEXTBASE;
+		rec->time_hi = 0;
 	}
-	hdr->ftrace_count++;
 }
 
 /**
@@ -235,10 +333,11 @@ int trace_list_functions(void *buff, size_t buff_size, size_t *needed)
 }
 
 /**
- * trace_list_functions() - produce a list of function calls
+ * trace_list_calls() - produce a list of function calls
  *
- * The information is written into the supplied buffer - a header followed
- * by a list of function records.
+ * The information is written into the supplied buffer - a header giving the
+ * timestamp rate, then a header followed by a list of call records, oldest
+ * first.
  *
  * @buff:	buffer to place list into
  * @buff_size:	size of buffer
@@ -251,30 +350,40 @@ int trace_list_calls(void *buff, size_t buff_size, size_t *needed)
 	struct trace_output_hdr *output_hdr = NULL;
 	void *end, *ptr = buff;
 	size_t rec, upto;
-	size_t count;
+	ulong idx;
 
 	end = buff ? buff + buff_size : NULL;
 
+	/* Say how to convert the timestamps */
+	if (ptr + sizeof(struct trace_output_hdr) < end) {
+		output_hdr = ptr;
+		output_hdr->type = TRACE_CHUNK_TIMEBASE;
+		output_hdr->rec_count = trace_get_timestamp_rate();
+	}
+	ptr += sizeof(struct trace_output_hdr);
+
 	/* Place some header information */
+	output_hdr = NULL;
 	if (ptr + sizeof(struct trace_output_hdr) < end)
 		output_hdr = ptr;
 	ptr += sizeof(struct trace_output_hdr);
 
-	/* Add information about each call */
-	count = hdr->ftrace_count;
-	if (count > hdr->ftrace_size)
-		count = hdr->ftrace_size;
-	for (rec = upto = 0; rec < count; rec++) {
+	/* Add information about each call, starting with the oldest */
+	idx = hdr->ftrace_used < hdr->ftrace_size ? 0 : hdr->ftrace_pos;
+	for (rec = upto = 0; rec < hdr->ftrace_used; rec++) {
 		if (ptr + sizeof(struct trace_call) < end) {
-			struct trace_call *call = &hdr->ftrace[rec];
+			struct trace_call *call = &hdr->ftrace[idx];
 			struct trace_call *out = ptr;
 
 			out->func = call->func * FUNC_SITE_SIZE;
 			out->caller = call->caller * FUNC_SITE_SIZE;
 			out->flags = call->flags;
+			out->time_hi = call->time_hi;
 			upto++;
 		}
 		ptr += sizeof(struct trace_call);
+		if (++idx == hdr->ftrace_size)
+			idx = 0;
 	}
 
 	/* Update the header */
@@ -291,6 +400,74 @@ int trace_list_calls(void *buff, size_t buff_size, size_t *needed)
 	return 0;
 }
 
+/* Convert an address from System.map into a function site number */
+static ulong trace_addr_to_num(ulong addr)
+{
+#ifdef CONFIG_SANDBOX
+	addr -= (uintptr_t)&_init;
+#else
+	addr -= CONFIG_SYS_TEXT_BASE;
+#endif
+	return addr / FUNC_SITE_SIZE;
+}
+
+int trace_add_filter(ulong start, ulong end, int allow)
+{
+	struct trace_filter *filt;
+
+	if (!trace_inited)
+		return -ENOENT;
+	if (end <= start)
+		return -EINVAL;
+	if (hdr->filter_count == TRACE_FILTER_MAX)
+		return -ENOSPC;
+
+	filt = &hdr->filter[hdr->filter_count];
+	filt->start = trace_addr_to_num(start);
+	filt->end = trace_addr_to_num(end + FUNC_SITE_SIZE - 1);
+	filt->allow = allow != 0;
+	if (allow)
+		hdr->filter_allow_count++;
+	hdr->filter_count++;
+
+	return 0;
+}
+
+void trace_clear_filter(void)
+{
+	if (!trace_inited)
+		return;
+	hdr->filter_count = 0;
+	hdr->filter_allow_count = 0;
+}
+
+void trace_print_filter(void)
+{
+	ulong base;
+	int i;
+
+	if (!trace_inited) {
+		printf("Trace is disabled\n");
+		return;
+	}
+	if (!hdr->filter_count) {
+		printf("No filter: all functions are traced\n");
+		return;
+	}
+#ifdef CONFIG_SANDBOX
+	base = (uintptr_t)&_init;
+#else
+	base = CONFIG_SYS_TEXT_BASE;
+#endif
+	for (i = 0; i < hdr->filter_count; i++) {
+		struct trace_filter *filt = &hdr->filter[i];
+
+		printf("%-5s %08lx - %08lx\n", filt->allow ? "allow" : "deny",
+		       base + filt->start * FUNC_SITE_SIZE,
+		       base + filt->end * FUNC_SITE_SIZE);
+	}
+}
+
 /**
  * trace_print_stats() - print basic information about tracing
  */
@@ -312,14 +489,17 @@ void trace_print_stats(void)
 	puts(" function calls\n");
 	print_grouped_ull(hdr->untracked_count, 10);
 	puts(" untracked function calls\n");
-	count = min(hdr->ftrace_count, hdr->ftrace_size);
-	print_grouped_ull(count, 10);
+	print_grouped_ull(hdr->ftrace_used, 10);
 	puts(" traced function calls");
-	if (hdr->ftrace_count > hdr->ftrace_size) {
-		printf(" (%lu dropped due to overflow)",
-		       hdr->ftrace_count - hdr->ftrace_size);
+	count = hdr->ftrace_count - hdr->ftrace_used;
+	if (count) {
+		printf(" (%lu %s)", count,
+		       IS_ENABLED(CONFIG_TRACE_RING) ? "overwritten by later calls" :
+		       "dropped due to overflow");
 	}
 	puts("\n");
+	print_grouped_ull(hdr->ftrace_filtered_count, 10);
+	puts(" calls not traced due to filter\n");
 	printf("%15d maximum observed call depth\n", hdr->max_depth);
 	printf("%15d call depth limit\n", hdr->depth_limit);
 	print_grouped_ull(hdr->ftrace_too_deep_count, 10);
@@ -349,23 +529,35 @@ int __attribute__((no_instrument_function)) trace_init(void *buff,
 
 	if (!was_disabled) {
 #ifdef CONFIG_TRACE_EARLY
-		char *end;
-		ulong used;
+		struct trace_call *calls;
+		ulong head, used, first;
 
 		/*
 		 * Copy over the early trace data if we have it. Disable
-		 * tracing while we are doing this.
+		 * tracing while we are doing this. The call records are
+		 * copied oldest first, in case the early list has wrapped.
 		 */
 		trace_enabled = 0;
 		hdr = map_sysmem(CONFIG_TRACE_EARLY_ADDR,
 				 CONFIG_TRACE_EARLY_SIZE);
-		end = (char *)&hdr->ftrace[min(hdr->ftrace_count,
-					       hdr->ftrace_size)];
-		used = end - (char *)hdr;
+		head = (char *)hdr->ftrace - (char *)hdr;
+		used = head + hdr->ftrace_used * sizeof(struct trace_call);
 		printf("trace: copying %08lx bytes of early data from %x to %08lx\n",
 		       used, CONFIG_TRACE_EARLY_ADDR,
 		       (ulong)map_to_sysmem(buff));
-		memcpy(buff, hdr, used);
+		if (used > buff_size) {
+			printf("trace: buffer size %zd bytes: at least %lu needed\n",
+			       buff_size, used);
+			return -ENOSPC;
+		}
+		memcpy(buff, hdr, head);
+		calls = buff + head;
+		first = hdr->ftrace_used < hdr->ftrace_size ? 0 :
+			hdr->ftrace_pos;
+		memcpy(calls, &hdr->ftrace[first],
+		       (hdr->ftrace_used - first) * sizeof(*calls));
+		memcpy(&calls[hdr->ftrace_used - first], hdr->ftrace,
+		       first * sizeof(*calls));
 #else
 		puts("trace: already enabled\n");
 		return -EALREADY;
@@ -387,6 +579,8 @@ int __attribute__((no_instrument_function)) trace_init(void *buff,
 	/* Use any remaining space for the timed function trace */
 	hdr->ftrace = (struct trace_call *)(buff + needed);
 	hdr->ftrace_size = (buff_size - needed) / sizeof(*hdr->ftrace);
+	hdr->ftrace_pos = hdr->ftrace_used < hdr->ftrace_size ?
+		hdr->ftrace_used : 0;
 	add_textbase();
 
 	puts("trace: enabled\n");
@@ -31,6 +31,73 @@
 #  define PUP(a) *++(a)
 #endif
 
+#ifdef CONFIG_ZLIB_INFLATE_FAST_CHUNK
+/*
+ * U-Boot: copy matches a machine word ("chunk") at a time.  The packed
+ * struct lets the compiler emit plain loads and stores on CPUs that handle
+ * unaligned accesses, which is why this is only enabled on such CPUs.
+ */
+typedef unsigned long chunk_t;
+#define CHUNK_SIZE sizeof(chunk_t)
+
+struct chunk_unaligned {
+    chunk_t val;
+} __packed;
+
+static inline chunk_t chunk_load(const unsigned char FAR *p)
+{
+    return ((const struct chunk_unaligned *)p)->val;
+}
+
+static inline void chunk_store(unsigned char FAR *p, chunk_t val)
+{
+    ((struct chunk_unaligned *)p)->val = val;
+}
+
+/*
+   Copy a len byte match starting dist bytes back in the output to out,
+   which is a real (not OFF-adjusted) pointer.  The copy is done in whole
+   chunks and may write up to CHUNK_SIZE - 1 bytes beyond the end of the
+   match, so the caller must make sure that there is room for this.  Returns
+   the new output pointer.
+ */
+static inline unsigned char FAR *chunk_copy(unsigned char FAR *out,
+                                            unsigned dist, unsigned len)
+{
+    const unsigned char FAR *from = out - dist;
+    unsigned char FAR *end = out + len;
+    union {
+        chunk_t val;
+        unsigned char b[CHUNK_SIZE];
+    } pat;
+    unsigned step;
+    unsigned i;
+
+    if (dist >= CHUNK_SIZE) {
+        /* each chunk read lies entirely in already-written output */
+        do {
+            chunk_store(out, chunk_load(from));
+            out += CHUNK_SIZE;
+            from += CHUNK_SIZE;
+        } while (out < end);
+        return end;
+    }
+
+    /*
+     * Short distance: build a chunk holding the repeated pattern and store
+     * it, advancing by the largest multiple of dist that fits in a chunk.
+     */
+    for (i = 0; i < CHUNK_SIZE; i++)
+        pat.b[i] = i < dist ? from[i] : pat.b[i - dist];
+    step = CHUNK_SIZE - CHUNK_SIZE % dist;
+    do {
+        chunk_store(out, pat.val);
+        out += step;
+    } while (out < end);
+    return end;
+}
+#endif /* CONFIG_ZLIB_INFLATE_FAST_CHUNK */
+
 /*
    Decode literal, length, and distance codes and write out the resulting
    literal and match bytes until either not enough input or output is
@@ -94,6 +161,12 @@ void inflate_fast(z_streamp strm, unsigned start)
     unsigned len;               /* match length, unused bytes */
     unsigned dist;              /* match distance */
     unsigned char FAR *from;    /* where to copy match from */
+#ifdef CONFIG_ZLIB_INFLATE_FAST_CHUNK
+#if BITS_PER_LONG == 64
+    unsigned char FAR *lastw;   /* while in < lastw, a whole word readable */
+#endif
+    unsigned char FAR *safe;    /* chunk copy if out + len <= safe */
+#endif
 
     /* copy state to local variables */
     state = (struct inflate_state FAR *)strm->state;
@@ -110,6 +183,14 @@ void inflate_fast(z_streamp strm, unsigned start)
     out = strm->next_out - OFF;
     beg = out - (start - strm->avail_out);
     end = out + (strm->avail_out - 257);
+#ifdef CONFIG_ZLIB_INFLATE_FAST_CHUNK
+#if BITS_PER_LONG == 64
+    lastw = in;
+    if (strm->avail_in > CHUNK_SIZE)
+        lastw += strm->avail_in - (CHUNK_SIZE - 1);
+#endif
+    safe = end + 257 - (CHUNK_SIZE - 1);
+#endif
 #ifdef INFLATE_STRICT
     dmax = state->dmax;
 #endif
@@ -127,6 +208,22 @@ void inflate_fast(z_streamp strm, unsigned start)
     /* decode literals and length/distances until end-of-block or not enough
        input data or output space */
     do {
+#if defined(CONFIG_ZLIB_INFLATE_FAST_CHUNK) && BITS_PER_LONG == 64
+        /*
+         * Refill with a single 64-bit load, taking as many whole bytes as
+         * fit.  This leaves at least 56 bits, enough for a complete
+         * length/distance pair, so the refills below are rarely needed.
+         * The bit buffer is filled from the low end, so the bytes must be
+         * loaded little-endian whatever the CPU's byte order.
+         */
+        if (bits < 15 && in < lastw) {
+            len = (63 - bits) >> 3;
+            hold += (get_unaligned_le64(in + OFF) &
+                     ((1UL << (len << 3)) - 1)) << bits;
+            in += len;
+            bits += len << 3;
+        }
+#endif
         if (bits < 15) {
             hold += (unsigned long)(PUP(in)) << bits;
             bits += 8;
@@ -252,6 +349,11 @@ void inflate_fast(z_streamp strm, unsigned start)
                             PUP(out) = PUP(from);
                     }
                 }
+#ifdef CONFIG_ZLIB_INFLATE_FAST_CHUNK
+                else if (out + len <= safe) {   /* copy direct, in chunks */
+                    out = chunk_copy(out + OFF, dist, len) - OFF;
+                }
+#endif
                 else {
 		    unsigned short *sout;
 		    unsigned long loops;
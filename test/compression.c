@@ -11,6 +11,7 @@
 #include <malloc.h>
 #include <mapmem.h>
 #include <asm/io.h>
+#include <asm/unaligned.h>
 
 #include <u-boot/zlib.h>
 #include <bzlib.h>
@@ -20,6 +21,7 @@
 #include <lzma/LzmaTools.h>
 
 #include <linux/lzo.h>
+#include <linux/sizes.h>
 #include <test/compression.h>
 #include <test/suites.h>
 #include <test/ut.h>
@@ -438,6 +440,192 @@ static int compression_test_lz4(struct unit_test_state *uts)
 }
 COMPRESSION_TEST(compression_test_lz4, 0);
 
+/* Decompress a few ranges of an LZ4 frame and check them against the input */
+static int compression_test_lz4_range(struct unit_test_state *uts)
+{
+	const size_t plain_len = strlen(plain);
+	char buf[TEST_BUFFER_SIZE];
+	size_t size;
+
+	/* part of the single block, which needs a temporary buffer */
+	size = 50;
+	ut_assertok(ulz4fn_range(lz4_compressed, lz4_compressed_size, 10, buf,
+				 &size));
+	ut_asserteq(50, size);
+	ut_assertok(memcmp(plain + 10, buf, size));
+
+	/* range running past the end of the data */
+	size = sizeof(buf);
+	ut_assertok(ulz4fn_range(lz4_compressed, lz4_compressed_size,
+				 plain_len - 20, buf, &size));
+	ut_asserteq(20, size);
+	ut_assertok(memcmp(plain + plain_len - 20, buf, size));
+
+	/* range starting past the end of the data */
+	size = sizeof(buf);
+	ut_assertok(ulz4fn_range(lz4_compressed, lz4_compressed_size,
+				 plain_len, buf, &size));
+	ut_asserteq(0, size);
+
+	return 0;
+}
+COMPRESSION_TEST(compression_test_lz4_range, 0);
+
+/* Byte @i of the test data in an LZ4 block, which repeats every 8 bytes */
+static u8 lz4_test_byte(int seed, size_t i)
+{
+	return seed * 16 + i % 8;
+}
+
+/**
+ * lz4_test_add_block() - Add a block to an LZ4 frame being built
+ *
+ * A compressed block holds 8 literals, a match repeating them up to the last
+ * 8 bytes, then those 8 bytes as literals.
+ *
+ * @p: Place to write the block header
+ * @seed: Value used to generate the data, see lz4_test_byte()
+ * @len: Uncompressed size of the block, at least 20
+ * @raw: true to store the data uncompressed
+ * @return pointer to the byte after the block
+ */
+static u8 *lz4_test_add_block(u8 *p, int seed, size_t len, bool raw)
+{
+	u8 *start = p + sizeof(u32);
+	size_t i, ml;
+	u32 hdr;
+
+	p = start;
+	if (raw) {
+		for (i = 0; i < len; i++)
+			*p++ = lz4_test_byte(seed, i);
+		hdr = len | BIT(31);
+	} else {
+		*p++ = 8 << 4 | 15;
+		for (i = 0; i < 8; i++)
+			*p++ = lz4_test_byte(seed, i);
+		*p++ = 8;
+		*p++ = 0;
+		for (ml = len - 16 - 4 - 15; ml >= 255; ml -= 255)
+			*p++ = 255;
+		*p++ = ml;
+		*p++ = 8 << 4;
+		for (i = len - 8; i < len; i++)
+			*p++ = lz4_test_byte(seed, i);
+		hdr = p - start;
+	}
+	put_unaligned_le32(hdr, start - sizeof(u32));
+
+	return p;
+}
+
+/**
+ * lz4_test_frame() - Build an LZ4 frame with 64KiB blocks
+ *
+ * Block n uses seed n + 1 for its data
+ *
+ * @frame: Place to put the frame
+ * @lens: Uncompressed size of each block
+ * @raw: Whether each block is stored uncompressed
+ * @count: Number of blocks
+ * @return size of the frame
+ */
+static size_t lz4_test_frame(u8 *frame, const size_t *lens, const bool *raw,
+			     int count)
+{
+	u8 *p = frame;
+	int i;
+
+	put_unaligned_le32(LZ4F_MAGIC, p);
+	p += sizeof(u32);
+	*p++ = 0x60;	/* version 1, independent blocks */
+	*p++ = 0x40;	/* 64KiB blocks */
+	*p++ = 0;	/* header checksum, which is not checked */
+	for (i = 0; i < count; i++)
+		p = lz4_test_add_block(p, i + 1, lens[i], raw[i]);
+	put_unaligned_le32(0, p);	/* EndMark */
+	p += sizeof(u32);
+
+	return p - frame;
+}
+
+/* Decompress ranges of a frame with several blocks */
+static int compression_test_lz4_range_blocks(struct unit_test_state *uts)
+{
+	const size_t block = SZ_64K;
+	const size_t lens[] = { block, block, 1000 };
+	const bool raw[] = { false, true, false };
+	const size_t total = 2 * block + 1000;
+	const size_t short_lens[] = { 1000, block };
+	const bool raw_none[] = { false, false };
+	const bool raw_first[] = { true, false };
+	u8 *frame, *expect, *buf;
+	size_t frame_size, size;
+	size_t i;
+
+	frame = malloc(block * 2);
+	expect = malloc(total);
+	buf = malloc(total);
+	ut_assertnonnull(frame);
+	ut_assertnonnull(expect);
+	ut_assertnonnull(buf);
+	for (i = 0; i < total; i++)
+		expect[i] = lz4_test_byte(i / block + 1, i % block);
+	frame_size = lz4_test_frame(frame, lens, raw, ARRAY_SIZE(lens));
+
+	/* the whole frame */
+	size = total;
+	ut_assertok(ulz4fn(frame, frame_size, buf, &size));
+	ut_asserteq(total, size);
+	ut_assertok(memcmp(expect, buf, size));
+
+	/* range in the last block, skipping a compressed and a raw block */
+	size = 500;
+	ut_assertok(ulz4fn_range(frame, frame_size, 2 * block + 100, buf,
+				 &size));
+	ut_asserteq(500, size);
+	ut_assertok(memcmp(expect + 2 * block + 100, buf, size));
+
+	/* range crossing from the first block into the second */
+	size = 200;
+	ut_assertok(ulz4fn_range(frame, frame_size, block - 100, buf, &size));
+	ut_asserteq(200, size);
+	ut_assertok(memcmp(expect + block - 100, buf, size));
+
+	/* whole blocks, the first decompressed in place */
+	size = 2 * block;
+	ut_assertok(ulz4fn_range(frame, frame_size, 0, buf, &size));
+	ut_asserteq(2 * block, size);
+	ut_assertok(memcmp(expect, buf, size));
+
+	/* range running past the end of the data */
+	size = 100;
+	ut_assertok(ulz4fn_range(frame, frame_size, total - 10, buf, &size));
+	ut_asserteq(10, size);
+	ut_assertok(memcmp(expect + total - 10, buf, size));
+
+	/* a short block which is not the last must be rejected */
+	frame_size = lz4_test_frame(frame, short_lens, raw_none,
+				    ARRAY_SIZE(short_lens));
+	size = 100;
+	ut_asserteq(-EPROTO, ulz4fn_range(frame, frame_size, block + 10, buf,
+					  &size));
+	size = 100;
+	ut_asserteq(-EPROTO, ulz4fn_range(frame, frame_size, 0, buf, &size));
+	frame_size = lz4_test_frame(frame, short_lens, raw_first,
+				    ARRAY_SIZE(short_lens));
+	size = 100;
+	ut_asserteq(-EPROTO, ulz4fn_range(frame, frame_size, block + 10, buf,
+					  &size));
+
+	free(buf);
+	free(expect);
+	free(frame);
+
+	return 0;
+}
+COMPRESSION_TEST(compression_test_lz4_range_blocks, 0);
+
 static int compress_using_none(struct unit_test_state *uts,
 			       void *in, unsigned long in_size,
 			       void *out, unsigned long out_max,
@@ -534,6 +722,82 @@ static int compression_test_bootm_none(struct unit_test_state *uts)
 }
 COMPRESSION_TEST(compression_test_bootm_none, 0);
 
+#define BENCH_SIZE	(1 << 20)
+#define BENCH_LOOPS	8
+
+/**
+ * fill_bench_buf() - Fill a buffer with moderately compressible data
+ *
+ * This mixes copies of the plain text with runs and a little pseudo-random
+ * noise, so that the inflate fast path sees a range of match lengths and
+ * distances, rather than just the long runs of a trivial input.
+ *
+ * @buf:	Buffer to fill
+ * @size:	Size of buffer in bytes
+ */
+static void fill_bench_buf(char *buf, ulong size)
+{
+	const ulong plain_len = strlen(plain);
+	uint seed = 0x1234;
+	ulong pos, len;
+
+	for (pos = 0; pos < size; pos += len) {
+		seed = seed * 1103515245 + 12345;
+		len = min((ulong)(seed >> 24) + 1, size - pos);
+		switch ((seed >> 16) & 3) {
+		case 0:
+			memset(buf + pos, seed >> 8, len);
+			break;
+		case 1:
+			len = min(len, (ulong)(seed >> 20) & 7) ?: 1;
+			memset(buf + pos, seed, len);
+			break;
+		default:
+			len = min(len, plain_len - (seed >> 8) % plain_len);
+			memcpy(buf + pos, plain + (seed >> 8) % plain_len, len);
+			break;
+		}
+	}
+}
+
+/* Measure gunzip() throughput on a 1MB buffer and check the result */
+static int compression_test_gzip_speed(struct unit_test_state *uts)
+{
+	unsigned long comp_size, uncomp_size;
+	void *orig, *comp, *uncomp;
+	ulong start, elapsed;
+	int i;
+
+	orig = malloc(BENCH_SIZE);
+	comp = malloc(BENCH_SIZE);
+	uncomp = malloc(BENCH_SIZE);
+	ut_assert(orig && comp && uncomp);
+
+	fill_bench_buf(orig, BENCH_SIZE);
+	comp_size = BENCH_SIZE;
+	ut_assertok(gzip(comp, &comp_size, orig, BENCH_SIZE));
+
+	start = (ulong)timer_get_us();
+	for (i = 0; i < BENCH_LOOPS; i++) {
+		uncomp_size = comp_size;
+		ut_assertok(gunzip(uncomp, BENCH_SIZE, comp, &uncomp_size));
+	}
+	elapsed = max((ulong)timer_get_us() - start, 1UL);
+
+	ut_asserteq(BENCH_SIZE, uncomp_size);
+	ut_assertok(memcmp(orig, uncomp, BENCH_SIZE));
+	printf("gunzip: %lu -> %d bytes, %lu KiB/s\n", comp_size, BENCH_SIZE,
+	       (ulong)((u64)BENCH_SIZE * BENCH_LOOPS * 1000000 / 1024 /
+		       elapsed));
+
+	free(uncomp);
+	free(comp);
+	free(orig);
+
+	return 0;
+}
+COMPRESSION_TEST(compression_test_gzip_speed, 0);
+
 int do_ut_compression(cmd_tbl_t *cmdtp, int flag, int argc, char * const argv[])
 {
 	struct unit_test *tests = ll_entry_start(struct unit_test,
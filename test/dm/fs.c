@@ -0,0 +1,129 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Tests for files kept open in the file system layer
+ */
+
+#include <common.h>
+#include <blk.h>
+#include <dm.h>
+#include <fat.h>
+#include <fs.h>
+#include <mapmem.h>
+#include <os.h>
+#include <part.h>
+#include <sandboxblockdev.h>
+#include <dm/test.h>
+#include <linux/sizes.h>
+#include <test/ut.h>
+
+#define FS_TEST_IMAGE	"fs_file_test.img"
+#define FS_TEST_FILE	"/test.txt"
+
+/*
+ * Boot sector of a 1MiB FAT12 file system with one sector per cluster, two
+ * six-sector FATs and a 112-entry root directory
+ */
+static const u8 fs_test_boot_sector[] = {
+	0xeb, 0x3c, 0x90, 'U', '-', 'B', 'o', 'o', 't', ' ', ' ',
+	0x00, 0x02,		/* bytes per sector */
+	0x01,			/* sectors per cluster */
+	0x01, 0x00,		/* reserved sectors */
+	0x02,			/* FATs */
+	0x70, 0x00,		/* root directory entries */
+	0x00, 0x08,		/* sectors */
+	0xf8,			/* media */
+	0x06, 0x00,		/* sectors per FAT */
+	0x20, 0x00, 0x02, 0x00,	/* sectors per track, heads */
+	0x00, 0x00, 0x00, 0x00,	/* hidden sectors */
+	0x00, 0x00, 0x00, 0x00,	/* sectors, 32-bit */
+	0x80, 0x00, 0x29,	/* drive, reserved, signature */
+	0x78, 0x56, 0x34, 0x12,	/* serial number */
+	'N', 'O', ' ', 'N', 'A', 'M', 'E', ' ', ' ', ' ', ' ',
+	'F', 'A', 'T', '1', '2', ' ', ' ', ' ',
+};
+
+/* Create an empty FAT file system in a file and attach it to host 0 */
+static int fs_test_make_image(struct unit_test_state *uts)
+{
+	static const u8 fat[] = { 0xf8, 0xff, 0xff };
+	u8 sector[512];
+	int fd, i;
+
+	fd = os_open(FS_TEST_IMAGE, OS_O_RDWR | OS_O_CREAT | OS_O_TRUNC);
+	ut_assert(fd >= 0);
+
+	memset(sector, '\0', sizeof(sector));
+	memcpy(sector, fs_test_boot_sector, sizeof(fs_test_boot_sector));
+	sector[510] = 0x55;
+	sector[511] = 0xaa;
+	ut_asserteq(sizeof(sector), os_write(fd, sector, sizeof(sector)));
+
+	/* The first two entries of each FAT are reserved */
+	for (i = 0; i < 2; i++) {
+		ut_asserteq(512 + i * 6 * 512,
+			    os_lseek(fd, 512 + i * 6 * 512, OS_SEEK_SET));
+		ut_asserteq(sizeof(fat), os_write(fd, fat, sizeof(fat)));
+	}
+
+	/* Zero the rest */
+	ut_asserteq(SZ_1M - 1, os_lseek(fd, SZ_1M - 1, OS_SEEK_SET));
+	ut_asserteq(1, os_write(fd, "", 1));
+	os_close(fd);
+
+	ut_assertok(host_dev_bind(0, FS_TEST_IMAGE));
+
+	return 0;
+}
+
+/* Test that an open file notices writes which bypass the fs layer */
+static int dm_test_fs_file_blk_write(struct unit_test_state *uts)
+{
+	char data[300], buf[300], new_data[] = "0123456789";
+	struct blk_desc *desc;
+	disk_partition_t info;
+	struct fs_file *file;
+	loff_t size, actual;
+	int i;
+
+	ut_assertok(fs_test_make_image(uts));
+	for (i = 0; i < sizeof(data); i++)
+		data[i] = 'a' + i % 26;
+
+	/* Create the file and open it */
+	ut_assertok(fs_set_blk_dev("host", "0:0", FS_TYPE_FAT));
+	ut_assertok(fs_write(FS_TEST_FILE, map_to_sysmem(data), 0,
+			     sizeof(data), &actual));
+	ut_asserteq(sizeof(data), actual);
+	ut_assertok(fs_set_blk_dev("host", "0:0", FS_TYPE_FAT));
+	file = fs_file_open(FS_TEST_FILE);
+	ut_assertnonnull(file);
+	ut_assertok(fs_file_size(file, &size));
+	ut_asserteq(sizeof(data), size);
+
+	/* Rewrite it through the FAT driver, as env/fat.c does */
+	ut_asserteq(0, blk_get_device_part_str("host", "0:0", &desc, &info,
+					       1));
+	ut_assertok(fat_set_blk_dev(desc, &info));
+	ut_assertok(file_fat_write(FS_TEST_FILE, new_data, 0, 10, &actual));
+	ut_asserteq(10, actual);
+
+	/* The open file must see the new contents */
+	ut_assertok(fs_file_size(file, &size));
+	ut_asserteq(10, size);
+	memset(buf, '\0', sizeof(buf));
+	ut_assertok(fs_file_read(file, map_to_sysmem(buf), 0, 0, &actual));
+	ut_asserteq(10, actual);
+	ut_asserteq_str(new_data, buf);
+
+	/* Reads through the fs layer still work while the file is open */
+	ut_assertok(fs_set_blk_dev("host", "0:0", FS_TYPE_FAT));
+	ut_assertok(fs_size(FS_TEST_FILE, &size));
+	ut_asserteq(10, size);
+
+	fs_file_close(file);
+	ut_assertok(host_dev_bind(0, NULL));
+	os_unlink(FS_TEST_IMAGE);
+
+	return 0;
+}
+DM_TEST(dm_test_fs_file_blk_write, DM_TESTF_SCAN_PDATA | DM_TESTF_SCAN_FDT);
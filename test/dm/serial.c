@@ -5,7 +5,9 @@
 
 #include <common.h>
 #include <serial.h>
+#include <stdio_dev.h>
 #include <dm.h>
+#include <asm/test.h>
 #include <dm/test.h>
 #include <test/ut.h>
 
@@ -67,3 +69,51 @@ static int dm_test_serial(struct unit_test_state *uts)
 }
 
 DM_TEST(dm_test_serial, DM_TESTF_SCAN_FDT);
+
+#if CONFIG_IS_ENABLED(SERIAL_TX_BUFFER)
+/*
+ * Test that output is queued while the UART is busy, sent by a flush and
+ * queued again once buffering is resumed
+ */
+static int dm_test_serial_tx_buffer(struct unit_test_state *uts)
+{
+	struct serial_dev_priv *upriv;
+	struct udevice *dev;
+	ulong count;
+
+	ut_assertok(uclass_get_device_by_name(UCLASS_SERIAL, "serial", &dev));
+	upriv = dev_get_uclass_priv(dev);
+	ut_assertnonnull(upriv->tx_buf);
+	ut_assertnonnull(upriv->sdev);
+
+	/* The UART takes two characters and the rest are queued */
+	count = sandbox_serial_get_tx_count(dev);
+	sandbox_serial_set_tx_space(dev, 2);
+	upriv->sdev->puts(upriv->sdev, "abcd");
+	sandbox_serial_set_tx_space(dev, -1);
+	ut_asserteq(count + 2, sandbox_serial_get_tx_count(dev));
+	ut_asserteq(2, upriv->tx_wr_ptr - upriv->tx_rd_ptr);
+
+	/* A flush sends the rest and stops queueing */
+	serial_flush();
+	ut_asserteq(count + 4, sandbox_serial_get_tx_count(dev));
+	ut_asserteq(0, upriv->tx_wr_ptr - upriv->tx_rd_ptr);
+	ut_assert(upriv->tx_stopped);
+
+	/* Once resumed, output is queued again */
+	serial_resume_buffer();
+	ut_assert(!upriv->tx_stopped);
+	sandbox_serial_set_tx_space(dev, 2);
+	upriv->sdev->puts(upriv->sdev, "efgh");
+	sandbox_serial_set_tx_space(dev, -1);
+	ut_asserteq(count + 6, sandbox_serial_get_tx_count(dev));
+	ut_asserteq(2, upriv->tx_wr_ptr - upriv->tx_rd_ptr);
+
+	serial_flush();
+	ut_asserteq(count + 8, sandbox_serial_get_tx_count(dev));
+	serial_resume_buffer();
+
+	return 0;
+}
+DM_TEST(dm_test_serial_tx_buffer, DM_TESTF_SCAN_FDT);
+#endif
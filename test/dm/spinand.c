@@ -0,0 +1,73 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Tests for the SPI NAND core, using the sandbox SPI NAND emulation
+ */
+
+#include <common.h>
+#include <dm.h>
+#include <malloc.h>
+#include <mtd.h>
+#include <spi.h>
+#include <spi_flash.h>
+#include <asm/state.h>
+#include <asm/test.h>
+#include <dm/test.h>
+#include <linux/mtd/spinand.h>
+#include <test/ut.h>
+
+/* Check that each read mode gives the same data */
+static int dm_test_spinand_read_modes(struct unit_test_state *uts)
+{
+	static const enum spinand_read_mode modes[] = {
+		SPINAND_READ_PAGE, SPINAND_READ_CONT,
+	};
+	struct mtd_info *mtd;
+	struct udevice *dev;
+	uint pagesize, pos, i, m;
+	loff_t from;
+	size_t len, retlen;
+	u8 *buf;
+
+	ut_assertok(uclass_get_device_by_name(UCLASS_MTD, "spi-nand@0", &dev));
+	mtd = dev_get_uclass_priv(dev);
+	pagesize = mtd->writesize;
+
+	/* The emulated chip supports continuous read, so that is the default */
+	ut_asserteq(SPINAND_READ_CONT,
+		    spinand_mtd_set_read_mode(mtd, SPINAND_READ_PAGE));
+	ut_asserteq(-ENOTSUPP,
+		    spinand_mtd_set_read_mode(mtd, SPINAND_READ_CACHE_SEQ));
+
+	/*
+	 * Start part way into a page, near the end of an eraseblock, so that
+	 * a continuous read is split at the start, the end and the eraseblock
+	 * boundary
+	 */
+	from = 2 * mtd->erasesize - 4 * pagesize + 100;
+	len = 8 * pagesize;
+	buf = malloc(len);
+	ut_assertnonnull(buf);
+
+	for (m = 0; m < ARRAY_SIZE(modes); m++) {
+		ut_assert(spinand_mtd_set_read_mode(mtd, modes[m]) >= 0);
+		memset(buf, '\0', len);
+		ut_assertok(mtd_read(mtd, from, len, &retlen, buf));
+		ut_asserteq(len, retlen);
+		for (i = 0; i < len; i++) {
+			pos = from + i;
+			ut_asserteq(sandbox_spinand_data(pos / pagesize,
+							 pos % pagesize),
+				    buf[i]);
+		}
+	}
+	free(buf);
+
+	/*
+	 * Since we are about to destroy all devices, we must tell sandbox
+	 * to forget the emulation device
+	 */
+	sandbox_sf_unbind_emul(state_get_current(), 1, 0);
+
+	return 0;
+}
+DM_TEST(dm_test_spinand_read_modes, DM_TESTF_SCAN_PDATA | DM_TESTF_SCAN_FDT);
@@ -40,6 +40,52 @@ static int dm_test_video_base(struct unit_test_state *uts)
 }
 DM_TEST(dm_test_video_base, DM_TESTF_SCAN_PDATA | DM_TESTF_SCAN_FDT);
 
+#ifdef CONFIG_VIDEO_DAMAGE
+/* Test that the damaged area grows, is clipped and is reset by a sync */
+static int dm_test_video_damage(struct unit_test_state *uts)
+{
+	struct video_priv *priv;
+	struct udevice *dev;
+
+	ut_assertok(uclass_get_device(UCLASS_VIDEO, 0, &dev));
+	priv = dev_get_uclass_priv(dev);
+	video_sync(dev, true);
+	ut_assert(priv->damage.xstart >= priv->damage.xend);
+
+	video_damage(dev, 10, 20, 30, 40);
+	ut_asserteq(10, priv->damage.xstart);
+	ut_asserteq(20, priv->damage.ystart);
+	ut_asserteq(40, priv->damage.xend);
+	ut_asserteq(60, priv->damage.yend);
+
+	video_damage(dev, 100, 5, 10, 10);
+	ut_asserteq(10, priv->damage.xstart);
+	ut_asserteq(5, priv->damage.ystart);
+	ut_asserteq(110, priv->damage.xend);
+	ut_asserteq(60, priv->damage.yend);
+
+	/* Areas are clipped to the display, and empty ones are ignored */
+	video_damage(dev, -5, 700, 20, 200);
+	ut_asserteq(0, priv->damage.xstart);
+	ut_asserteq(768, priv->damage.yend);
+	video_damage(dev, 2000, 0, 10, 10);
+	ut_asserteq(110, priv->damage.xend);
+
+	video_sync(dev, true);
+	ut_assert(priv->damage.xstart >= priv->damage.xend);
+
+	/* Clearing the display damages all of it */
+	ut_assertok(video_clear(dev));
+	ut_asserteq(0, priv->damage.xstart);
+	ut_asserteq(1366, priv->damage.xend);
+	video_sync(dev, true);
+	ut_assert(priv->damage.xstart >= priv->damage.xend);
+
+	return 0;
+}
+DM_TEST(dm_test_video_damage, DM_TESTF_SCAN_PDATA | DM_TESTF_SCAN_FDT);
+#endif
+
 /**
  * compress_frame_buffer() - Compress the frame buffer and return its size
  *
@@ -0,0 +1,132 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Tests for the environment change log
+ */
+
+#include <common.h>
+#include <env.h>
+#include <env_internal.h>
+#include <malloc.h>
+#include <test/env.h>
+#include <test/ut.h>
+
+/* Small enough that a few large values fill it up */
+#define LOG_SIZE	0x100
+
+static u8 log_buf[LOG_SIZE];
+
+static int delta_test_read(struct env_delta *delta, ulong offset, ulong len,
+			   void *buf)
+{
+	memcpy(buf, log_buf + offset, len);
+
+	return 0;
+}
+
+static int delta_test_write(struct env_delta *delta, ulong offset, ulong len,
+			    const void *buf)
+{
+	memcpy(log_buf + offset, buf, len);
+
+	return 0;
+}
+
+/* Check whether the log holds the given bytes anywhere */
+static bool log_has(const char *str, int len)
+{
+	int i;
+
+	for (i = 0; i + len <= LOG_SIZE; i++) {
+		if (!memcmp(log_buf + i, str, len))
+			return true;
+	}
+
+	return false;
+}
+
+/* Like MMC, the log is not erased before it is started afresh */
+static struct env_delta delta_test = {
+	.size	= LOG_SIZE,
+	.read	= delta_test_read,
+	.write	= delta_test_write,
+};
+
+static int env_test_delta(struct unit_test_state *uts)
+{
+	char val[100];
+	env_t *base;
+	int ret, i;
+
+	base = calloc(1, sizeof(*base));
+	ut_assertnonnull(base);
+	memset(log_buf, '\0', sizeof(log_buf));
+
+	/* Start a log for an environment copy */
+	ut_assertok(env_set("delta_a", "1"));
+	ut_assertok(env_set("delta_b", "2"));
+	base->crc = 0x1234;
+	ut_assertok(env_delta_reset(&delta_test, base));
+
+	/* Only the changes are appended */
+	ut_assertok(env_set("delta_a", "3"));
+	ut_assertok(env_set("delta_b", NULL));
+	ut_assertok(env_delta_save(&delta_test));
+	ut_assert(log_has("delta_a=3", 10));
+	ut_assert(log_has("delta_b", 8));
+	ut_assert(!log_has("delta_b=", 8));
+
+	/* Saving again with nothing changed appends nothing */
+	memcpy(val, log_buf, sizeof(val));
+	ut_assertok(env_delta_save(&delta_test));
+	ut_asserteq_mem(val, log_buf, sizeof(val));
+
+	/* The changes are replayed on load */
+	ut_assertok(env_set("delta_a", "4"));
+	ut_assertok(env_set("delta_b", "5"));
+	env_delta_load(&delta_test, base);
+	ut_asserteq_str("3", env_get("delta_a"));
+	ut_assertnull(env_get("delta_b"));
+
+	/* ...but not on top of another environment copy */
+	base->crc = 0x5678;
+	ut_assertok(env_set("delta_a", "4"));
+	env_delta_load(&delta_test, base);
+	ut_asserteq_str("4", env_get("delta_a"));
+	ut_asserteq(-ENOSPC, env_delta_save(&delta_test));
+
+	/* Start a log for a full save, then fill it up */
+	ut_assertok(env_delta_reset(&delta_test, base));
+	memset(val, 'x', sizeof(val) - 1);
+	val[sizeof(val) - 1] = '\0';
+	for (i = 0; i < LOG_SIZE / sizeof(val) + 1; i++) {
+		val[0] = '0' + i;
+		ut_assertok(env_set("delta_a", val));
+		ret = env_delta_save(&delta_test);
+		if (ret)
+			break;
+	}
+	ut_asserteq(-ENOSPC, ret);
+	ut_assert(i > 0);
+
+	/*
+	 * The driver now saves the whole environment and starts a new log.
+	 * Records left over from the old log must not be replayed.
+	 */
+	ut_assertok(env_delta_reset(&delta_test, base));
+	ut_assertok(env_set("delta_a", "6"));
+	env_delta_load(&delta_test, base);
+	ut_asserteq_str("6", env_get("delta_a"));
+
+	/* The new log is used as normal */
+	ut_assertok(env_set("delta_a", "7"));
+	ut_assertok(env_delta_save(&delta_test));
+	ut_assertok(env_set("delta_a", "8"));
+	env_delta_load(&delta_test, base);
+	ut_asserteq_str("7", env_get("delta_a"));
+
+	ut_assertok(env_set("delta_a", NULL));
+	free(base);
+
+	return 0;
+}
+ENV_TEST(env_test_delta, 0);
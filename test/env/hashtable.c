@@ -123,3 +123,168 @@ static int env_test_htab_deletes(struct unit_test_state *uts)
 }
 
 ENV_TEST(env_test_htab_deletes, 0);
+
+/* Fill the hashtable far beyond its initial size */
+static int env_test_htab_grow(struct unit_test_state *uts)
+{
+	struct hsearch_data htab;
+
+	memset(&htab, 0, sizeof(htab));
+	ut_asserteq(1, hcreate_r(SIZE, &htab));
+
+	ut_assertok(htab_fill(uts, &htab, SIZE * 20));
+	ut_assertok(htab_check_fill(uts, &htab, SIZE * 20));
+	ut_asserteq(SIZE * 20, htab.filled);
+	ut_assert(htab.size > SIZE * 20);
+
+	hdestroy_r(&htab);
+	return 0;
+}
+
+ENV_TEST(env_test_htab_grow, 0);
+
+/* Export entries added and deleted in any order sorted by key */
+static int env_test_htab_export(struct unit_test_state *uts)
+{
+	struct hsearch_data htab;
+	char *res = NULL;
+
+	memset(&htab, 0, sizeof(htab));
+	ut_asserteq(1, hcreate_r(SIZE, &htab));
+
+	ut_asserteq(1, himport_r(&htab, "b=2\nd=4\n", 8, '\n', H_NOCLEAR, 0,
+				 0, NULL));
+	ut_assert(hexport_r(&htab, '\n', 0, &res, 0, 0, NULL) > 0);
+	ut_asserteq_str("b=2\nd=4\n", res);
+	free(res);
+
+	ut_asserteq(1, himport_r(&htab, "e=5\na=1\nc=3\n", 12, '\n',
+				 H_NOCLEAR, 0, 0, NULL));
+	ut_asserteq(1, hdelete_r("d", &htab, 0));
+	res = NULL;
+	ut_assert(hexport_r(&htab, '\n', 0, &res, 0, 0, NULL) > 0);
+	ut_asserteq_str("a=1\nb=2\nc=3\ne=5\n", res);
+	free(res);
+
+	hdestroy_r(&htab);
+	return 0;
+}
+
+ENV_TEST(env_test_htab_export, 0);
+
+/* Replace all entries, keeping those which do not change */
+static int env_test_htab_import(struct unit_test_state *uts)
+{
+	struct hsearch_data htab;
+	struct env_entry item, *a, *b;
+	char *res = NULL;
+
+	memset(&htab, 0, sizeof(htab));
+	ut_asserteq(1, himport_r(&htab, "a=1\nb=2\nc=3\n", 12, '\n', 0, 0,
+				 0, NULL));
+	item.key = "b";
+	item.data = NULL;
+	hsearch_r(item, ENV_FIND, &b, &htab, 0);
+	ut_assert(b);
+
+	ut_asserteq(1, himport_r(&htab, "a=9\nb=2\nd=4\n", 12, '\n', 0, 0,
+				 0, NULL));
+	ut_asserteq(3, htab.filled);
+	item.key = "a";
+	hsearch_r(item, ENV_FIND, &a, &htab, 0);
+	ut_assert(a);
+	ut_asserteq_str("9", a->data);
+	item.key = "b";
+	hsearch_r(item, ENV_FIND, &a, &htab, 0);
+	ut_asserteq_ptr(b, a);
+
+	ut_assert(hexport_r(&htab, '\n', 0, &res, 0, 0, NULL) > 0);
+	ut_asserteq_str("a=9\nb=2\nd=4\n", res);
+	free(res);
+
+	hdestroy_r(&htab);
+	return 0;
+}
+
+ENV_TEST(env_test_htab_import, 0);
+
+static struct hsearch_data *grow_htab;
+static int grow_count;
+
+/* Add enough entries to make the table resize */
+static void htab_grow(void)
+{
+	struct env_entry item, *ritem;
+	char key[20];
+	int i;
+
+	for (i = 0; i < SIZE * 4; i++) {
+		sprintf(key, "g%d", grow_count++);
+		item.callback = NULL;
+		item.flags = 0;
+		item.data = key;
+		item.key = key;
+		hsearch_r(item, ENV_ENTER, &ritem, grow_htab, 0);
+	}
+}
+
+/* Grow the table and then reject creating "reject" / allow deleting "victim" */
+static int htab_grow_change_ok(const struct env_entry *item,
+			       const char *newval, enum env_op op, int flag)
+{
+	if (op == env_op_create && !strcmp(item->key, "reject")) {
+		htab_grow();
+		return 1;
+	}
+	if (op == env_op_delete && !strcmp(item->key, "victim"))
+		htab_grow();
+
+	return 0;
+}
+
+/* Entries are deleted correctly when change_ok() resizes the table */
+static int env_test_htab_resize_in_change_ok(struct unit_test_state *uts)
+{
+	struct hsearch_data htab;
+	struct env_entry item, *ritem;
+	unsigned int filled, size;
+
+	memset(&htab, 0, sizeof(htab));
+	ut_asserteq(1, hcreate_r(SIZE, &htab));
+	ut_assertok(htab_fill(uts, &htab, SIZE / 2));
+	grow_htab = &htab;
+	grow_count = 0;
+	htab.change_ok = htab_grow_change_ok;
+
+	/* A rejected new entry is removed from the resized table */
+	item.callback = NULL;
+	item.flags = 0;
+	item.key = "reject";
+	item.data = "1";
+	size = htab.size;
+	ut_asserteq(0, hsearch_r(item, ENV_ENTER, &ritem, &htab, 0));
+	ut_assert(htab.size > size);
+	ut_asserteq(SIZE / 2 + SIZE * 4, htab.filled);
+	item.data = NULL;
+	hsearch_r(item, ENV_FIND, &ritem, &htab, 0);
+	ut_assertnull(ritem);
+
+	/* An approved delete removes the right entry after a resize */
+	item.key = "victim";
+	item.data = "2";
+	ut_asserteq(1, hsearch_r(item, ENV_ENTER, &ritem, &htab, 0));
+	filled = htab.filled;
+	size = htab.size;
+	ut_asserteq(1, hdelete_r("victim", &htab, 0));
+	ut_assert(htab.size > size);
+	ut_asserteq(filled - 1 + SIZE * 4, htab.filled);
+	item.data = NULL;
+	hsearch_r(item, ENV_FIND, &ritem, &htab, 0);
+	ut_assertnull(ritem);
+	ut_assertok(htab_check_fill(uts, &htab, SIZE / 2));
+
+	hdestroy_r(&htab);
+	return 0;
+}
+
+ENV_TEST(env_test_htab_resize_in_change_ok, 0);
@@ -0,0 +1,64 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Tests for the malloc() size-class fast bins
+ */
+
+#include <common.h>
+#include <malloc.h>
+#include <test/lib.h>
+#include <test/test.h>
+#include <test/ut.h>
+
+/*
+ * Size class for a request, worked out as request2size() in dlmalloc does:
+ * one size field of overhead, rounded up to the chunk alignment
+ */
+#define TEST_SIZE	40
+#define SIZE_SZ		sizeof(INTERNAL_SIZE_T)
+#define MALLOC_ALIGN_MASK	(2 * SIZE_SZ - 1)
+#define TEST_CLASS	(((TEST_SIZE + SIZE_SZ + MALLOC_ALIGN_MASK) & \
+			  ~MALLOC_ALIGN_MASK) >> 3)
+
+static int lib_test_malloc_fast_bins(struct unit_test_state *uts)
+{
+	const struct malloc_class_stats *stats;
+	struct malloc_heap_info info;
+	ulong allocs, hits;
+	void *ptr, *ptr2;
+	int count;
+
+	count = malloc_get_class_stats(&stats);
+	ut_assert(count > 0);
+
+	/* A freed small chunk is handed straight back for the same size */
+	ptr = malloc(TEST_SIZE);
+	ut_assertnonnull(ptr);
+	free(ptr);
+	allocs = stats[TEST_CLASS].allocs;
+	hits = stats[TEST_CLASS].hits;
+	ptr2 = malloc(TEST_SIZE);
+	ut_asserteq_ptr(ptr, ptr2);
+	ut_asserteq(allocs + 1, stats[TEST_CLASS].allocs);
+	ut_asserteq(hits + 1, stats[TEST_CLASS].hits);
+
+	/* A cached chunk is counted as such and not as in use */
+	free(ptr2);
+	malloc_get_heap_info(&info);
+	ut_assert(stats[TEST_CLASS].cached > 0);
+	ut_assert(info.cached >= TEST_CLASS << 3);
+	ut_assert(info.inuse + info.free + info.cached == info.brk);
+	ut_assert(info.largest_free <= info.free);
+	ut_assert(info.brk <= info.brk_peak);
+	ut_assert(info.brk_peak <= info.total);
+
+	/* A large allocation releases all cached chunks */
+	ptr = malloc(0x10000);
+	ut_assertnonnull(ptr);
+	malloc_get_heap_info(&info);
+	ut_asserteq(0, info.cached);
+	ut_asserteq(0, stats[TEST_CLASS].cached);
+	free(ptr);
+
+	return 0;
+}
+LIB_TEST(lib_test_malloc_fast_bins, 0);
@@ -194,6 +194,23 @@ static int log_test(int testnum)
 		log_io("level %d\n", LOGL_DEBUG_IO);
 		break;
 	}
+#if CONFIG_IS_ENABLED(LOG_BINARY)
+	case 11: {
+		/* Fill the binary log more than once, keeping the console quiet */
+		int i;
+
+		ret = log_add_filter("console", NULL, LOGL_INFO, NULL);
+		if (ret < 0)
+			return ret;
+		for (i = 0; i < CONFIG_LOG_BINARY_SIZE / 16; i++)
+			_log(LOGC_NONE, LOGL_DEBUG, __FILE__, __LINE__,
+			     __func__, "wrap %d\n", i);
+		ret = log_remove_filter("console", ret);
+		if (ret < 0)
+			return ret;
+		break;
+	}
+#endif
 	}
 
 	return 0;
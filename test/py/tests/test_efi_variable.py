@@ -0,0 +1,41 @@
+# SPDX-License-Identifier: GPL-2.0+
+
+"""
+Test importing UEFI variables from U-Boot variables named efi_$guid_$name,
+which happens when the UEFI sub-system starts.
+"""
+
+import pytest
+import re
+
+GUID = '01234567-89ab-cdef-0123-456789abcdef'
+
+@pytest.mark.buildconfigspec('cmd_nvedit_efi')
+def test_efi_variable_import(u_boot_console):
+    """Test that values are imported as they were set
+
+    The UEFI variables are only imported once, so U-Boot is restarted to
+    make sure the UEFI sub-system starts after the variables are set.
+    """
+    cons = u_boot_console
+    cons.restart_uboot()
+
+    # A backslash is escaped while the variables are listed for the import
+    cons.run_command("setenv efi_%s_Test1 '{boot}(utf8)a\\b'" % GUID)
+    cons.run_command("setenv efi_%s_Test2 '{boot}(blob)0102'" % GUID)
+
+    # Too short to hold a GUID and a name, so this must be ignored
+    cons.run_command("setenv efi_a-b-c-d-e_f '{boot}(utf8)x'")
+
+    output = cons.run_command('printenv -e -guid %s Test1' % GUID)
+    assert 'DataSize = 0x4' in output
+    assert '00000000: 61 5c 62 00' in output
+
+    output = cons.run_command('printenv -e -guid %s Test2' % GUID)
+    assert 'DataSize = 0x2' in output
+    assert '00000000: 01 02' in output
+
+    output = cons.run_command('printenv -e -all')
+    assert not re.search('^f:', output, re.MULTILINE)
+
+    cons.restart_uboot()
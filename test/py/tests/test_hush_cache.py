@@ -0,0 +1,97 @@
+# SPDX-License-Identifier: GPL-2.0+
+
+# Test the cache of parsed hush scripts, which replays the lists parsed from a
+# script when the same text is run again.
+
+import pytest
+import re
+
+pytestmark = [
+    pytest.mark.buildconfigspec('hush_parse_cache'),
+    pytest.mark.buildconfigspec('cmd_stats'),
+    pytest.mark.buildconfigspec('cmd_echo'),
+]
+
+def get_stats(u_boot_console):
+    """Get the hit and miss counts of the parse cache from 'cmdstat'
+
+    Returns:
+        Tuple (number of scripts run from the cache, number parsed)
+    """
+    response = u_boot_console.run_command('cmdstat')
+    m = re.search(r'Parsed scripts: (\d+) run from cache, (\d+) parsed',
+                  response)
+    assert m
+    return int(m.group(1)), int(m.group(2))
+
+def run_and_get(u_boot_console, cmd):
+    """Run a command and return the value of $cacheout afterwards"""
+    u_boot_console.run_command(cmd)
+    return u_boot_console.run_command('echo ${cacheout}').strip()
+
+def test_hush_cache_run(u_boot_console):
+    """Test that running the same script twice uses the cache."""
+
+    u_boot_console.run_command(
+        "setenv cachetest 'setenv cacheout ${cacheval}x'")
+    u_boot_console.run_command('setenv cacheval 1')
+    hits, misses = get_stats(u_boot_console)
+
+    assert run_and_get(u_boot_console, 'run cachetest') == '1x'
+    assert get_stats(u_boot_console) == (hits, misses + 1)
+    assert run_and_get(u_boot_console, 'run cachetest') == '1x'
+    assert get_stats(u_boot_console) == (hits + 1, misses + 1)
+
+    # Variables are substituted when the cached script is run
+    u_boot_console.run_command('setenv cacheval 2')
+    assert run_and_get(u_boot_console, 'run cachetest') == '2x'
+    assert get_stats(u_boot_console) == (hits + 2, misses + 1)
+
+    # Changing the script itself means it is parsed again
+    u_boot_console.run_command(
+        "setenv cachetest 'setenv cacheout y${cacheval}'")
+    assert run_and_get(u_boot_console, 'run cachetest') == 'y2'
+    assert get_stats(u_boot_console) == (hits + 2, misses + 2)
+    assert run_and_get(u_boot_console, 'run cachetest') == 'y2'
+    assert get_stats(u_boot_console) == (hits + 3, misses + 2)
+
+    u_boot_console.run_command(
+        'setenv cachetest; setenv cacheval; setenv cacheout')
+
+def test_hush_cache_exit(u_boot_console):
+    """Test that a 'for' loop left by 'exit' behaves the same each time."""
+
+    u_boot_console.run_command("setenv cacheloop 'for i in a b c; do "
+        "setenv cacheout ${cacheout}$i; if test $i = b; then exit; fi; done'")
+    for _ in range(2):
+        u_boot_console.run_command('setenv cacheout')
+        assert run_and_get(u_boot_console, 'run cacheloop') == 'ab'
+
+    u_boot_console.run_command('setenv cacheloop; setenv cacheout')
+
+def test_hush_cache_exit_cached(u_boot_console):
+    """Test that 'exit' works when only taken after the script is cached."""
+
+    u_boot_console.run_command("setenv cacheloop 'for i in a b c; do "
+        "setenv cacheout ${cacheout}$i; "
+        "if test $i = ${cachestop}; then exit; fi; done'")
+    u_boot_console.run_command('setenv cachestop z')
+    hits, misses = get_stats(u_boot_console)
+
+    # The first run does not exit, so the whole loop is parsed and cached
+    u_boot_console.run_command('setenv cacheout')
+    assert run_and_get(u_boot_console, 'run cacheloop') == 'abc'
+    assert get_stats(u_boot_console) == (hits, misses + 1)
+
+    # Now the cached loop takes the exit
+    u_boot_console.run_command('setenv cachestop b; setenv cacheout')
+    assert run_and_get(u_boot_console, 'run cacheloop') == 'ab'
+    assert get_stats(u_boot_console) == (hits + 1, misses + 1)
+
+    # and the cached copy is still complete afterwards
+    u_boot_console.run_command('setenv cachestop z; setenv cacheout')
+    assert run_and_get(u_boot_console, 'run cacheloop') == 'abc'
+    assert get_stats(u_boot_console) == (hits + 2, misses + 1)
+
+    u_boot_console.run_command(
+        'setenv cacheloop; setenv cachestop; setenv cacheout')
@@ -9,6 +9,7 @@ and checks that the output is correct.
 """
 
 import pytest
+import re
 
 LOGL_FIRST, LOGL_WARNING, LOGL_INFO = (0, 4, 6)
 
@@ -130,3 +131,49 @@ def test_log_format(u_boot_console):
         run_with_format('FLfm', 'file.c:123-func() msg')
         run_with_format('lm', 'NOTICE. msg')
         run_with_format('m', 'msg')
+
+@pytest.mark.buildconfigspec('log_binary')
+def test_log_binary(u_boot_console):
+    """Test the binary log driver with 'log rec' and 'log dump'"""
+    def get_dropped(lines):
+        """Get the number of dropped records reported by 'log dump'
+
+        Args:
+            lines: Lines of output from 'log dump'
+        Returns:
+            Number of older records dropped
+        """
+        match = re.match(r'\((\d+) older records dropped\)', lines[0])
+        return int(match.group(1)) if match else 0
+
+    def dump():
+        """Run 'log dump' without the timestamp on each record
+
+        Returns:
+            List of lines of output
+        """
+        output = cons.run_command('log dump')
+        return [re.sub(r'^\[ *\d+\.\d+\] ', '', line)
+                for line in output.replace('\r', '').splitlines()]
+
+    cons = u_boot_console
+    with cons.log.section('binary'):
+        cons.run_command('log format FLfm')
+
+        # Each command reuses the same argument buffer, so the records must
+        # hold copies of the file and function names and the message
+        cons.run_command('log rec arch notice file.c 123 func msg')
+        cons.run_command('log rec arch notice other.c 45 fn2 second')
+        lines = dump()
+        assert lines[-3] == 'file.c:123-func() msg'
+        assert lines[-2] == 'other.c:45-fn2() second'
+        dropped = get_dropped(lines)
+
+        # Filling the ring drops the oldest records
+        cons.run_command('log test 11')
+        lines = dump()
+        assert get_dropped(lines) > dropped
+        assert 'file.c:123-func() msg' not in lines
+        assert re.match(r'.*log_test\(\) wrap \d+$', lines[-2])
+
+        cons.run_command('log format default')
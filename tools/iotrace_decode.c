@@ -0,0 +1,362 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Decode a compact I/O trace buffer saved from U-Boot
+ *
+ * The buffer is set up with 'iotrace mode compact' and saved to a file once
+ * the trace is recorded. Each access is shown with the driver function which
+ * made it (from System.map) and, optionally, the name of the device whose
+ * registers were accessed. Use -t to leave out timestamps when comparing
+ * traces from different firmware versions with diff.
+ */
+
+#include <byteswap.h>
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <compiler.h>
+#include <iotrace.h>
+
+#define MAX_LINE_LEN	500
+
+struct sym {
+	uint64_t addr;
+	uint64_t size;		/* 0 for functions: up to the next one */
+	char *name;
+};
+
+struct sym_list {
+	struct sym *sym;
+	int count;
+	int alloced;
+};
+
+static struct sym_list funcs;		/* functions from System.map */
+static struct sym_list regions;		/* named register regions */
+static int swap;			/* buffer has the other byte order */
+static int no_time;			/* don't show timestamps */
+static uint64_t long_mask;		/* mask for a target long */
+
+static void usage(void)
+{
+	fprintf(stderr,
+		"Usage: iotrace_decode [-t] [-m <map>] [-r <regions>] <trace>\n"
+		"\n"
+		"Options:\n"
+		"   -m <map>\tSpecify System.map file to find callers\n"
+		"   -r <regions>\tSpecify file with lines of '<addr> <size> <name>'\n"
+		"\t\tto name the registers accessed\n"
+		"   -t\t\tDo not show timestamps\n");
+	exit(EXIT_FAILURE);
+}
+
+static uint32_t get32(uint32_t val)
+{
+	return swap ? bswap_32(val) : val;
+}
+
+static uint16_t get16(uint16_t val)
+{
+	return swap ? bswap_16(val) : val;
+}
+
+static void add_sym(struct sym_list *list, uint64_t addr, uint64_t size,
+		    const char *name)
+{
+	struct sym *sym;
+
+	if (list->count == list->alloced) {
+		list->alloced += 256;
+		list->sym = realloc(list->sym, list->alloced * sizeof(*sym));
+		if (!list->sym) {
+			fprintf(stderr, "Out of memory\n");
+			exit(EXIT_FAILURE);
+		}
+	}
+	sym = &list->sym[list->count++];
+	sym->addr = addr;
+	sym->size = size;
+	sym->name = strdup(name);
+}
+
+static int h_cmp_addr(const void *v1, const void *v2)
+{
+	const struct sym *s1 = v1, *s2 = v2;
+
+	return s1->addr < s2->addr ? -1 : s1->addr > s2->addr;
+}
+
+/* Find the last symbol at or before @addr, or NULL if none */
+static struct sym *find_sym(struct sym_list *list, uint64_t addr)
+{
+	int low = 0, high = list->count;
+
+	while (low < high) {
+		int mid = (low + high) / 2;
+
+		if (list->sym[mid].addr <= addr)
+			low = mid + 1;
+		else
+			high = mid;
+	}
+	if (!low)
+		return NULL;
+
+	return &list->sym[low - 1];
+}
+
+static int read_system_map(const char *fname)
+{
+	char buff[MAX_LINE_LEN];
+	char symname[MAX_LINE_LEN + 1];
+	unsigned long long addr;
+	char symtype;
+	FILE *fin;
+
+	fin = fopen(fname, "r");
+	if (!fin) {
+		fprintf(stderr, "Cannot open map file '%s'\n", fname);
+		return 1;
+	}
+	while (fgets(buff, sizeof(buff), fin)) {
+		if (sscanf(buff, "%llx %c %500s", &addr, &symtype,
+			   symname) != 3)
+			continue;
+
+		/* Must be a text symbol */
+		symtype = tolower(symtype);
+		if (symtype == 't' || symtype == 'w')
+			add_sym(&funcs, addr, 0, symname);
+	}
+	fclose(fin);
+	qsort(funcs.sym, funcs.count, sizeof(struct sym), h_cmp_addr);
+
+	return 0;
+}
+
+static int read_regions(const char *fname)
+{
+	char buff[MAX_LINE_LEN];
+	char name[MAX_LINE_LEN + 1];
+	unsigned long long addr, size;
+	int linenum;
+	FILE *fin;
+
+	fin = fopen(fname, "r");
+	if (!fin) {
+		fprintf(stderr, "Cannot open regions file '%s'\n", fname);
+		return 1;
+	}
+	for (linenum = 1; fgets(buff, sizeof(buff), fin); linenum++) {
+		if (*buff == '#' || *buff == '\n')
+			continue;
+		if (sscanf(buff, "%llx %llx %500s", &addr, &size, name) != 3) {
+			fprintf(stderr, "Regions file line %d: invalid format\n",
+				linenum);
+			fclose(fin);
+			return 1;
+		}
+		add_sym(&regions, addr, size, name);
+	}
+	fclose(fin);
+	qsort(regions.sym, regions.count, sizeof(struct sym), h_cmp_addr);
+
+	return 0;
+}
+
+static const uint8_t *get_uleb128(const uint8_t *p, const uint8_t *end,
+				  uint64_t *valp)
+{
+	uint64_t val = 0;
+	int shift = 0;
+
+	do {
+		if (p == end || shift > 63)
+			return NULL;
+		val |= (uint64_t)(*p & 0x7f) << shift;
+		shift += 7;
+	} while (*p++ & 0x80);
+	*valp = val;
+
+	return p;
+}
+
+static const uint8_t *get_sleb128(const uint8_t *p, const uint8_t *end,
+				  uint64_t *valp)
+{
+	uint64_t val;
+
+	p = get_uleb128(p, end, &val);
+	*valp = (val >> 1) ^ -(val & 1);
+
+	return p;
+}
+
+static void print_record(int flags, uint64_t timestamp, uint64_t addr,
+			 uint64_t value, uint64_t caller)
+{
+	struct sym *sym;
+
+	if (!no_time)
+		printf("%12llu  ", (unsigned long long)timestamp);
+	printf("%c%-2d 0x%08llx 0x%08llx", flags & IOT_WRITE ? 'W' : 'R',
+	       8 << (flags & 3), (unsigned long long)addr,
+	       (unsigned long long)value);
+
+	sym = find_sym(&regions, addr);
+	if (sym && addr - sym->addr < sym->size)
+		printf("  %s+%#llx", sym->name,
+		       (unsigned long long)(addr - sym->addr));
+
+	sym = find_sym(&funcs, caller);
+	if (sym)
+		printf("  %s+%#llx", sym->name,
+		       (unsigned long long)(caller - sym->addr));
+	else if (caller)
+		printf("  %#llx", (unsigned long long)caller);
+	printf("\n");
+}
+
+static int decode_block(const struct iotrace_block *blk, uint32_t block_size)
+{
+	const uint8_t *p = (const uint8_t *)(blk + 1);
+	const uint8_t *end = p + get16(blk->used);
+	uint64_t timestamp = 0, addr = 0, value, caller = 0, delta;
+	int flags;
+
+	if ((const uint8_t *)end > (const uint8_t *)blk + block_size) {
+		fprintf(stderr, "Block %u: invalid size\n", get32(blk->seq));
+		return 1;
+	}
+	while (p < end) {
+		flags = *p++;
+		p = get_uleb128(p, end, &delta);
+		if (!p)
+			break;
+		timestamp = (timestamp + delta) & long_mask;
+		p = get_sleb128(p, end, &delta);
+		if (!p)
+			break;
+		addr = (addr + delta) & long_mask;
+		p = get_uleb128(p, end, &value);
+		if (!p)
+			break;
+		p = get_sleb128(p, end, &delta);
+		if (!p)
+			break;
+		caller = (caller + delta) & long_mask;
+		print_record(flags, timestamp, addr, value, caller);
+	}
+	if (!p) {
+		fprintf(stderr, "Block %u: truncated record\n", get32(blk->seq));
+		return 1;
+	}
+
+	return 0;
+}
+
+static int h_cmp_seq(const void *v1, const void *v2)
+{
+	uint32_t seq1 = get32((*(struct iotrace_block **)v1)->seq);
+	uint32_t seq2 = get32((*(struct iotrace_block **)v2)->seq);
+
+	return seq1 < seq2 ? -1 : seq1 > seq2;
+}
+
+static int read_trace(const char *fname)
+{
+	struct iotrace_hdr hdr;
+	struct iotrace_block **order;
+	uint32_t block_size, block_count, i, j;
+	char *buf;
+	int err = 0;
+	FILE *fin;
+
+	fin = fopen(fname, "rb");
+	if (!fin) {
+		fprintf(stderr, "Cannot open trace file '%s'\n", fname);
+		return 1;
+	}
+	if (fread(&hdr, sizeof(hdr), 1, fin) != 1) {
+		fprintf(stderr, "Cannot read trace header\n");
+		fclose(fin);
+		return 1;
+	}
+	swap = hdr.magic == bswap_32(IOTRACE_MAGIC);
+	if (get32(hdr.magic) != IOTRACE_MAGIC ||
+	    get16(hdr.version) != IOTRACE_VERSION) {
+		fprintf(stderr, "Not a compact trace, or unknown version\n");
+		fclose(fin);
+		return 1;
+	}
+	block_size = get32(hdr.block_size);
+	block_count = get32(hdr.block_count);
+	long_mask = get32(hdr.long_size) >= 8 ? ~0ULL :
+		(1ULL << (get32(hdr.long_size) * 8)) - 1;
+	if (block_size < sizeof(struct iotrace_block)) {
+		fprintf(stderr, "Invalid block size %u\n", block_size);
+		fclose(fin);
+		return 1;
+	}
+
+	buf = calloc(block_count, block_size);
+	order = calloc(block_count, sizeof(*order));
+	if (!buf || !order) {
+		fprintf(stderr, "Out of memory\n");
+		fclose(fin);
+		return 1;
+	}
+	block_count = fread(buf, block_size, block_count, fin);
+	fclose(fin);
+
+	/* Put the used blocks in order of sequence number */
+	for (i = 0, j = 0; i < block_count; i++) {
+		struct iotrace_block *blk;
+
+		blk = (struct iotrace_block *)(buf + i * block_size);
+		if (blk->seq)
+			order[j++] = blk;
+	}
+	qsort(order, j, sizeof(*order), h_cmp_seq);
+
+	for (i = 0; i < j && !err; i++)
+		err = decode_block(order[i], block_size);
+	free(order);
+	free(buf);
+
+	return err;
+}
+
+int main(int argc, char *argv[])
+{
+	int opt;
+
+	while ((opt = getopt(argc, argv, "m:r:t")) != -1) {
+		switch (opt) {
+		case 'm':
+			if (read_system_map(optarg))
+				return EXIT_FAILURE;
+			break;
+
+		case 'r':
+			if (read_regions(optarg))
+				return EXIT_FAILURE;
+			break;
+
+		case 't':
+			no_time = 1;
+			break;
+
+		default:
+			usage();
+		}
+	}
+	argc -= optind;
+	argv += optind;
+	if (argc != 1)
+		usage();
+
+	return read_trace(argv[0]) ? EXIT_FAILURE : 0;
+}
@@ -21,6 +21,7 @@
 #include <trace.h>
 
 #define MAX_LINE_LEN 500
+#define NSEC_PER_SEC 1000000000ULL
 
 enum {
 	FUNCF_TRACE	= 1 << 0,	/* Include this function in trace */
@@ -34,6 +35,36 @@ struct func_info {
 	unsigned flags;
 	/* the section this function is in */
 	struct objsection_info *objsection;
+
+	/* Filled in from the call list by build_call_tree() */
+	unsigned long traced_calls;	/* Number of calls in the call list */
+	uint64_t incl_time;		/* Time including callees */
+	uint64_t excl_time;		/* Time excluding callees */
+	int active;			/* Number of calls in progress */
+};
+
+/* A node in the call tree, one for each distinct call stack */
+struct call_node {
+	struct func_info *func;
+	struct call_node *parent;
+	struct call_node *child;	/* First child */
+	struct call_node *sibling;	/* Next child of the same parent */
+	uint64_t self_time;		/* Time not spent in children */
+};
+
+/* A function call which is in progress while walking the call list */
+struct call_frame {
+	struct call_node *node;
+	uint64_t start;			/* Timestamp of entry */
+	uint64_t child_time;		/* Time spent in callees */
+};
+
+/* Per-function statistics kept from the base capture for dump-diff */
+struct func_stats {
+	const char *name;
+	unsigned long calls;
+	uint64_t incl_ns;
+	uint64_t excl_ns;
 };
 
 enum trace_line_type {
@@ -57,6 +88,11 @@ struct trace_call *call_list;
 int call_count;
 int verbose;	/* Verbosity level 0=none, 1=warn, 2=notice, 3=info, 4=debug */
 unsigned long text_offset;		/* text address of first function */
+unsigned long timebase = 1000000;	/* timestamp units per second */
+struct call_node call_root;		/* root of the call tree */
+int call_tree_built;
+struct func_stats *base_stats;		/* statistics from the base capture */
+int base_count;
 
 static void outf(int level, const char *fmt, ...)
 		__attribute__ ((format (__printf__, 2, 3)));
@@ -85,10 +121,16 @@ static void usage(void)
 		"\n"
 		"Commands\n"
 		"   dump-ftrace\t\tDump out textual data in ftrace format\n"
+		"   dump-flamegraph\tDump out folded stacks for flamegraph.pl\n"
+		"   dump-funcs\t\tDump out time spent in each function\n"
+		"   dump-diff\t\tCompare time spent in each function with -b\n"
 		"\n"
 		"Options:\n"
+		"   -b <profdata>\tSpecify base trace data file for dump-diff\n"
+		"   -M <map>\tSpecify System.map file for base (default -m)\n"
 		"   -m <map>\tSpecify Systen.map file\n"
-		"   -t <trace>\tSpecific trace data file (from U-Boot)\n"
+		"   -p <profdata>\tSpecify trace data file (from U-Boot)\n"
+		"   -t <config>\tSpecify trace config file\n"
 		"   -v <0-4>\tSpecify verbosity\n");
 	exit(EXIT_FAILURE);
 }
@@ -249,6 +291,15 @@ static int read_profile(FILE *fin, int *not_found)
 			if (read_calls(fin, hdr.rec_count))
 				return 1;
 			break;
+
+		case TRACE_CHUNK_TIMEBASE:
+			if (!hdr.rec_count) {
+				error("Invalid timebase\n");
+				return 1;
+			}
+			timebase = hdr.rec_count;
+			notice("timebase: %lu Hz\n", timebase);
+			break;
 		}
 	}
 	return 0;
@@ -501,7 +552,8 @@ static int make_ftrace(void)
 		"#              | |      |          |         |\n");
 	for (i = 0, call = call_list; i < call_count; i++, call++) {
 		struct func_info *func = find_func_by_offset(call->func);
-		ulong time = call->flags & FUNCF_TIMESTAMP_MASK;
+		uint64_t time = TRACE_CALL_TIME(call);
+		ulong secs, frac;
 
 		if (TRACE_CALL_TYPE(call) != FUNCF_ENTRY &&
 		    TRACE_CALL_TYPE(call) != FUNCF_EXIT)
@@ -520,8 +572,17 @@ static int make_ftrace(void)
 			continue;
 		}
 
-		printf("%16s-%-5d [01] %lu.%06lu: ", "uboot", 1,
-		       time / 1000000, time % 1000000);
+		/* Show nanoseconds if the timestamps are fine enough */
+		secs = time / timebase;
+		time %= timebase;
+		printf("%16s-%-5d [01] %lu.", "uboot", 1, secs);
+		if (timebase > 1000000) {
+			frac = time * 1000000000 / timebase;
+			printf("%09lu: ", frac);
+		} else {
+			frac = time * 1000000 / timebase;
+			printf("%06lu: ", frac);
+		}
 
 		out_func(call->func, 0, " <- ");
 		out_func(call->caller, 1, "\n");
@@ -532,18 +593,433 @@ static int make_ftrace(void)
 	return 0;
 }
 
+/* Convert a time in timestamp units to nanoseconds */
+static uint64_t time_to_ns(uint64_t time)
+{
+	return time / timebase * NSEC_PER_SEC +
+		time % timebase * NSEC_PER_SEC / timebase;
+}
+
+static struct call_node *find_call_node(struct call_node *parent,
+					struct func_info *func)
+{
+	struct call_node *node;
+
+	for (node = parent->child; node; node = node->sibling) {
+		if (node->func == func)
+			return node;
+	}
+	node = calloc(1, sizeof(*node));
+	assert(node);
+	node->func = func;
+	node->parent = parent;
+	node->sibling = parent->child;
+	parent->child = node;
+
+	return node;
+}
+
+static void free_call_nodes(struct call_node *parent)
+{
+	struct call_node *node, *next;
+
+	for (node = parent->child; node; node = next) {
+		next = node->sibling;
+		free_call_nodes(node);
+		free(node);
+	}
+	parent->child = NULL;
+}
+
+/* Finish a call, adding its time to the function, its node and its caller */
+static void end_call(struct call_frame *frame, uint64_t time,
+		     struct call_frame *caller)
+{
+	struct func_info *func = frame->node->func;
+	uint64_t total, self;
+
+	total = time > frame->start ? time - frame->start : 0;
+	self = total > frame->child_time ? total - frame->child_time : 0;
+	frame->node->self_time += self;
+	func->excl_time += self;
+
+	/* Only count the outermost call of a recursive function */
+	if (!--func->active)
+		func->incl_time += total;
+	if (caller)
+		caller->child_time += total;
+}
+
+/**
+ * build_call_tree() - Work out the time spent in each function
+ *
+ * This walks the call list, matching each exit with its entry, to fill in the
+ * per-function times and build a tree of the call stacks seen.
+ *
+ * Exits with no entry in the list (e.g. because the trace was started, or
+ * wrapped, inside the function) are ignored. Calls with no exit are ended at
+ * the next exit from one of their callers, or at the end of the list.
+ */
+static void build_call_tree(void)
+{
+	struct call_frame *stack = NULL;
+	struct trace_call *call;
+	int depth = 0, alloced = 0;
+	uint64_t time = 0;
+	int i;
+
+	if (call_tree_built)
+		return;
+	for (i = 0, call = call_list; i < call_count; i++, call++) {
+		struct func_info *func;
+		struct call_frame *frame;
+		int level;
+
+		if (TRACE_CALL_TYPE(call) != FUNCF_ENTRY &&
+		    TRACE_CALL_TYPE(call) != FUNCF_EXIT)
+			continue;
+		func = find_func_by_offset(call->func);
+		if (!func || !(func->flags & FUNCF_TRACE))
+			continue;
+		time = TRACE_CALL_TIME(call);
+
+		if (TRACE_CALL_TYPE(call) == FUNCF_ENTRY) {
+			if (depth == alloced) {
+				alloced += 256;
+				stack = realloc(stack,
+						sizeof(struct call_frame) *
+						alloced);
+				assert(stack);
+			}
+			frame = &stack[depth];
+			frame->node = find_call_node(depth ?
+					stack[depth - 1].node : &call_root,
+					func);
+			frame->start = time;
+			frame->child_time = 0;
+			func->traced_calls++;
+			func->active++;
+			depth++;
+			continue;
+		}
+
+		for (level = depth - 1; level >= 0; level--) {
+			if (stack[level].node->func == func)
+				break;
+		}
+		if (level < 0) {
+			debug("Exit from '%s' without entry\n", func->name);
+			continue;
+		}
+		while (depth > level) {
+			depth--;
+			end_call(&stack[depth], time,
+				 depth ? &stack[depth - 1] : NULL);
+		}
+	}
+
+	/* Anything still running was running when the trace was taken */
+	while (depth) {
+		depth--;
+		end_call(&stack[depth], time, depth ? &stack[depth - 1] : NULL);
+	}
+	free(stack);
+	call_tree_built = 1;
+}
+
+static void out_stack(struct call_node *node)
+{
+	if (node->parent != &call_root) {
+		out_stack(node->parent);
+		putchar(';');
+	}
+	fputs(node->func->name, stdout);
+}
+
+static void out_folded(struct call_node *parent)
+{
+	struct call_node *node;
+
+	for (node = parent->child; node; node = node->sibling) {
+		if (node->self_time) {
+			out_stack(node);
+			printf(" %llu\n",
+			       (unsigned long long)time_to_ns(node->self_time));
+		}
+		out_folded(node);
+	}
+}
+
+/*
+ * Write out the call stacks in 'folded' format, one line per distinct stack,
+ * with the time spent in the last function of that stack in nanoseconds:
+ *
+ * board_init_r;initr_dm;dm_init_and_scan 1200
+ *
+ * This can be fed directly to flamegraph.pl (use --countname=ns)
+ */
+static int make_flamegraph(void)
+{
+	build_call_tree();
+	out_folded(&call_root);
+
+	return 0;
+}
+
+static int h_cmp_excl_time(const void *v1, const void *v2)
+{
+	const struct func_info *f1 = *(struct func_info **)v1;
+	const struct func_info *f2 = *(struct func_info **)v2;
+
+	if (f1->excl_time != f2->excl_time)
+		return f1->excl_time < f2->excl_time ? 1 : -1;
+
+	return strcmp(f1->name, f2->name);
+}
+
+static double ns_to_us(uint64_t ns)
+{
+	return ns / 1000.0;
+}
+
+/* Write out a table of time spent in each function, most expensive first */
+static int make_func_table(void)
+{
+	struct func_info **funcs;
+	uint64_t total = 0;
+	int i, count = 0;
+
+	build_call_tree();
+	funcs = calloc(func_count, sizeof(*funcs));
+	if (!funcs) {
+		error("Cannot allocate function table\n");
+		return -1;
+	}
+	for (i = 0; i < func_count; i++) {
+		if (func_list[i].traced_calls) {
+			funcs[count++] = &func_list[i];
+			total += func_list[i].excl_time;
+		}
+	}
+	qsort(funcs, count, sizeof(*funcs), h_cmp_excl_time);
+
+	printf("%10s %14s %14s %6s  %s\n", "calls", "incl_us", "excl_us",
+	       "excl%", "function");
+	for (i = 0; i < count; i++) {
+		struct func_info *func = funcs[i];
+
+		printf("%10lu %14.3f %14.3f %6.2f  %s\n", func->traced_calls,
+		       ns_to_us(time_to_ns(func->incl_time)),
+		       ns_to_us(time_to_ns(func->excl_time)),
+		       total ? func->excl_time * 100.0 / total : 0.0,
+		       func->name);
+	}
+	printf("%10s %14s %14.3f %6s  %s\n", "", "",
+	       ns_to_us(time_to_ns(total)), "", "total");
+	free(funcs);
+
+	return 0;
+}
+
+static int h_cmp_stats_name(const void *v1, const void *v2)
+{
+	const struct func_stats *s1 = v1, *s2 = v2;
+
+	return strcmp(s1->name, s2->name);
+}
+
+/**
+ * get_func_stats() - Collect the statistics for each function traced
+ *
+ * Functions are identified by name, since the two captures may come from
+ * different builds. Any functions with the same name (e.g. static functions
+ * in different files) are merged.
+ *
+ * @statsp:	Returns a list of statistics, sorted by function name
+ * Return: number of functions in the list, or -1 on error
+ */
+static int get_func_stats(struct func_stats **statsp)
+{
+	struct func_stats *stats;
+	int i, count = 0;
+
+	build_call_tree();
+	stats = calloc(func_count ? func_count : 1, sizeof(*stats));
+	if (!stats) {
+		error("Cannot allocate function statistics\n");
+		return -1;
+	}
+	for (i = 0; i < func_count; i++) {
+		struct func_info *func = &func_list[i];
+
+		if (!func->traced_calls)
+			continue;
+		stats[count].name = func->name;
+		stats[count].calls = func->traced_calls;
+		stats[count].incl_ns = time_to_ns(func->incl_time);
+		stats[count].excl_ns = time_to_ns(func->excl_time);
+		count++;
+	}
+	qsort(stats, count, sizeof(*stats), h_cmp_stats_name);
+
+	for (i = 1; count && i < count;) {
+		struct func_stats *prev = &stats[i - 1];
+
+		if (strcmp(prev->name, stats[i].name)) {
+			i++;
+			continue;
+		}
+		prev->calls += stats[i].calls;
+		prev->incl_ns += stats[i].incl_ns;
+		prev->excl_ns += stats[i].excl_ns;
+		memmove(&stats[i], &stats[i + 1],
+			(count - i - 1) * sizeof(*stats));
+		count--;
+	}
+	*statsp = stats;
+
+	return count;
+}
+
+/* A function in the diff, with its statistics in each capture */
+struct func_diff {
+	const char *name;
+	struct func_stats base;
+	struct func_stats cur;
+	int64_t delta;		/* Change in exclusive time, in ns */
+};
+
+static int h_cmp_delta(const void *v1, const void *v2)
+{
+	const struct func_diff *d1 = v1, *d2 = v2;
+	int64_t a1 = d1->delta < 0 ? -d1->delta : d1->delta;
+	int64_t a2 = d2->delta < 0 ? -d2->delta : d2->delta;
+
+	if (a1 != a2)
+		return a1 < a2 ? 1 : -1;
+
+	return strcmp(d1->name, d2->name);
+}
+
+/*
+ * Write out the change in exclusive time of each function between the base
+ * capture (-b) and this one, largest change first
+ */
+static int make_diff(void)
+{
+	struct func_stats *stats;
+	struct func_diff *diffs;
+	int64_t base_total = 0, total = 0;
+	int count, i, j, upto;
+
+	if (!base_stats) {
+		error("dump-diff needs a base trace data file (-b)\n");
+		return -1;
+	}
+	count = get_func_stats(&stats);
+	if (count < 0)
+		return -1;
+	diffs = calloc(count + base_count + 1, sizeof(*diffs));
+	if (!diffs) {
+		error("Cannot allocate diff\n");
+		free(stats);
+		return -1;
+	}
+
+	/* Both lists are sorted by name, so walk them side by side */
+	for (i = j = upto = 0; i < base_count || j < count; upto++) {
+		struct func_diff *diff = &diffs[upto];
+		int cmp;
+
+		if (i == base_count)
+			cmp = 1;
+		else if (j == count)
+			cmp = -1;
+		else
+			cmp = strcmp(base_stats[i].name, stats[j].name);
+		if (cmp <= 0) {
+			diff->base = base_stats[i++];
+			diff->name = diff->base.name;
+		}
+		if (cmp >= 0) {
+			diff->cur = stats[j++];
+			diff->name = diff->cur.name;
+		}
+		diff->delta = (int64_t)diff->cur.excl_ns - diff->base.excl_ns;
+		base_total += diff->base.excl_ns;
+		total += diff->cur.excl_ns;
+	}
+	qsort(diffs, upto, sizeof(*diffs), h_cmp_delta);
+
+	printf("%10s %10s %14s %14s %14s %8s  %s\n", "base_calls", "calls",
+	       "base_excl_us", "excl_us", "delta_us", "delta%", "function");
+	for (i = 0; i < upto; i++) {
+		struct func_diff *diff = &diffs[i];
+
+		printf("%10lu %10lu %14.3f %14.3f %+14.3f ", diff->base.calls,
+		       diff->cur.calls, ns_to_us(diff->base.excl_ns),
+		       ns_to_us(diff->cur.excl_ns), diff->delta / 1000.0);
+		if (diff->base.excl_ns)
+			printf("%+7.1f%%", diff->delta * 100.0 /
+			       diff->base.excl_ns);
+		else
+			printf("%8s", "new");
+		printf("  %s\n", diff->name);
+	}
+	printf("%10s %10s %14.3f %14.3f %+14.3f %8s  %s\n", "", "",
+	       base_total / 1000.0, total / 1000.0,
+	       (total - base_total) / 1000.0, "", "total");
+	free(diffs);
+	free(stats);
+
+	return 0;
+}
+
+/* Forget the map and trace data, so that another capture can be read */
+static void reset_profile(void)
+{
+	free_call_nodes(&call_root);
+	call_tree_built = 0;
+	free(func_list);
+	func_list = NULL;
+	func_count = 0;
+	free(call_list);
+	call_list = NULL;
+	call_count = 0;
+	timebase = 1000000;
+}
+
+/* Read the base capture for dump-diff and keep its statistics */
+static int read_base(const char *prof_fname, const char *map_fname)
+{
+	if (read_map_file(map_fname) || read_profile_file(prof_fname))
+		return -1;
+	check_functions();
+	base_count = get_func_stats(&base_stats);
+	if (base_count < 0)
+		return -1;
+	reset_profile();
+
+	return 0;
+}
+
 static int prof_tool(int argc, char * const argv[],
 		     const char *prof_fname, const char *map_fname,
-		     const char *trace_config_fname)
+		     const char *trace_config_fname,
+		     const char *base_fname, const char *base_map_fname)
 {
 	int err = 0;
 
+	if (trace_config_fname && read_trace_config_file(trace_config_fname))
+		return -1;
+	if (base_fname && read_base(base_fname,
+				    base_map_fname ? base_map_fname :
+				    map_fname))
+		return -1;
 	if (read_map_file(map_fname))
 		return -1;
 	if (prof_fname && read_profile_file(prof_fname))
 		return -1;
-	if (trace_config_fname && read_trace_config_file(trace_config_fname))
-		return -1;
 
 	check_functions();
 
@@ -552,6 +1028,12 @@ static int prof_tool(int argc, char * const argv[],
 
 		if (0 == strcmp(cmd, "dump-ftrace"))
 			err = make_ftrace();
+		else if (0 == strcmp(cmd, "dump-flamegraph"))
+			err = make_flamegraph();
+		else if (0 == strcmp(cmd, "dump-funcs"))
+			err = make_func_table();
+		else if (0 == strcmp(cmd, "dump-diff"))
+			err = make_diff();
 		else
 			warn("Unknown command '%s'\n", cmd);
 	}
@@ -564,11 +1046,21 @@ int main(int argc, char *argv[])
 	const char *map_fname = "System.map";
 	const char *prof_fname = NULL;
 	const char *trace_config_fname = NULL;
+	const char *base_fname = NULL;
+	const char *base_map_fname = NULL;
 	int opt;
 
 	verbose = 2;
-	while ((opt = getopt(argc, argv, "m:p:t:v:")) != -1) {
+	while ((opt = getopt(argc, argv, "b:M:m:p:t:v:")) != -1) {
 		switch (opt) {
+		case 'b':
+			base_fname = optarg;
+			break;
+
+		case 'M':
+			base_map_fname = optarg;
+			break;
+
 		case 'm':
 			map_fname = optarg;
 			break;
@@ -595,5 +1087,5 @@ int main(int argc, char *argv[])
 
 	debug("Debug enabled\n");
 	return prof_tool(argc, argv, prof_fname, map_fname,
-			 trace_config_fname);
+			 trace_config_fname, base_fname, base_map_fname);
 }